@@ -0,0 +1,250 @@
+@echo off
+rem
+rem Build a multi-module program for pmach or cmach
+rem
+rem Finds the modules a program uses or joins, compiles them, and links the
+rem result to an object deck.
+rem
+rem Execution:
+rem
+rem build [--jobs <n>] <file>
+rem
+rem <file> is the main program filename without extention. Modules are found
+rem by following the uses and joins statements from it, and are expected to be
+rem in the current directory as <module>.pas, or failing that in the libs
+rem directory of the P6 tree.
+rem
+rem The files are:
+rem
+rem <file>.pas   - The Pascal source file for each module
+rem <file>.p6    - The intermediate file for each module
+rem <file>.p6b   - The binary instructions for each module compiled with c2
+rem <file>.err   - The errors output from the compiler for each module
+rem <file>.p6h   - The source hash the intermediate was made from
+rem <file>.p6o   - The object deck produced for the main program
+rem
+rem --jobs <n> Accepted for compatibility with the bash version, which
+rem            compiles in parallel. Here the compiles run one at a time.
+rem
+rem A module is recompiled only if its source, the source of any module it uses
+rem or joins, or the compiler has changed since its intermediate was made.
+rem
+setlocal EnableDelayedExpansion
+set jobsnext=0
+set progfile=
+set libdir=%~dp0..\libs
+for %%x in (%*) do (
+
+    if "!jobsnext!"=="1" (
+
+        set jobsnext=0
+
+    ) else if "%%~x"=="--jobs" (
+
+        set jobsnext=1
+
+    ) else if "%%~x"=="--help" (
+
+		echo.
+		echo Build a multi-module program for pmach or cmach
+		echo.
+		echo Finds the modules a program uses or joins, compiles them, and links the
+		echo result to an object deck.
+		echo.
+		echo Execution:
+		echo.
+		echo build [--jobs ^<n^>] ^<file^>
+		echo.
+		echo ^<file^> is the main program filename without extention. Modules are found
+		echo by following the uses and joins statements from it, and are expected to be
+		echo in the current directory as ^<module^>.pas, or failing that in the libs
+		echo directory of the P6 tree.
+		echo.
+		echo The files are:
+		echo.
+		echo ^<file^>.pas   - The Pascal source file for each module
+		echo ^<file^>.p6    - The intermediate file for each module
+		echo ^<file^>.p6b   - The binary instructions for each module compiled with c2
+		echo ^<file^>.err   - The errors output from the compiler for each module
+		echo ^<file^>.p6h   - The source hash the intermediate was made from
+		echo ^<file^>.p6o   - The object deck produced for the main program
+		echo.
+		echo --jobs ^<n^> Accepted for compatibility with the bash version, which
+		echo            compiles in parallel. Here the compiles run one at a time.
+		echo.
+		goto stop
+
+    ) else if not "%%~x"=="" (
+
+    	if not exist "%%~x.pas" (
+
+        	echo %%~x.pas does not exist
+        	exit /b 1
+
+    	)
+    	set progfile=%%~x
+
+    )
+
+)
+
+if "%progfile%"=="" (
+
+    echo *** Error: No build file specified
+    exit /b 1
+
+)
+
+rem
+rem Walk the module graph from the program
+rem
+set order=
+call :visit %progfile%
+if errorlevel 1 exit /b 1
+
+rem
+rem Compile the out of date modules in link order
+rem
+set compiler=
+for /f "delims=" %%c in ('where pcom') do if "!compiler!"=="" set compiler=%%c
+for %%m in (%order%) do (
+
+    call :check %%m
+    if errorlevel 1 exit /b 1
+
+)
+
+rem
+rem Link in dependency order, which ends with the program
+rem
+echo Linking %progfile%...
+call "%~dp0plink.bat" %order%
+goto stop
+
+rem
+rem Find the source of a module, in the current directory or else in libs.
+rem Sets src, empty if there is none.
+rem
+:findsrc
+set src=
+if exist "%1.pas" (
+
+    set src=%CD%\%1.pas
+
+) else if exist "%libdir%\%1.pas" (
+
+    set src=%libdir%\%1.pas
+
+)
+goto :eof
+
+rem
+rem Visit a module. It is placed in the link order after the modules it uses,
+rem and gets the set of sources its interface depends on. The names used or
+rem joined are taken from the source with comments removed, as in build.
+rem
+:visit
+if "!state_%1!"=="done" exit /b 0
+if "!state_%1!"=="open" (
+
+    echo *** Error: Module %1 uses itself
+    exit /b 1
+
+)
+set state_%1=open
+set deps_%1=%1
+call :findsrc %1
+tr "\n\r" "  " < "%src%" | sed -e "s/{[^}]*}//g" -e "s/(\*\([^*]\|\*[^)]\)*\*)//g" | grep -ioE "(^|[^a-z0-9_])(uses|joins)[[:space:]][^;]*;" | sed -E "s/^[^a-zA-Z]*[a-zA-Z]+//" | tr ",;" "  " | tr " " "\n" > %1.mod
+for /f %%m in (%1.mod) do (
+
+    call :findsrc %%m
+    if not "!src!"=="" (
+
+        call :visit %%m
+        if errorlevel 1 (
+
+            del %1.mod
+            exit /b 1
+
+        )
+        for %%d in (!deps_%%m!) do (
+
+            set have= !deps_%1! 
+            if "!have: %%d =!"=="!have!" set deps_%1=!deps_%1! %%d
+
+        )
+
+    )
+
+)
+del %1.mod
+set state_%1=done
+set order=%order% %1
+exit /b 0
+
+rem
+rem Check a module against its hash, which covers the module and every source
+rem it depends on, plus the compiler itself, and compile it if out of date.
+rem
+:check
+set srcs=
+for %%d in (!deps_%1!) do (
+
+    call :findsrc %%d
+    set srcs=!srcs! "!src!"
+
+)
+set hash=
+for /f %%h in ('cat "%compiler%" %srcs% ^| md5sum') do set hash=%%h
+set oldhash=
+if exist "%1.p6" if exist "%1.p6h" set /p oldhash=< %1.p6h
+if "%oldhash%"=="%hash%" (
+
+    echo %1 is up to date
+    exit /b 0
+
+)
+if exist "%1.p6h" del %1.p6h
+
+rem
+rem pcom works on prd and prr in the current directory, so each compile runs
+rem in its own directory, with the sources of all modules, including those
+rem from libs, copied in for uses and joins.
+rem
+echo Compiling %1...
+set dir=%TEMP%\build_%1
+if exist "%dir%" rm -rf "%dir%"
+mkdir "%dir%"
+echo|set /p="{$e+,h-}" > "%dir%\prd"
+call :findsrc %1
+cat "%src%" >> "%dir%\prd"
+for %%d in (%order%) do (
+
+    call :findsrc %%d
+    cp "!src!" "%dir%\%%d.pas"
+
+)
+pushd "%dir%"
+pcom > %1.err
+popd
+mv "%dir%\%1.err" %1.err
+grep -q "Errors in program: 0" %1.err
+if errorlevel 1 (
+
+    echo *** Error: Compile of %1 failed, see %1.err
+    rm -rf "%dir%"
+    exit /b 1
+
+)
+if exist "%1.p6" del %1.p6
+if exist "%1.p6b" del %1.p6b
+mv "%dir%\prr" %1.p6
+if exist "%dir%\prb" mv "%dir%\prb" %1.p6b
+echo %hash%> %1.p6h
+rm -rf "%dir%"
+exit /b 0
+
+rem
+rem Terminate program
+rem
+:stop
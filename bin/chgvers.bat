@@ -16,6 +16,9 @@ call chgver sample_programs\match.cmp %1 %2
 call chgver sample_programs\pascals.cmp %1 %2
 call chgver sample_programs\roman.cmp %1 %2
 call chgver sample_programs\startrek.cmp %1 %2
+call chgver sample_programs\tokenize.cmp %1 %2
+call chgver sample_programs\bitset.cmp %1 %2
+call chgver sample_programs\sparset.cmp %1 %2
 
 call chgver standard_tests\iso7185pat.cmp
 call chgver standard_tests\iso7185pats.cmp
@@ -14,6 +14,7 @@ rem The files are:
 rem
 rem <file>.pas - The Pascal source file
 rem <file>.p6  - The intermediate file produced
+rem <file>.p6b - The binary instructions, if compiled with option c2
 rem <file>.err - The errors output from the compiler
 rem
 rem Note that the l+ option must be specified to get a full
@@ -55,6 +56,7 @@ for %%x in (%*) do (
 		echo.
 		echo ^<file^>.pas - The Pascal source file
 		echo ^<file^>.p6  - The intermediate file produced
+		echo ^<file^>.p6b - The binary instructions, if compiled with option c2
 		echo ^<file^>.err - The errors output from the compiler
 		echo.
 		echo Note that the l+ option must be specified to get a full
@@ -90,13 +92,13 @@ if "%progfile%"=="" (
 
 if "%pmach%"=="1" (
 
-    echo|set /p="{$e+}" > temp
+    echo|set /p="{$e+,h-}" > temp
     copy temp+%progfile%.pas prd
     rm temp
     
 ) else if "%cmach%"=="1" (
 
-    echo|set /p="{$e+}" > temp
+    echo|set /p="{$e+,h-}" > temp
     copy temp+%progfile%.pas prd
     rm temp
 
@@ -105,6 +107,7 @@ if "%pmach%"=="1" (
     cp %progfile%.pas prd
     
 )
+if exist prb del prb
 pcom > %progfile%.err
 rem
 rem The status of the compile is not returned, so convert a non-zero
@@ -119,6 +122,11 @@ if exist "%progfile%.p6" del %progfile%.p6
 mv prr %progfile%.p6
 chmod +w %progfile%.p6
 rem
+rem Move the binary instructions, if made, to <file.p6b>
+rem
+if exist "%progfile%.p6b" del %progfile%.p6b
+if exist prb mv prb %progfile%.p6b
+rem
 rem Terminate program
 rem
 :stop
@@ -15,6 +15,7 @@ flip -u bin\cpints
 flip -u bin\diffnole
 flip -u bin\doseol
 flip -u bin\fixeol
+flip -u bin\plink
 flip -u bin\make_flip
 flip -u bin\p5
 flip -u bin\regress
@@ -48,6 +49,7 @@ flip -m bin\cpints.bat
 flip -m bin\diffnole.bat
 flip -m bin\doseol.bat
 rem flip -m     bin\fixeol.bat
+flip -m bin\plink.bat
 flip -m bin\make_flip.bat
 flip -m bin\p5.bat
 flip -m bin\prtprt.bat
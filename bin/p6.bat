@@ -76,19 +76,19 @@ for %%x in (%*) do (
     	echo Compiling %%~x...
     	if "!pmach!"=="1" (
     	
-    		echo|set /p="{$e+}" > temp
+    		echo|set /p="{$e+,h-}" > temp
     		copy temp+%%~x.pas prd
     		rm temp
     		
     	) else if "!cmach!"=="1" (
 
-    		echo|set /p="{$e+}" > temp
+    		echo|set /p="{$e+,h-}" > temp
     		copy temp+%%~x.pas prd
     		rm temp
     	
     	) else if "!package!"=="1" (
 
-    		echo|set /p="{$e+}" > temp
+    		echo|set /p="{$e+,h-}" > temp
     		copy temp+%%~x.pas prd
     		rm temp
     	
@@ -52,7 +52,7 @@ for %%x in (%*) do (
       
     	)
     	echo Compiling %%~x...
-   		echo|set /p="{$e+}" > temp
+   		echo|set /p="{$e+,h-}" > temp
    		cat temp %%~x.pas > prd
    		rm temp
     	pcom
@@ -0,0 +1,117 @@
+@echo off
+rem
+rem Link separately compiled modules into a mach deck
+rem
+rem Concatenates the intermediates of modules compiled with compile --pmach or
+rem --cmach, in the order given, and has pint resolve the references between
+rem them and assemble the result to an object deck for pmach or cmach. There
+rem is no separate object format, the intermediate serves as one.
+rem
+rem Execution:
+rem
+rem plink <file>...
+rem
+rem <file> is the filename without extention. The files are given in the same
+rem order as they would be to p6, with the main program last.
+rem
+rem The files are:
+rem
+rem <file>.p6  - The intermediate file for each module
+rem <file>.p6b - The binary instructions for each module compiled with c2
+rem <file>.p6o - The object deck produced, named after the last file
+rem <file>.lnk - The output of the link, named after the last file
+rem
+rem After a change, only the changed modules and the modules that use or join
+rem them need to be compiled again before linking.
+rem
+setlocal EnableDelayedExpansion
+set progfile=
+rm -f temp.p6 temp.p6b
+for %%x in (%*) do (
+
+    if "%%~x"=="--help" (
+   	
+		echo.
+		echo Link separately compiled modules into a mach deck
+		echo.
+		echo Concatenates the intermediates of modules compiled with compile --pmach or
+		echo --cmach, in the order given, and has pint resolve the references between
+		echo them and assemble the result to an object deck for pmach or cmach. There
+		echo is no separate object format, the intermediate serves as one.
+		echo.
+		echo Execution:
+		echo.
+		echo plink ^<file^>...
+		echo.
+		echo ^<file^> is the filename without extention. The files are given in the same
+		echo order as they would be to p6, with the main program last.
+		echo.
+		echo The files are:
+		echo.
+		echo ^<file^>.p6  - The intermediate file for each module
+		echo ^<file^>.p6b - The binary instructions for each module compiled with c2
+		echo ^<file^>.p6o - The object deck produced, named after the last file
+		echo ^<file^>.lnk - The output of the link, named after the last file
+		echo.
+		goto stop
+   		
+    ) else if not "%%~x"=="" (
+    
+    	if not exist "%%~x.p6" (
+  
+        	echo %%~x.p6 does not exist
+        	rm -f temp.p6 temp.p6b
+        	goto stop
+      
+    	)
+    	if exist temp.p6 (
+    	
+    	   copy temp.p6+%%~x.p6 temp
+    	
+    	) else (
+    	
+    	    cp %%~x.p6 temp
+    	
+    	)
+    	mv temp temp.p6
+    	if exist "%%~x.p6b" (
+    	    if exist temp.p6b (
+    	       copy /b temp.p6b+%%~x.p6b temp
+    	    ) else (
+    	        cp %%~x.p6b temp
+    	    )
+    	    mv temp temp.p6b
+    	)
+    	set progfile=%%~x
+    	
+    ) 
+
+)
+
+if "%progfile%"=="" (
+
+    echo *** Error: No link file specified
+    exit /b 1
+
+)
+
+rem
+rem pint resolves the external references and writes the deck
+rem
+mv temp.p6 prd
+if exist prb del prb
+if exist temp.p6b mv temp.p6b prb
+rm -f prr
+pint > %progfile%.lnk
+if not exist prr goto fail
+for %%f in (prr) do if %%~zf==0 goto fail
+if exist "%progfile%.p6o" del %progfile%.p6o
+mv prr %progfile%.p6o
+goto stop
+:fail
+echo *** Error: Link failed, see %progfile%.lnk
+exit /b 1
+rem
+rem Terminate program
+rem
+:stop
@@ -99,6 +99,8 @@ call testprog %option% sample_programs\prime
 wc -l sample_programs\prime.dif >> regress_report.txt
 call testprog %option% sample_programs\qsort
 wc -l sample_programs\qsort.dif >> regress_report.txt
+call testprog %option% sample_programs\qsortb
+wc -l sample_programs\qsortb.dif >> regress_report.txt
 call testprog %option% sample_programs\fbench
 wc -l sample_programs\fbench.dif >> regress_report.txt
 call testprog %option% sample_programs\drystone
@@ -107,6 +109,18 @@ call testprog %option% sample_programs\startrek
 wc -l sample_programs\startrek.dif >> regress_report.txt
 call testprog %option% sample_programs\basics
 wc -l sample_programs\basics.dif >> regress_report.txt
+call testprog %option% sample_programs\tokenize
+wc -l sample_programs\tokenize.dif >> regress_report.txt
+call testprog %option% sample_programs\bitset
+wc -l sample_programs\bitset.dif >> regress_report.txt
+call testprog %option% sample_programs\tailcall
+wc -l sample_programs\tailcall.dif >> regress_report.txt
+call testprog %option% --cmpfile sample_programs\tailcall sample_programs\tailcall0
+wc -l sample_programs\tailcall0.dif >> regress_report.txt
+call testprog %option% sample_programs\wordset
+wc -l sample_programs\wordset.dif >> regress_report.txt
+call testprog %option% sample_programs\sparset
+wc -l sample_programs\sparset.dif >> regress_report.txt
 call testprog %option% basic\basic
 wc -l basic\basic.dif >> regress_report.txt
 rem
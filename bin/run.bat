@@ -13,6 +13,7 @@ rem
 rem The files are:
 rem
 rem <file>.p6  - The intermediate file
+rem <file>.p6b - The binary instructions, if compiled with option c2
 rem <file>.out - The prr file produced
 rem <file>.inp - The input file to the program
 rem <file>.lst - The output file from the program
@@ -60,6 +61,7 @@ for %%x in (%*) do (
 		echo The files are:
 		echo.
 		echo ^<file^>.p6  - The intermediate file
+		echo ^<file^>.p6b - The binary instructions, if compiled with option c2
 		echo ^<file^>.out - The prr file produced
 		echo ^<file^>.inp - The input file to the program
 		echo ^<file^>.lst - The output file from the program
@@ -107,6 +109,12 @@ if not exist "%progfile%.inp" (
 
 )
 
+rem
+rem The binary instructions go with the intermediate
+rem
+if exist prb del prb
+if exist "%progfile%.p6b" cp %progfile%.p6b prb
+
 if "%pmach%"=="1" (
 
     echo Running with pmach
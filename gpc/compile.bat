@@ -90,13 +90,13 @@ if "%progfile%"=="" (
 
 if "%pmach%"=="1" (
 
-    echo|set /p="{$e+}" > temp
+    echo|set /p="{$e+,h-}" > temp
     cat temp %progfile%.pas > prd
     rm temp
     
 ) else if "%cmach%"=="1" (
 
-    echo|set /p="{$e+}" > temp
+    echo|set /p="{$e+,h-}" > temp
     cat temp %progfile%.pas > prd
     rm temp
 
@@ -0,0 +1,193 @@
+(* Large set benchmark
+
+   Runs the same work on sets of a large subrange and on the packed array of
+   boolean that is the usual way to write them when sets are limited to 256
+   elements: a sieve of primes, a search of the nodes reachable in a generated
+   graph, and whole set operations on multiples. The input selects 's' for
+   sets, 'b' for boolean arrays or 'a' for both, so each can be timed alone.
+   Both must find the same counts. A last test builds sets of integer
+   elements where the large set they meet is only the right operand or a
+   parameter. *)
+
+program bitset(input, output);
+
+const maxn = 7999;   { highest element }
+      passes = 10;   { number of times to run each test }
+
+type node = 0..maxn;
+     nodes = set of node;
+     flags = packed array [node] of boolean;
+
+var mode: char;
+    pass: integer;
+    queue: array [node] of node; { search queue }
+
+{ next node along one of the edges out of a node }
+function edge(v: node; e: integer): node;
+begin
+   case e of
+      1: edge := (v*3+1) mod (maxn+1);
+      2: edge := (v*7+2) mod (maxn+1);
+      3: edge := (v div 2+5) mod (maxn+1)
+   end
+end;
+
+{ count primes with a set }
+function sieves: integer;
+var s: nodes; i, j, c: integer;
+begin
+   s := [2..maxn]; i := 2;
+   while i*i <= maxn do begin
+      if i in s then begin
+         j := i*i;
+         while j <= maxn do begin s := s-[j]; j := j+i end
+      end;
+      i := i+1
+   end;
+   c := 0;
+   for i := 0 to maxn do if i in s then c := c+1;
+   sieves := c
+end;
+
+{ count primes with a boolean array }
+function sieveb: integer;
+var f: flags; i, j, c: integer;
+begin
+   for i := 0 to maxn do f[i] := i >= 2;
+   i := 2;
+   while i*i <= maxn do begin
+      if f[i] then begin
+         j := i*i;
+         while j <= maxn do begin f[j] := false; j := j+i end
+      end;
+      i := i+1
+   end;
+   c := 0;
+   for i := 0 to maxn do if f[i] then c := c+1;
+   sieveb := c
+end;
+
+{ count nodes reachable from node 0, marking them in a set }
+function reachs: integer;
+var seen: nodes; h, t, e: integer; w: node;
+begin
+   seen := [0]; queue[0] := 0; h := 0; t := 1;
+   while h < t do begin
+      for e := 1 to 3 do begin
+         w := edge(queue[h], e);
+         if not (w in seen) then
+            begin seen := seen+[w]; queue[t] := w; t := t+1 end
+      end;
+      h := h+1
+   end;
+   reachs := t
+end;
+
+{ count nodes reachable from node 0, marking them in a boolean array }
+function reachb: integer;
+var seen: flags; h, t, e, i: integer; w: node;
+begin
+   for i := 0 to maxn do seen[i] := false;
+   seen[0] := true; queue[0] := 0; h := 0; t := 1;
+   while h < t do begin
+      for e := 1 to 3 do begin
+         w := edge(queue[h], e);
+         if not seen[w] then
+            begin seen[w] := true; queue[t] := w; t := t+1 end
+      end;
+      h := h+1
+   end;
+   reachb := t
+end;
+
+{ combine multiples of 3 and 5 with whole set operations }
+function bulks: integer;
+var m3, m5, u, d: nodes; i, c: integer;
+begin
+   m3 := []; m5 := [];
+   for i := 0 to maxn do begin
+      if i mod 3 = 0 then m3 := m3+[i];
+      if i mod 5 = 0 then m5 := m5+[i]
+   end;
+   c := 0;
+   for i := 1 to 100 do begin
+      u := m3+m5; d := u-m3*m5;
+      if (d <= u) and (d <> u) and (m3 <= u) then c := c+1
+   end;
+   for i := 0 to maxn do if i in d then c := c+1;
+   bulks := c
+end;
+
+{ combine multiples of 3 and 5 with loops over boolean arrays }
+function bulkb: integer;
+var m3, m5, u, d: flags; i, j, c: integer; sub, eq, sub3: boolean;
+begin
+   for i := 0 to maxn do begin m3[i] := i mod 3 = 0; m5[i] := i mod 5 = 0 end;
+   c := 0;
+   for i := 1 to 100 do begin
+      for j := 0 to maxn do begin
+         u[j] := m3[j] or m5[j]; d[j] := u[j] and not (m3[j] and m5[j])
+      end;
+      sub := true; eq := true; sub3 := true;
+      for j := 0 to maxn do begin
+         if d[j] and not u[j] then sub := false;
+         if d[j] <> u[j] then eq := false;
+         if m3[j] and not u[j] then sub3 := false
+      end;
+      if sub and not eq and sub3 then c := c+1
+   end;
+   for i := 0 to maxn do if d[i] then c := c+1;
+   bulkb := c
+end;
+
+{ count the elements of a set }
+function cnt(s: nodes): integer;
+var i, c: integer;
+begin
+   c := 0;
+   for i := 0 to maxn do if i in s then c := c+1;
+   cnt := c
+end;
+
+{ test each multiple of 7 with sets of integer elements, which are sized
+  from the large set on the right, on the left or from the parameter, and
+  on the left of a small set }
+function mixed: integer;
+var s: nodes; t: set of 0..50; i, c: integer;
+begin
+   s := []; t := [];
+   for i := 0 to maxn do if i mod 7 = 0 then s := s+[i];
+   for i := 0 to 50 do if i mod 7 = 0 then t := t+[i];
+   c := 0;
+   for i := 0 to maxn do begin
+      if [i]+s = s then c := c+1;
+      if s*[i] <> [] then c := c+1;
+      if [i] <= s then c := c+1
+   end;
+   for i := 0 to 50 do if [i] <= t then c := c+1;
+   i := maxn;
+   mixed := c+cnt([i-1, i])
+end;
+
+begin
+
+   if eof(input) then mode := 'a' else read(mode);
+   for pass := 1 to passes do begin
+      if mode in ['s', 'a'] then begin
+         if pass = passes then begin
+            writeln('Set primes:          ', sieves:1);
+            writeln('Set reachable:       ', reachs:1);
+            writeln('Set combined:        ', bulks:1)
+         end else if sieves+reachs+bulks = 0 then writeln('*** error')
+      end;
+      if mode in ['b', 'a'] then begin
+         if pass = passes then begin
+            writeln('Boolean primes:      ', sieveb:1);
+            writeln('Boolean reachable:   ', reachb:1);
+            writeln('Boolean combined:    ', bulkb:1)
+         end else if sieveb+reachb+bulkb = 0 then writeln('*** error')
+      end
+   end;
+   if mode in ['s', 'a'] then writeln('Set operand sizes:   ', mixed:1)
+
+end.
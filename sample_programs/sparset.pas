@@ -0,0 +1,68 @@
+(* Sparse sets
+
+   Sets whose base type reaches past lsethigh are sparse sets, held as a
+   count and the elements in order, so they can range over most of the
+   integers if they hold few of them. This works them over 0..1000000000:
+   building from elements and ranges, membership, union, intersection,
+   difference, comparison, conversion to and from large and full sets, and
+   constructors of integers on the left of a set operator. *)
+
+program sparset(output);
+
+type big = 0..1000000000;
+     bigs = set of big;
+     mid = set of 0..1000;
+
+var a, b, c: bigs;
+    m: mid;
+    x, y: big;
+    i, n: integer;
+
+{ write the members of a set among some values at the edges }
+procedure show(s: bigs);
+
+procedure t(v: integer);
+begin
+   if v in s then write(' ', v:1)
+end;
+
+begin
+   t(0); t(1); t(2); t(3); t(7); t(100); t(255); t(256); t(1000); t(1001);
+   t(65535); t(65536); t(123456); t(999999999); t(1000000000);
+   writeln
+end;
+
+procedure yesno(b: boolean);
+begin
+   if b then writeln(' yes') else writeln(' no')
+end;
+
+begin
+
+   x := 7; y := 123456;
+   a := [x, y, 1000000000, 0]; write('a:'); show(a);
+   b := [3, 1000..1001, 65535..65536, y]; write('b:'); show(b);
+   c := a+b; write('a+b:'); show(c);
+   c := a*b; write('a*b:'); show(c);
+   c := a-b; write('a-b:'); show(c);
+   write('a*b = [y]:'); yesno(a*b = [y]);
+   write('a-b <= a:'); yesno(a-b <= a);
+   write('a >= b:'); yesno(a >= b);
+   write('a <> b:'); yesno(a <> b);
+   i := 999999999; write('999999999 in a:'); yesno(i in a);
+   i := 1000000000; write('1000000000 in a:'); yesno(i in a);
+   write('123456 in a+b:'); yesno(y in a+b);
+   x := 5; y := 3; c := [x..y]; write('[5..3]:'); show(c);
+   m := [1, 255, 1000]; c := m; write('large to sparse:'); show(c);
+   c := [2, 256, 1000]; m := c; c := m; write('sparse to large:'); show(c);
+   c := [0..2, 7]; write('full to sparse:'); show(c);
+   i := 65536; write('[i] = [65536]:'); yesno([i] = [65536]);
+   i := 1001; write('[1001] <= m:'); yesno([i] <= m);
+   i := 256; write('[256] <= m:'); yesno([i] <= m);
+   a := [];
+   for i := 1 to 500 do a := a+[i*2000000];
+   n := 0;
+   for i := 0 to 501 do if i*2000000 in a then n := n+1;
+   write('many:'); writeln(' ', n:1)
+
+end.
@@ -0,0 +1,65 @@
+{$k0}
+(* Self tail calls at k0
+
+   tailcall compiled without the optimizations, so each self call is a plain
+   call with its own frame. The depth read is small enough to fit the stack.
+   The output must be the same as tailcall's, and is compared to its
+   tailcall.cmp. *)
+
+program tailcall(input, output);
+
+type nodep = ^node;
+     node = record next: nodep; v: integer end;
+
+var depth, s, t, i, len, sum, r: integer;
+    list, q: nodep;
+
+{ add up n mod 7 for n down to 1, the call is followed by the return }
+procedure count(n: integer; var s: integer);
+begin
+   if n > 0 then begin s := s+n mod 7; count(n-1, s) end
+end;
+
+{ the same, but the call is followed by a jump to the return }
+procedure countj(n: integer; var s: integer);
+begin
+   if n > 0 then begin s := s+n mod 7; countj(n-1, s) end
+   else s := s+0
+end;
+
+{ count the nodes of a list and add up their values }
+procedure walk(p: nodep; var len, sum: integer);
+begin
+   if p <> nil then begin len := len+1; sum := sum+p^.v; walk(p^.next, len, sum) end
+end;
+
+{ greatest common divisor, by Euclid }
+procedure gcd(a, b: integer; var r: integer);
+begin
+   if b = 0 then r := a else gcd(b, a mod b, r)
+end;
+
+begin
+
+   read(depth);
+   t := 0;
+   for i := 1 to depth do t := t+i mod 7;
+
+   s := 0; count(depth, s);
+   if s = t then writeln('count: ok') else writeln('count: fails');
+   s := 0; countj(depth, s);
+   if s = t then writeln('countj: ok') else writeln('countj: fails');
+
+   list := nil; t := 0;
+   for i := 1 to depth div 20 do begin
+      new(q); q^.v := i mod 13; q^.next := list; list := q; t := t+i mod 13
+   end;
+   len := 0; sum := 0; walk(list, len, sum);
+   if (len = depth div 20) and (sum = t) then writeln('walk: ok')
+   else writeln('walk: fails');
+   while list <> nil do begin q := list; list := list^.next; dispose(q) end;
+
+   gcd(1071, 462, r); writeln('gcd(1071, 462) = ', r:1);
+   gcd(102334155, 63245986, r); writeln('gcd(102334155, 63245986) = ', r:1)
+
+end.
@@ -0,0 +1,134 @@
+(* Tokenizer benchmark
+
+   Reads a Pascal source text from input, then scans it repeatedly into
+   tokens. The scanner is driven by case statements, a dense one on the
+   character classes and a sparse one to find reserved word candidates, which
+   is the typical shape of lexers and state machines. *)
+
+program tokenize(input, output);
+
+const maxbuf = 5000; { size of source buffer }
+      maxwrd = 10;   { maximum significant characters in word }
+      passes = 500;  { number of times to scan the source }
+
+type toktyp = (tident, tkeyword, tnumber, tstring, tcomment, toper, tpunct,
+               tother);
+     word = packed array [1..maxwrd] of char;
+
+var buf:   packed array [1..maxbuf] of char; { source text }
+    len:   integer; { length of that }
+    cnt:   array [toktyp] of integer; { token counts }
+    tt:    toktyp;
+    hash:  integer; { checksum of identifiers }
+    pass:  integer;
+    c:     char;
+
+{ scan the source once }
+procedure scan;
+
+var i, l, h: integer; w, k: word; c: char; t: toktyp;
+
+begin
+   i := 1;
+   while i <= len do begin
+      c := buf[i]; i := i+1;
+      case c of
+
+         ' ': t := tother; { spaces are not counted }
+
+         'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm',
+         'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z',
+         'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M',
+         'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z': begin
+            w := '          '; l := 1; w[1] := c; h := ord(c);
+            while (buf[i] in ['a'..'z', 'A'..'Z', '0'..'9']) and (i <= len) do
+               begin
+               if l < maxwrd then begin l := l+1; w[l] := buf[i] end;
+               h := (h*31+ord(buf[i])) mod 1021; i := i+1
+            end;
+            { find reserved word candidate by first letter and length }
+            case ord(w[1])*100+l of
+               9805: k := 'begin     ';
+               10002: k := 'do        ';
+               10103: k := 'end       ';
+               10502: k := 'if        ';
+               11207: k := 'program   ';
+               11406: k := 'repeat    ';
+               11604: k := 'then      ';
+               11705: k := 'until     ';
+               11803: k := 'var       ';
+               11905: k := 'while     '
+               else k := '          '
+            end;
+            if w = k then t := tkeyword
+            else begin t := tident; hash := (hash+h) mod 10007 end
+         end;
+
+         '0', '1', '2', '3', '4', '5', '6', '7', '8', '9': begin
+            while (buf[i] in ['0'..'9']) and (i <= len) do i := i+1;
+            t := tnumber
+         end;
+
+         '''': begin
+            while (buf[i] <> '''') and (i < len) do i := i+1;
+            i := i+1; t := tstring
+         end;
+
+         '(': if buf[i] = '*' then begin
+                 i := i+1;
+                 while not ((buf[i] = '*') and (buf[i+1] = ')')) and
+                       (i < len) do i := i+1;
+                 i := i+2; t := tcomment
+              end else t := tpunct;
+
+         '{': begin
+            while (buf[i] <> '}') and (i < len) do i := i+1;
+            i := i+1; t := tcomment
+         end;
+
+         ':', '<', '>': begin
+            if buf[i] in ['=', '>'] then i := i+1;
+            t := toper
+         end;
+
+         '+', '-', '*', '/', '=', '^': t := toper;
+
+         ')', '[', ']', ';', ',', '.': t := tpunct
+
+         else t := tother
+
+      end;
+      if c <> ' ' then cnt[t] := cnt[t]+1
+   end
+end;
+
+begin
+
+   { read source, with line ends as spaces }
+   len := 0;
+   while not eof(input) do begin
+      while not eoln(input) do begin
+         read(c); if len < maxbuf-1 then begin len := len+1; buf[len] := c end
+      end;
+      readln;
+      if len < maxbuf-1 then begin len := len+1; buf[len] := ' ' end
+   end;
+   buf[len+1] := ' '; { sentinel for lookahead }
+   writeln('Source characters: ', len:1);
+
+   for tt := tident to tother do cnt[tt] := 0;
+   hash := 0;
+   for pass := 1 to passes do scan;
+
+   writeln('Passes:            ', passes:1);
+   writeln('Identifiers:       ', cnt[tident]:1);
+   writeln('Reserved words:    ', cnt[tkeyword]:1);
+   writeln('Numbers:           ', cnt[tnumber]:1);
+   writeln('Strings:           ', cnt[tstring]:1);
+   writeln('Comments:          ', cnt[tcomment]:1);
+   writeln('Operators:         ', cnt[toper]:1);
+   writeln('Punctuation:       ', cnt[tpunct]:1);
+   writeln('Other:             ', cnt[tother]:1);
+   writeln('Identifier hash:   ', hash:1)
+
+end.
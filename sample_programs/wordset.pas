@@ -0,0 +1,93 @@
+(* Word set boundaries
+
+   Sets whose base type is in 0..wsethigh are held in a word, wsethigh being
+   30 on 32 bit machines and 62 on 64 bit machines. This works the word set
+   instructions at the edges of both: elements 0, wsethigh and wsethigh+1,
+   singletons and ranges built from variables, difference, inclusion, and
+   conversion to and from a full set. On a 32 bit machine sets of 0..62 are
+   full sets, so the output is the same on both. *)
+
+program wordset(output);
+
+type r30 = 0..30;
+     r62 = 0..62;
+     s30 = set of r30;
+     s62 = set of r62;
+     s100 = set of 0..100;
+
+var a, b: s30;
+    c, d: s62;
+    f: s100;
+    x, y: r30;
+    u, v: r62;
+    i: integer;
+
+{ write the members of a set, trying from below to above its range }
+procedure show30(s: s30);
+var i: integer;
+begin
+   for i := -1 to 64 do if i in s then write(' ', i:1);
+   writeln
+end;
+
+procedure show62(s: s62);
+var i: integer;
+begin
+   for i := -1 to 64 do if i in s then write(' ', i:1);
+   writeln
+end;
+
+procedure show100(s: s100);
+var i: integer;
+begin
+   for i := -1 to 101 do if i in s then write(' ', i:1);
+   writeln
+end;
+
+procedure yesno(b: boolean);
+begin
+   if b then writeln(' yes') else writeln(' no')
+end;
+
+begin
+
+   writeln('0..30');
+   x := 0; y := 30;
+   a := [x]; write('[0]:'); show30(a);
+   a := [y]; write('[30]:'); show30(a);
+   a := [x..y]; write('[0..30]:'); show30(a);
+   i := 31; write('31 in [0..30]:'); yesno(i in a);
+   i := 30; write('30 in [0..30]:'); yesno(i in a);
+   i := 0; write('0 in [0..30]:'); yesno(i in a);
+   i := -1; write('-1 in [0..30]:'); yesno(i in a);
+   x := 30; y := 29; a := [x..y]; write('[30..29]:'); show30(a);
+   x := 0; y := 30; b := [x, y];
+   a := [x..y]-b; write('[0..30]-[0,30]:'); show30(a);
+   write('[0,30] <= [0..30]:'); yesno(b <= [x..y]);
+   write('[0..30] >= [0,30]:'); yesno([x..y] >= b);
+   write('[0,30] <= [1..29]:'); yesno(b <= a);
+   write('[0,30] = [30,0]:'); yesno(b = [y, x]);
+   f := b; write('full [0,30]:'); show100(f);
+   f := [0, 30]; b := f; write('word [0,30]:'); show30(b);
+
+   writeln('0..62');
+   u := 0; v := 62;
+   c := [u]; write('[0]:'); show62(c);
+   c := [v]; write('[62]:'); show62(c);
+   c := [u..v]; write('[0..62]:'); show62(c);
+   i := 63; write('63 in [0..62]:'); yesno(i in c);
+   i := 62; write('62 in [0..62]:'); yesno(i in c);
+   i := 0; write('0 in [0..62]:'); yesno(i in c);
+   i := -1; write('-1 in [0..62]:'); yesno(i in c);
+   u := 62; v := 61; c := [u..v]; write('[62..61]:'); show62(c);
+   u := 0; v := 62; d := [u, v];
+   c := [u..v]-d; write('[0..62]-[0,62]:'); show62(c);
+   write('[0,62] <= [0..62]:'); yesno(d <= [u..v]);
+   write('[0..62] >= [0,62]:'); yesno([u..v] >= d);
+   write('[0,62] <= [1..61]:'); yesno(d <= c);
+   write('[0,62] = [62,0]:'); yesno(d = [v, u]);
+   f := d; write('full [0,62]:'); show100(f);
+   f := [0, 62]; d := f; write('word [0,62]:'); show62(d);
+   u := 31; v := 62; c := [u..v]; write('[31..62]:'); show62(c)
+
+end.
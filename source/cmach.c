@@ -152,6 +152,7 @@
 #include <limits.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 #include <ctype.h>
 #include <unistd.h>
 
@@ -227,6 +228,17 @@
 #define DOCHKDEF TRUE /* check undefined accesses */
 #endif
 
+/*
+ * Verify the code deck at load time. The control flow of the loaded code is
+ * walked, and every instruction, branch, call and case table target is checked
+ * to be a valid instruction boundary inside the code. With this on, the pc is
+ * only checked on transfers whose target comes from the stack or store, and
+ * not before every instruction.
+ */
+#ifndef DOVERIFY
+#define DOVERIFY TRUE /* verify code deck */
+#endif
+
 #ifndef ISO7185
 #define ISO7185 FALSE /* iso7185 standard flag */
 #endif
@@ -288,6 +300,8 @@ table is all you should need to adapt to any byte addressable machine.
 #define HEAPAL              4   /* alignment for each heap arena */
 #define GBSAL               4   /* globals area alignment */
 #define SETHIGH           255   /* Sets are 256 values */
+#define WSETHIGH          30    /* Word sets are 0..30, the bits of a positive
+                                   integer */
 #define SETLOW              0
 #define ORDMAXCHAR        255   /* Characters are 8 bit ISO/IEC 8859-1 */
 #define ORDMINCHAR          0
@@ -295,6 +309,8 @@ table is all you should need to adapt to any byte addressable machine.
 #define MARKSIZE           32   /* maxresult+6*ptrsize */
 #define UJPLEN              5   /* length of ujp instruction (used for case
                                    jumps) */
+#define CJPLEN              9   /* length of cjp instruction (used for sparse
+                                   case tables) */
 
 /* Value of nil is 1 because this allows checks for pointers that were
   initialized, which would be zero (since we clear all space to zero).
@@ -326,11 +342,21 @@ table is all you should need to adapt to any byte addressable machine.
 
 #ifdef WRDSIZ64
 #define INTSIZE             8  /* size of integer */
+#ifdef NATALIGN
+/* Natural alignment layout, which must match the pcom and pint used to make
+   the deck */
+#define INTAL               8  /* alignment of integer */
+#else
 #define INTAL               4  /* alignment of integer */
+#endif
 #define INTDIG              20 /* number of decimal digits in integer */
 #define INTHEX              16 /* number of hex digits of integer */
 #define REALSIZE            8  /* size of real */
+#ifdef NATALIGN
+#define REALAL              8  /* alignment of real */
+#else
 #define REALAL              4  /* alignment of real */
+#endif
 #define CHARSIZE            1  /* size of char */
 #define CHARAL              1  /* alignment of char */
 #define CHARMAX             1
@@ -338,7 +364,11 @@ table is all you should need to adapt to any byte addressable machine.
 #define BOOLAL              1  /* alignment of boolean */
 #define PTRSIZE             8  /* size of pointer */
 #define ADRSIZE             8  /* size of address */
+#ifdef NATALIGN
+#define ADRAL               8  /* alignment of address */
+#else
 #define ADRAL               4  /* alignment of address */
+#endif
 #define SETSIZE            32  /* size of set */
 #define SETAL               1  /* alignment of set */
 #define FILESIZE            1  /* required runtime space for file (lfn) */
@@ -352,9 +382,16 @@ table is all you should need to adapt to any byte addressable machine.
 /* Heap alignment should be either the natural word alignment of the
   machine, or the largest object needing alignment that will be allocated.
   It can also be used to enforce minimum block allocation policy. */
+#ifdef NATALIGN
+#define HEAPAL             16  /* alignment for each heap arena */
+#define GBSAL               8  /* globals area alignment */
+#else
 #define HEAPAL              4  /* alignment for each heap arena */
 #define GBSAL               4  /* globals area alignment */
+#endif
 #define SETHIGH           255  /* Sets are 256 values */
+#define WSETHIGH          62   /* Word sets are 0..62, the bits of a positive
+                                  integer */
 #define SETLOW              0
 #define ORDMAXCHAR        255  /* Characters are 8 bit ISO/IEC 8859-1 */
 #define ORDMINCHAR          0
@@ -362,6 +399,8 @@ table is all you should need to adapt to any byte addressable machine.
 #define MARKSIZE           48  /* maxresult+6*ptrsize */
 #define UJPLEN              9  /* length of ujp instruction (used for case
                                   jumps) */
+#define CJPLEN             17  /* length of cjp instruction (used for sparse
+                                  case tables) */
 
 /* Value of nil is 1 because this allows checks for pointers that were
   initialized, which would be zero (since we clear all space to zero).
@@ -587,13 +626,25 @@ typedef enum {
 typedef long cmdinx;            /* index for command line buffer */
 typedef long cmdnum;            /* length of command line buffer */
 typedef char cmdbuf[MAXCMD];   /* buffer for command line */
-/* VAR reference block */
+/* VAR reference block. Each block is on the pushdown stack, and is also a node
+   in a treap ordered by start address, with the highest end address in each
+   subtree, so overlap checks take log time in the number of blocks. */
 typedef struct _varblk *varptr;
 typedef struct _varblk {
     varptr next;  /* next entry */
     address s, e; /* start and end address of block */
+    varptr l, r;  /* left and right subtrees */
+    address m;    /* maximum end address in subtree */
+    long sn;      /* push sequence number, orders equal starts */
+    long p;       /* treap priority */
 } varblk;
 
+/* source line table entry */
+typedef struct {
+    address ad; /* address of first instruction of line */
+    long    ln; /* source line number */
+} linent;
+
 /**************************** Global Variables ********************************/
 
 address pc;      /*program address register*/
@@ -601,7 +652,10 @@ address pctop;   /* top of code store */
 address gbtop;   /* top of globals, size of globals */
 instyp op; lvltyp p; address q;  /*instruction register*/
 address q1,q2; /* extra parameters */
-byte store[MAXSTR] /* complete program storage */
+/* complete program storage. It is aligned in the host for the widest value a
+   deck holds, so that with the natural alignment layout the integers, reals
+   and addresses in it are aligned for the host as well */
+_Alignas(16) byte store[MAXSTR]
 /* package mode fills the program store, sets pctop and executes the prepackaged
    program. */
 #ifdef PACKAGE
@@ -609,6 +663,7 @@ byte store[MAXSTR] /* complete program storage */
 #endif
 ;
 byte storedef[MAXDEF]; /* defined bits */
+byte storeins[MAXDEF]; /* instruction start bits */
 long sdi; /* index for that */
 /* mp  points to {ning of a data segment
    sp  points to top of the stack
@@ -636,6 +691,12 @@ boolean fileoln[MAXFIL+1]; /* last file character read was eoln */
 boolean filbof[MAXFIL+1]; /* beginning of file */
 varptr varlst; /* active var block pushdown stack */
 varptr varfre; /* free var block entries */
+varptr vartre; /* treap root of active var blocks */
+long varseq; /* var block push sequence */
+long varsed; /* var block priority generator seed */
+linent* lintab; /* source line table, in ascending address order */
+long    lincnt; /* number of entries in that */
+long    linmax; /* allocated entries in that */
 
 long i;
 char c1;
@@ -675,9 +736,30 @@ void finish(long e)
     exit(e);
 }
 
+/* find the source line executing. If the deck carried a line table, the line
+   is looked up from the pc, otherwise it is the last line marked by mrkl. The
+   pc is past the instruction executing, so the byte before it is used. */
+long curlin(void)
+{
+    long l, h, m;
+
+    if (!lincnt) return (srclin);
+    l = 0; h = lincnt-1;
+    if (pc-1 < lintab[0].ad) return (0);
+    while (l < h) { /* find last entry at or below pc */
+        m = (l+h+1)/2;
+        if (lintab[m].ad <= pc-1) l = m; else h = m-1;
+    }
+
+    return (lintab[l].ln);
+}
+
 void errors(address a, address l)
-{ printf("\n*** Runtime error\n");
-      if (srclin > 0) printf(" [%ld]: ", srclin);
+{ long ln;
+
+      printf("\n*** Runtime error\n");
+      ln = curlin();
+      if (ln > 0) printf(" [%ld]: ", ln);
       if (l > MAXAST) l = MAXAST;
       while (l > 0) { printf("%c", store[a]); a = a+1; l = l-1; }
       finish(1);
@@ -692,8 +774,11 @@ void errors(address a, address l)
 
 /* handle exception vector */
 void errorv(address ea)
-{ printf("\n*** Runtime error");
-  if (srclin > 0) printf(" [%ld]: ", srclin);
+{ long ln;
+
+  printf("\n*** Runtime error");
+  ln = curlin();
+  if (ln > 0) printf(" [%ld]: ", ln);
   switch (ea) {
 
     /* Exceptions that can be intercepted */
@@ -837,6 +922,18 @@ void errorm(address ea)
 #define putswt(s, e, b) do {} while(0)
 #endif
 
+/* get/put bit to instruction start array */
+#define getins(a) (!!((storeins[(a)/8])&(1<<(a)%8)))
+#define putins(a) ((storeins[(a)/8]) |= (1<<(a)%8))
+
+/* check target of dynamic transfer is a verified instruction */
+#if DOVERIFY
+#define chkpc() do { if (pc >= pctop || !getins(pc)) errorv(PCOUTOFRANGE); } \
+                while(0)
+#else
+#define chkpc() do {} while(0)
+#endif
+
 /* check location defined and error */
 #if DOCHKDEF
 #define chkdef(a) (getdef(a)?0:errorv(UNDEFINEDLOCATIONACCESS))
@@ -1095,6 +1192,16 @@ boolean sequ(settype s1, settype s2)
     return (TRUE);
 }
 
+/* word sets hold elements 0..WSETHIGH as the bits of a positive integer */
+
+void wtos(long w, settype s)
+{
+    long i;
+
+    for (i = 0; i < SETSIZE; i++) s[i] = 0;
+    for (i = 0; i <= WSETHIGH; i++) if ((w >> i) & 1) s[i/8] |= 1<<i%8;
+}
+
 boolean sinc(settype s1, settype s2)
 {
     long i;
@@ -1110,7 +1217,8 @@ void errore(long ei)
     address ad;
 
     if (expadr == 0) errorm(pctop+ei); /* no surrounding frame, throw system */
-    mp = expmrk; sp = expstk; pc = expadr; popadr(ad); pshadr(pctop+ei);
+    mp = expmrk; sp = expstk; pc = expadr; chkpc(); popadr(ad);
+    pshadr(pctop+ei);
     ep = getadr(mp+MARKET); /* get the mark ep */
 }
 
@@ -1150,6 +1258,7 @@ void load(FILE* fp)
     address ad, ad2;
     long i, l, cs, csc, b;
     long c;
+    int lay;
 
     ad = 0; l = 1;
     while (l > 0 && (c = fgetc(fp)) != EOF) {
@@ -1164,12 +1273,298 @@ void load(FILE* fp)
         fscanf(fp, "%2lx\n", &csc); if (cs != csc) errorl();
     }
     pctop = ad;
+    /* a deck made before it carried its layout has the default layout */
+#ifdef NATALIGN
+    lay = 0;
+#else
+    lay = 1;
+#endif
+    /* read the layout record and the optional source line table following
+       the terminator */
+    while ((c = fgetc(fp)) == ';') {
+        c = fgetc(fp);
+        if (c == 'a') { /* layout the deck was made for, must match ours */
+            fscanf(fp, "%2lx", &i); lay = i == INTSIZE;
+            fscanf(fp, "%2lx", &i); lay = lay && i == INTAL;
+            fscanf(fp, "%2lx", &i); lay = lay && i == REALAL;
+            fscanf(fp, "%2lx", &i); lay = lay && i == ADRAL;
+            fscanf(fp, "%2lx", &i); lay = lay && i == HEAPAL;
+            fscanf(fp, "%2lx\n", &i); lay = lay && i == GBSAL;
+        } else if (c == 'l') { /* source line */
+            fscanf(fp, "%16lx%8lx\n", &i, &l);
+            if (lincnt >= linmax) {
+                linmax = linmax ? linmax*2 : 1024;
+                lintab = (linent*) realloc(lintab, linmax*sizeof(linent));
+                if (!lintab) { printf("*** Out of memory for line table\n"); finish(1); }
+            }
+            lintab[lincnt].ad = i; lintab[lincnt].ln = l; lincnt++;
+        } else errorl();
+    }
+    if (!lay) {
+        printf("\n*** Code deck layout does not match\n");
+        finish(1);
+    }
 } /*load*/
 
+/* find length of instruction operands in bytes, or -1 if the opcode is not
+   one the assembler generates */
+long oplen(byte op)
+{
+    long l;
+
+    switch (op) {
+
+    /* p and q */
+    case 0: case 193: case 105: case 106: case 107: case 108: case 109:
+    case 2: case 195: case 70: case 71: case 72: case 73: case 74: case 4:
+    case 120: case 11: case 12: case 112: case 114: case 244: case 245:
+    case 254: case 255:
+        l = 1+ADRSIZE; break;
+
+    /* p only */
+    case 113 /*cip*/: l = 1; break;
+
+    /* single byte */
+    case 15 /*csp*/: case 126 /*ldcb*/: case 127 /*ldcc*/: l = 1; break;
+
+    /* integer */
+    case 123 /*ldci*/: case 174 /*mrkl*/: l = INTSIZE; break;
+
+    /* q */
+    case 142: case 148: case 154: case 160: case 166: case 172:
+    case 16: case 55: case 117: case 118:
+    case 198: case 9: case 85: case 86: case 87: case 88: case 89: case 10:
+    case 90: case 93: case 94: case 57: case 103: case 104: case 175:
+    case 177: case 178: case 179: case 180: case 201: case 202: case 203:
+    case 211: case 214: case 237: case 241: case 92:
+    case 1: case 194: case 65: case 66: case 67: case 68: case 69:
+    case 3: case 196: case 75: case 76: case 77: case 78: case 79: case 27:
+    case 5: case 213: case 23: case 24: case 25: case 119: case 207: case 21:
+    case 13: case 173: case 124: case 7: case 26: case 95: case 97: case 98:
+    case 99: case 190: case 199: case 56: case 61: case 20: case 242: case 243:
+    case 252:
+        l = ADRSIZE; break;
+
+    /* q and q1 */
+    case 91: case 63: case 64: case 122: case 133: case 210: case 212:
+    case 223: case 226: case 235: case 238: case 239: case 240: case 8:
+        l = ADRSIZE*2; break;
+
+    /* q, q1 and q2 */
+    case 191: case 192: case 100: case 101: case 102: case 111: case 115:
+    case 116: case 121:
+        l = ADRSIZE*3; break;
+
+    /* no operands */
+    case 125: case 14: case 128: case 129: case 130: case 131: case 132:
+    case 204: case 236: case 17: case 137: case 138: case 139: case 140:
+    case 141: case 18: case 143: case 144: case 145: case 146: case 147:
+    case 19: case 149: case 150: case 151: case 152: case 153: case 155:
+    case 156: case 157: case 158: case 159: case 161: case 162: case 163:
+    case 164: case 165: case 167: case 168: case 169: case 170: case 171:
+    case 59: case 134: case 136: case 200: case 6: case 80: case 81: case 82:
+    case 83: case 84: case 197: case 28: case 29: case 30: case 31: case 32:
+    case 33: case 34: case 35: case 36: case 37: case 38: case 39: case 40:
+    case 41: case 42: case 43: case 44: case 45: case 46: case 47: case 48:
+    case 49: case 50: case 51: case 52: case 53: case 54: case 58: case 60:
+    case 62: case 110: case 205: case 206: case 208: case 209: case 135:
+    case 176: case 215: case 216: case 217: case 218: case 219: case 220:
+    case 221: case 222: case 224: case 225: case 227: case 181: case 182:
+    case 183: case 184: case 185: case 186: case 187: case 188: case 189:
+    case 22: case 96: case 246: case 247: case 248: case 249: case 250:
+    case 251: case 253:
+        l = 0; break;
+
+    default: l = -1; break;
+
+    }
+
+    return (l);
+}
+
+/* print code deck verify error and quit */
+void errorvfy(address a, char* s)
+{
+    printf("\n*** Invalid code deck: %s at address %08lX\n", s, a);
+    finish(1);
+}
+
+address* vfystk; /* code addresses pending verify walk */
+long     vfymax; /* allocated entries in that */
+long     vfytop; /* number of entries in that */
+
+/* push code address to verify, after checking it is inside the code */
+void vfypsh(address a, address t)
+{
+    if (t < 0 || t >= pctop) errorvfy(a, "target address out of range");
+    if (vfytop >= vfymax) {
+        vfymax = vfymax ? vfymax*2 : 1024;
+        vfystk = (address*) realloc(vfystk, vfymax*sizeof(address));
+        if (!vfystk) { printf("*** Out of memory for verify\n"); finish(1); }
+    }
+    vfystk[vfytop++] = t;
+}
+
+/* Verify the code deck. The code is walked from the start address along all
+   fall through, branch, call, procedure address, exception handler and case
+   table paths, and each instruction start found is marked. Operands that are
+   code addresses must point inside the code, and frame sizes must be in
+   bounds. Finally no marked instruction may overlap another, so that every
+   target is an instruction boundary. */
+void verify(void)
+{
+    address a, t, e;
+    long l;
+    byte op;
+
+    vfystk = NULL; vfymax = 0; vfytop = 0;
+    vfypsh(0, 0); /* start at beginning of code */
+    while (vfytop) {
+        a = vfystk[--vfytop];
+        /* walk straight line code until done or already visited */
+        while (a >= pctop || !getins(a)) {
+            if (a >= pctop) errorvfy(a, "fall through past end of code");
+            op = store[a]; l = oplen(op);
+            if (l < 0) errorvfy(a, "invalid instruction");
+            if (a+1+l > pctop) errorvfy(a, "instruction past end of code");
+            putins(a);
+            switch (op) {
+            case 23 /*ujp*/: case 24 /*fjp*/: case 119 /*tjp*/:
+            case 21 /*cal*/: case 207 /*bge*/: case 91 /*suv*/:
+                vfypsh(a, getadr(a+1)); break;
+            case 12 /*cup*/: case 245 /*cut*/: case 112 /*ipj*/:
+            case 114 /*lpa*/:
+                vfypsh(a, getadr(a+2)); break;
+            case 8 /*cjp*/: vfypsh(a, getadr(a+1+ADRSIZE)); break;
+            case 25 /*xjp*/:
+                /* the case table is a run of ujp/ujc instructions, which
+                   can't be found by fall through */
+                t = getadr(a+1);
+                if (t < 0 || t+UJPLEN > pctop ||
+                    (store[t] != 23 && store[t] != 61))
+                    errorvfy(a, "case table not found");
+                while (t+UJPLEN <= pctop && (store[t] == 23 || store[t] == 61))
+                    { vfypsh(a, t); t = t+UJPLEN; }
+                break;
+            case 242 /*xjt*/:
+                /* the table follows, with the else entry first */
+                t = getadr(a+1);
+                if (t < 0 || t+2*INTSIZE > pctop)
+                    errorvfy(a, "case bounds out of range");
+                e = a+1+ADRSIZE+(getint(t+INTSIZE)-getint(t)+2)*UJPLEN;
+                if (e <= a+1+ADRSIZE || e > pctop)
+                    errorvfy(a, "case table out of range");
+                for (t = a+1+ADRSIZE; t < e; t = t+UJPLEN) {
+                    if (store[t] != 23 && store[t] != 61)
+                        errorvfy(t, "invalid case table entry");
+                    vfypsh(a, t);
+                }
+                break;
+            case 243 /*xjs*/:
+                /* the table of cjp entries follows, then the miss entry, which
+                   are found by fall through */
+                t = a+1+ADRSIZE+getadr(a+1)*CJPLEN;
+                if (getadr(a+1) < 0 || t+UJPLEN > pctop)
+                    errorvfy(a, "case table out of range");
+                if (store[t] != 23 && store[t] != 61)
+                    errorvfy(t, "invalid case table entry");
+                for (t = a+1+ADRSIZE; t < a+1+ADRSIZE+getadr(a+1)*CJPLEN;
+                     t = t+CJPLEN)
+                    if (store[t] != 8) errorvfy(t, "invalid case table entry");
+                break;
+            case 13 /*ents*/: case 173 /*ente*/:
+                if (getadr(a+1) > 0 || getadr(a+1) < -MAXSTR)
+                    errorvfy(a, "frame size out of range");
+                break;
+            case 254 /*lgs*/:
+                if (store[a+1] > 31 || store[a+1] == 30 ||
+                    getadr(a+2) <= 0 || getadr(a+2) > MAXSTR)
+                    errorvfy(a, "invalid large set operation");
+                break;
+            case 255 /*bfd*/:
+                if (store[a+1] > 3 || (getadr(a+2) != 1 && getadr(a+2) != 2 &&
+                    getadr(a+2) != 4))
+                    errorvfy(a, "invalid bit field operation");
+                break;
+            }
+            /* stop on instructions that don't fall through */
+            if (op == 23 /*ujp*/ || op == 25 /*xjp*/ || op == 242 /*xjt*/ ||
+                op == 61 /*ujc*/ ||
+                op == 58 /*stp*/ || op == 22 /*ret*/ || op == 112 /*ipj*/ ||
+                op == 209 /*mse*/ || op == 14 /*retp*/ || op == 128 /*reti*/ ||
+                op == 129 /*retr*/ || op == 130 /*retc*/ ||
+                op == 131 /*retb*/ || op == 132 /*reta*/ ||
+                op == 204 /*retx*/ || op == 236 /*rets*/ ||
+                op == 237 /*retm*/) break;
+            a = a+1+l;
+        }
+    }
+    free(vfystk);
+    /* check no instruction overlaps the next */
+    for (a = 0; a < pctop; a++) if (getins(a)) {
+        l = oplen(store[a]);
+        for (t = a+1; t <= a+l; t++)
+            if (getins(t)) errorvfy(t, "branch into instruction");
+    }
+}
+
 /*------------------------------------------------------------------------*/
 
 /* runtime handlers */
 
+/* find if block a sorts before block b */
+#define varbfr(a, b) ((a)->s < (b)->s || ((a)->s == (b)->s && (a)->sn < (b)->sn))
+
+/* recalculate maximum end address of treap node */
+void varfix(varptr t)
+{
+    t->m = t->e;
+    if (t->l && t->l->m > t->m) t->m = t->l->m;
+    if (t->r && t->r->m > t->m) t->m = t->r->m;
+}
+
+/* insert node into treap */
+varptr varins(varptr t, varptr n)
+{
+    varptr c;
+
+    if (!t) return (n);
+    if (varbfr(n, t)) {
+        t->l = varins(t->l, n);
+        if (t->l->p > t->p) /* rotate right */
+            { c = t->l; t->l = c->r; varfix(t); c->r = t; t = c; }
+    } else {
+        t->r = varins(t->r, n);
+        if (t->r->p > t->p) /* rotate left */
+            { c = t->r; t->r = c->l; varfix(t); c->l = t; t = c; }
+    }
+    varfix(t);
+
+    return (t);
+}
+
+/* join treaps, all of which a sorts before b */
+varptr varjoin(varptr a, varptr b)
+{
+    if (!a) return (b);
+    if (!b) return (a);
+    if (a->p > b->p) { a->r = varjoin(a->r, b); varfix(a); return (a); }
+    b->l = varjoin(a, b->l); varfix(b);
+
+    return (b);
+}
+
+/* remove node from treap */
+varptr vardel(varptr t, varptr n)
+{
+    if (t == n) return (varjoin(t->l, t->r));
+    if (varbfr(n, t)) t->l = vardel(t->l, n);
+    else t->r = vardel(t->r, n);
+    varfix(t);
+
+    return (t);
+}
+
 void varenter(address s, address e)
 
 {
@@ -1178,6 +1573,9 @@ void varenter(address s, address e)
     if (varfre) { vp = varfre; varfre = vp->next; }
     else vp = (varptr) malloc(sizeof(varblk));
     vp->s = s; vp->e = e; vp->next = varlst; varlst = vp;
+    vp->l = NULL; vp->r = NULL; vp->m = e; vp->sn = varseq++;
+    varsed = (varsed*25173+13849)%65536; vp->p = varsed;
+    vartre = varins(vartre, vp);
 }
 
 void varexit(void)
@@ -1186,6 +1584,7 @@ void varexit(void)
 
     if (!varlst) errorv(VARLISTEMPTY);
     vp = varlst; varlst = vp->next; vp->next = varfre; varfre = vp;
+    vartre = vardel(vartre, vp);
 }
 
 long varlap(address s, address e)
@@ -1193,10 +1592,14 @@ long varlap(address s, address e)
     varptr vp;
     long f;
 
-    vp = varlst; f = FALSE;
+    /* if the left subtree reaches s, any overlap to the right would start past
+       e, so it is enough to look left */
+    vp = vartre; f = FALSE;
     while (vp && !f) {
         f = (vp->e >= s && vp->s <= e);
-        vp = vp->next;
+        if (vp->l && vp->l->m >= s) vp = vp->l;
+        else if (vp->s <= e) vp = vp->r;
+        else vp = NULL;
     }
 
     return (f);
@@ -1211,17 +1614,292 @@ address base(long ld)
     return (ad);
 } /*base*/
 
+/* Block store operations. These work a word at a time where they can, and
+   leave the byte loops to the library memmove(), which is vectorized on most
+   hosts. */
+
+/* find first differing byte between two runs of store, or n if equal */
+long fnddif(address a1, address a2, long n)
+{
+    long i;
+    unsigned long long w1, w2;
+
+    i = 0;
+    while (i+8 <= n) {
+        memcpy(&w1, &store[a1+i], 8); memcpy(&w2, &store[a2+i], 8);
+        if (w1 != w2) break;
+        i = i+8;
+    }
+    while (i < n && store[a1+i] == store[a2+i]) i = i+1;
+    return (i);
+} /*fnddif*/
+
+#if DOCHKDEF
+/* check a run of store is entirely defined */
+boolean rngdef(address a, long n)
+{
+    unsigned long long w;
+
+    while (n > 0 && a%8) { if (!getdef(a)) return (FALSE); a = a+1; n = n-1; }
+    while (n >= 64) {
+        memcpy(&w, &storedef[a/8], 8);
+        if (w != ~0ULL) return (FALSE);
+        a = a+64; n = n-64;
+    }
+    while (n >= 8) {
+        if (storedef[a/8] != 0xff) return (FALSE);
+        a = a+8; n = n-8;
+    }
+    while (n > 0) { if (!getdef(a)) return (FALSE); a = a+1; n = n-1; }
+    return (TRUE);
+} /*rngdef*/
+
+/* copy defined bits for a run of store, with memmove() semantics */
+void movdef(address d, address s, long n)
+{
+    long i;
+    unsigned sh;
+
+    if (d == s || n <= 0) return;
+    if (d > s && d < s+n) {
+        /* overlapping upwards, go bit by bit from the top */
+        for (i = n-1; i >= 0; i--) putdef(d+i, getdef(s+i));
+        return;
+    }
+    /* bits until the destination is on a byte */
+    while (n > 0 && d%8) { putdef(d, getdef(s)); d = d+1; s = s+1; n = n-1; }
+    if (s%8 == 0) memmove(&storedef[d/8], &storedef[s/8], n/8);
+    else {
+        /* source is off byte, assemble each destination byte from two */
+        sh = s%8;
+        for (i = 0; i < n/8; i++)
+          storedef[d/8+i] = (storedef[s/8+i] >> sh) |
+                            (storedef[s/8+i+1] << (8-sh));
+    }
+    d = d+n/8*8; s = s+n/8*8; n = n%8;
+    while (n > 0) { putdef(d, getdef(s)); d = d+1; s = s+1; n = n-1; }
+} /*movdef*/
+#else
+#define rngdef(a, n) TRUE
+#define movdef(d, s, n) do {} while(0)
+#endif
+
+/* move a run of store along with its defined bits */
+void movstr(address d, address s, long n)
+{
+    if (n <= 0) return;
+    memmove(&store[d], &store[s], n);
+    movdef(d, s, n);
+} /*movstr*/
+
+/* Large sets are bitmaps of a whole number of words, element i being bit i%8
+   of byte i/8, the same layout as the standard set. The kernels below work
+   them 8 bytes at a time, then by bytes for any remainder. */
+
+/* check a large set is defined */
+#define lschk(a, n) \
+    do { if (DOCHKDEF && !rngdef(a, n)) errorv(UNDEFINEDLOCATIONACCESS); } \
+    while(0)
+
+/* combine large set s into d, o = 0 union, 1 intersection, 2 difference */
+void lsop(address d, address s, long n, int o)
+{
+    long i;
+    unsigned long long w1, w2;
+
+    i = 0;
+    while (i+8 <= n) {
+        memcpy(&w1, &store[d+i], 8); memcpy(&w2, &store[s+i], 8);
+        if (o == 0) w1 |= w2; else if (o == 1) w1 &= w2; else w1 &= ~w2;
+        memcpy(&store[d+i], &w1, 8);
+        i = i+8;
+    }
+    for (; i < n; i++)
+        if (o == 0) store[d+i] |= store[s+i];
+        else if (o == 1) store[d+i] &= store[s+i];
+        else store[d+i] &= ~store[s+i];
+} /*lsop*/
+
+/* find if large set a1 is included in a2 */
+boolean lsinc(address a1, address a2, long n)
+{
+    long i;
+    unsigned long long w1, w2;
+
+    i = 0;
+    while (i+8 <= n) {
+        memcpy(&w1, &store[a1+i], 8); memcpy(&w2, &store[a2+i], 8);
+        if (w1 & ~w2) return (FALSE);
+        i = i+8;
+    }
+    for (; i < n; i++) if (store[a1+i] & ~store[a2+i]) return (FALSE);
+    return (TRUE);
+} /*lsinc*/
+
+/* find if a run of store holds any set bits */
+boolean lsany(address a, long n)
+{
+    long i;
+    unsigned long long w;
+
+    i = 0;
+    while (i+8 <= n) {
+        memcpy(&w, &store[a+i], 8);
+        if (w) return (TRUE);
+        i = i+8;
+    }
+    for (; i < n; i++) if (store[a+i]) return (TRUE);
+    return (FALSE);
+} /*lsany*/
+
+/* clear large set, and mark it defined */
+void lsclr(address a, long n)
+{
+    memset(&store[a], 0, n);
+    putswt(a, a+n-1, TRUE);
+} /*lsclr*/
+
+/* set the elements i1..i2 in large set */
+void lsrng(address a, long i1, long i2)
+{
+    /* bits to the first whole byte */
+    while (i1 <= i2 && i1%8) { store[a+i1/8] |= 1<<i1%8; i1++; }
+    /* whole bytes */
+    if (i2-i1+1 >= 8) {
+        memset(&store[a+i1/8], 0xff, (i2-i1+1)/8);
+        i1 = i1+(i2-i1+1)/8*8;
+    }
+    /* and the rest */
+    while (i1 <= i2) { store[a+i1/8] |= 1<<i1%8; i1++; }
+} /*lsrng*/
+
+/* Sparse sets are a count of elements, then the elements in ascending
+   order, each a word, in q bytes. Only the count and the elements held are
+   moved. A result is built below the stack, then moved into place. */
+
+/* find element i of sparse set */
+#define spelt(a, i) getint((a)+(i)*INTSIZE)
+
+/* find if element e is in sparse set, by halving */
+boolean spfnd(address a, long e)
+{
+    long l, h, m, x;
+
+    l = 1; h = getint(a);
+    while (l <= h) {
+        m = (l+h)/2; x = spelt(a, m);
+        if (x == e) return (TRUE);
+        if (x < e) l = m+1; else h = m-1;
+    }
+    return (FALSE);
+} /*spfnd*/
+
+/* move sparse set with its count */
+void spmov(address d, address s)
+{
+    movstr(d, s, (getint(s)+1)*INTSIZE);
+} /*spmov*/
+
+/* add element e after the n already in sparse set of q bytes */
+void spadd(address d, long q, long* n, long e)
+{
+    (*n)++;
+    if (*n >= q/INTSIZE) errore(SETELEMENTOUTOFRANGE);
+    putint(d+*n*INTSIZE, e);
+} /*spadd*/
+
+/* combine sparse sets a1 and a2 of q bytes into d, o = 0 union,
+   1 intersection, 2 difference */
+void spop(address d, address a1, address a2, long q, int o)
+{
+    long i1, i2, n1, n2, n, e1, e2;
+
+    n1 = getint(a1); n2 = getint(a2); i1 = 1; i2 = 1; n = 0;
+    while (i1 <= n1 || i2 <= n2) {
+        e1 = i1 <= n1 ? spelt(a1, i1) : 0;
+        e2 = i2 <= n2 ? spelt(a2, i2) : 0;
+        if (i2 > n2 || (i1 <= n1 && e1 < e2))
+            { if (o != 1) spadd(d, q, &n, e1); i1++; }
+        else if (i1 > n1 || e2 < e1)
+            { if (o == 0) spadd(d, q, &n, e2); i2++; }
+        else { if (o != 2) spadd(d, q, &n, e1); i1++; i2++; }
+    }
+    putint(d, n);
+} /*spop*/
+
+/* find if sparse set a1 is included in a2 */
+boolean spinc(address a1, address a2)
+{
+    long i1, i2, n1, n2, e1, e2;
+
+    n1 = getint(a1); n2 = getint(a2); i1 = 1; i2 = 1;
+    while (i1 <= n1) {
+        if (i2 > n2) return (FALSE);
+        e1 = spelt(a1, i1); e2 = spelt(a2, i2);
+        if (e2 > e1) return (FALSE);
+        if (e2 == e1) i1++;
+        i2++;
+    }
+    return (TRUE);
+} /*spinc*/
+
+/* make sparse set d of q bytes from large set a of n bytes */
+void spfrm(address d, address a, long n, long q)
+{
+    long i, c;
+
+    c = 0;
+    for (i = 0; i < n*8; i++)
+        if (store[a+i/8] & 1<<i%8) spadd(d, q, &c, i);
+    putint(d, c);
+} /*spfrm*/
+
+/* make large set d of q bytes from sparse set a */
+void spto(address d, address a, long q)
+{
+    long i, e;
+
+    lsclr(d, q);
+    for (i = 1; i <= getint(a); i++) {
+        e = spelt(a, i);
+        if (e >= q*8) errore(SETELEMENTOUTOFRANGE);
+        store[d+e/8] |= 1<<e%8;
+    }
+} /*spto*/
+
+/* Bit fields of packed arrays. Element i of w bits is bits i*w%8 up of byte
+   i*w/8, w being 1, 2 or 4, so a field never crosses a byte.
+   Definedness is kept per byte, so the first store to any field of a byte
+   marks it defined. Reading another field of that byte before it is stored
+   then gives 0, as allocated store is cleared, with no undefined access
+   error. */
+
+/* get bit field i of w bits from array at a */
+long bfdget(address a, long i, long w)
+{
+    chkdef(a+i*w/8);
+    return (store[a+i*w/8]>>(i*w%8) & ((1<<w)-1));
+} /*bfdget*/
+
+/* put v to bit field i of w bits in array at a */
+void bfdput(address a, long i, long w, long v)
+{
+    long m;
+
+    m = ((1<<w)-1)<<(i*w%8);
+    store[a+i*w/8] = (store[a+i*w/8] & ~m) | (v<<(i*w%8) & m);
+    putdef(a+i*w/8, TRUE);
+} /*bfdput*/
+
 void compare(boolean* b, address* a1, address* a2)
 /*comparing is only correct if result by comparing integers will be*/
 {
     long i;
 
-    i = 0; *b = TRUE;
-    while (*b && i<q) {
-        chkdef(*a1+i); chkdef(*a2+i);
-        if (store[*a1+i] == store[*a2+i]) i = i+1;
-        else *b = FALSE;
-    }
+    i = fnddif(*a1, *a2, q); *b = i == q;
+    /* all locations up to and including the first difference are checked */
+    if (DOCHKDEF) if (!rngdef(*a1, *b ? q : i+1) || !rngdef(*a2, *b ? q : i+1))
+      errorv(UNDEFINEDLOCATIONACCESS);
     if (i == q) i = i-1; /* point at last location */
     *a1 = *a1+i; *a2 = *a2+i;
 } /*compare*/
@@ -1377,7 +2055,8 @@ void newspc(address len, address* blk)
         ad = np; /* save base of new block */
         np = np+(len+ADRSIZE); /* find new heap top */
         ad1 = np; /* save address */
-        alignu(HEAPAL, &np); /* align to arena */
+        /* align to arena, which is the space after the next block header */
+        np = np+ADRSIZE; alignu(HEAPAL, &np); np = np-ADRSIZE;
         len = len+(np-ad1); /* adjust length upwards for alignment */
         if (np > sp) errore(SPACEALLOCATEFAIL);
         putadr(ad, -(len+ADRSIZE)); /* allocate block */
@@ -2327,7 +3006,7 @@ void callsp(void)
                   readr(COMMANDFN, &r, w, FALSE); putrel(ad, r);
                   break;
     case 2/*thw*/: popadr(ad1); mp = expmrk; sp = expstk;
-                  pc = expadr; popadr(ad2); pshadr(ad1);
+                  pc = expadr; chkpc(); popadr(ad2); pshadr(ad1);
                   ep = getadr(mp+MARKET); /* get the mark ep */
                   /* release to search vectors */
                   break;
@@ -2347,7 +3026,8 @@ void sinins()
            pc, sp, mp, store[pc], store[pc]);
     */
 
-    if (pc >= pctop) errorv(PCOUTOFRANGE);
+    /* verified code only needs the pc checked on dynamic transfers */
+    if (!DOVERIFY) if (pc >= pctop) errorv(PCOUTOFRANGE);
 
     /* fetch instruction from byte store */
     getop();
@@ -2404,15 +3084,11 @@ void sinins()
                        break;
 
     case 235 /*stom*/: getq(); getq1(); ad1 = getadr(sp+q1); ad2 = sp;
-                    for (i = 0; i < q; i++) {
-                      store[ad1+i] = store[ad2+i]; putdef(ad1+i, getdef(ad2+i));
-                    }
+                    movstr(ad1, ad2, q);
                     sp = sp+q1+ADRSIZE;
                     break;
     case 238 /*ctb*/: getq(); getq1(); popadr(ad1); ad2 = sp;
-                    for (i = 0; i < q; i++) {
-                      store[ad1+i] = store[ad2+i]; putdef(ad1+i, getdef(ad2+i));
-                    }
+                    movstr(ad1, ad2, q);
                     sp = sp+q1; pshadr(ad1);
                     break;
 
@@ -2459,6 +3135,18 @@ void sinins()
                  /* idem */
                  break;
 
+    case 244 /*msl*/: /*mark stack for a routine that never uses its static
+                        link, p and q as mst*/
+                 getp(); getq();
+                 /* allocate function result as zeros */
+                 for (j = 0; j < q/INTSIZE; j++) pshint(0);
+                 ad = sp; /* save mark base */
+                 /* allocate mark, the routine entry and cup fill the rest */
+                 sp = sp-MARKSIZE;
+                 putadr(ad+MARKDL, mp); /* dl */
+                 putadr(ad+MARKEP, ep); /* ep */
+                 break;
+
     case 12 /*cup*/: /*p=no of locations for parameters, q=entry point*/
                  getp(); getq();
                  mp = sp+(p+MARKSIZE); /* mp to base of mark */
@@ -2466,11 +3154,35 @@ void sinins()
                  pc = q;
                  break;
 
+    case 245 /*cut*/: /*p=no of locations for parameters, q=entry point of
+                        the calling routine itself*/
+                 getp(); getq();
+                 /* if the return follows, directly or by a jump, reuse the
+                    frame: the parameters replace ours and we restart. The
+                    line marks for the lines in between are passed over */
+                 ad = pc;
+                 while (store[ad] == 174 /*mrkl*/) ad += 1+INTSIZE;
+                 if (store[ad] == 23 /*ujp*/) {
+                   ad = getadr(ad+1);
+                   while (store[ad] == 174 /*mrkl*/) ad += 1+INTSIZE;
+                 }
+                 if (store[ad] == 14 /*retp*/) {
+                   ad = mp-MARKSIZE-p; /* our parameters */
+                   for (i = 0; i < p; i++)
+                     { store[ad+i] = store[sp+i]; putdef(ad+i, getdef(sp+i)); }
+                   sp = ad;
+                 } else {
+                   mp = sp+(p+MARKSIZE); /* mp to base of mark */
+                   putadr(mp+MARKRA, pc); /* place ra */
+                 }
+                 pc = q;
+                 break;
+
     case 27 /*cuv*/: /*q=entry point*/
                  getq();
                  mp = sp+(p+MARKSIZE); /* mp to base of mark */
                  putadr(mp+MARKRA, pc); /* place ra */
-                 pc = getadr(q);
+                 pc = getadr(q); chkpc();
                  break;
 
     case 91 /*suv*/: getq(); getq1(); putadr(q1, q); break;
@@ -2478,8 +3190,10 @@ void sinins()
     case 13 /*ents*/: getq(); ad = mp+q; /*q = length of dataseg*/
                     if (ad <= np) errorv(STOREOVERFLOW);
                     /* clear allocated memory and set undefined */
-                    while (sp > ad)
-                      { sp = sp-1; store[sp] = 0; putdef(sp, FALSE); }
+                    if (sp > ad) {
+                      memset(store+ad, 0, sp-ad); putswt(ad, sp-1, FALSE);
+                      sp = ad;
+                    }
                     putadr(mp+MARKSB, sp); /* set bottom of stack */
                     break;
 
@@ -2495,7 +3209,7 @@ void sinins()
                    /* set stack below function result */
                    sp = mp;
                    putint(sp, getchr(sp));
-                   pc = getadr(mp+MARKRA);
+                   pc = getadr(mp+MARKRA); chkpc();
                    ep = getadr(mp+MARKEP);
                    mp = getadr(mp+MARKDL);
                    break;
@@ -2503,7 +3217,7 @@ void sinins()
                    /* set stack below function result */
                    sp = mp;
                    putint(sp, getbol(sp));
-                   pc = getadr(mp+MARKRA);
+                   pc = getadr(mp+MARKRA); chkpc();
                    ep = getadr(mp+MARKEP);
                    mp = getadr(mp+MARKDL);
                    break;
@@ -2515,7 +3229,7 @@ void sinins()
     case 132  /*reta*/:
                    /* set stack below function result, if any */
                    sp = mp;
-                   pc = getadr(mp+MARKRA);
+                   pc = getadr(mp+MARKRA); chkpc();
                    ep = getadr(mp+MARKEP);
                    mp = getadr(mp+MARKDL);
                    break;
@@ -2523,7 +3237,7 @@ void sinins()
     case 237 /*retm*/: getq(); /* we don't use q */
                    /* set stack below function result, if any */
                    sp = mp;
-                   pc = getadr(mp+MARKRA);
+                   pc = getadr(mp+MARKRA); chkpc();
                    ep = getadr(mp+MARKEP);
                    mp = getadr(mp+MARKDL);
                    break;
@@ -2588,7 +3302,26 @@ void sinins()
 
     case 23 /*ujp*/: getq(); pc = q; break;
     case 24 /*fjp*/: getq(); popint(i); if (i == 0) pc = q; break;
-    case 25 /*xjp*/: getq(); popint(i1); pc = i1*UJPLEN+q; break;
+    case 25 /*xjp*/: getq(); popint(i1); pc = i1*UJPLEN+q; chkpc(); break;
+    case 242 /*xjt*/: getq(); popint(i1);
+                   if (i1 < getint(q) || i1 > getint(q+INTSIZE)) {
+                     /* out of range goes to the first entry, the else case */
+                     if (store[pc] == 61 /*ujc*/) errore(VALUEOUTOFRANGE);
+                     pc = getadr(pc+1);
+                   } else pc = getadr(pc+(i1-getint(q)+1)*UJPLEN+1);
+                   break;
+    case 243 /*xjs*/: getq(); popint(i1);
+                   /* binary search the cjp entries for the range holding the
+                      value, a miss executes the entry after the table */
+                   i2 = 0; i3 = q-1; ad = pc+q*CJPLEN; b = FALSE;
+                   while (i2 <= i3 && !b) {
+                     i = (i2+i3)/2; ad1 = pc+i*CJPLEN; a1 = getadr(ad1+1);
+                     if (i1 < getint(a1)) i3 = i-1;
+                     else if (i1 > getint(a1+INTSIZE)) i2 = i+1;
+                     else { b = TRUE; ad = getadr(ad1+1+ADRSIZE); }
+                   }
+                   pc = ad;
+                   break;
 
     case 95 /*chka*/:
     case 190 /*ckla*/: getq(); popadr(a1); pshadr(a1);
@@ -2704,6 +3437,37 @@ void sinins()
     case 47 /*uni*/: popset(s2); popset(s1); suni(s1, s2); pshset(s1);
                      break;
     case 48 /*inn*/: popset(s1); popint(i1); pshint(sisin(i1, s1)); break;
+    case 246 /*sgw*/: popint(i1);
+                      if (i1 < 0 || i1 > WSETHIGH) errore(SETELEMENTOUTOFRANGE);
+                      pshint(1L << i1); break;
+    case 247 /*rgw*/: popint(i2); popint(i1);
+                      if (i1 > i2) pshint(0);
+                      else {
+                        if (i1 < 0 || i2 > WSETHIGH)
+                          errore(SETELEMENTOUTOFRANGE);
+                        /* bits i1..i2, without overflow at the top bit */
+                        pshint((1L << i2)-(1L << i1)+(1L << i2));
+                      }
+                      break;
+    case 248 /*inw*/: popint(i2); popint(i1);
+                      pshint(i1 >= 0 && i1 <= WSETHIGH && ((i2 >> i1) & 1));
+                      break;
+    case 249 /*dfw*/: popint(i2); popint(i1); pshint(i1 & ~i2); break;
+    case 250 /*lew*/: popint(i2); popint(i1); pshint(!(i1 & ~i2)); break;
+    case 251 /*gew*/: popint(i2); popint(i1); pshint(!(i2 & ~i1)); break;
+    case 252 /*swf*/: getq(); /* q = offset of the word set from the top */
+                      wtos(getint(sp+q), s1); ad = sp;
+                      sp = sp-(SETSIZE-INTSIZE);
+                      for (i = 0; i < q; i++)
+                        { store[sp+i] = store[ad+i]; putdef(sp+i, getdef(ad+i)); }
+                      putset(sp+q, s1);
+                      break;
+    case 253 /*sfw*/: popset(s1); i1 = 0;
+                      for (j = SETLOW; j <= SETHIGH; j++) if (sisin(j, s1)) {
+                        if (j > WSETHIGH) errore(SETELEMENTOUTOFRANGE);
+                        i1 |= 1L << j;
+                      }
+                      pshint(i1); break;
     case 49 /*mod*/: popint(i2); popint(i1);
                   if (DOCHKOVF) if (i2 <= 0) errore(INVALIDDIVISORTOMOD);
                   pshint(i1 % i2); break;
@@ -2721,9 +3485,7 @@ void sinins()
                       if (DOCHKOVF) if (r2 == 0.0) errore(ZERODIVIDE);
                       pshrel(r1/r2); break;
     case 55 /*mov*/: getq(); popint(i2); popint(i1);
-                 for (i3 = 0; i3 <= q-1; i3++)
-                   { store[i1+i3] = store[i2+i3];
-                         putdef(i1+i3, getdef(i2+i3)); };
+                 movstr(i1, i2, q);
                  /* q is a number of storage units */
                  break;
     case 56 /*lca*/: getq(); pshadr(q); break;
@@ -2780,7 +3542,7 @@ void sinins()
                 /* replace next link mp with the one for the target */
                 putadr(mp+MARKSL, getadr(ad+1*PTRSIZE));
                 putadr(mp+MARKRA, pc);
-                pc = getadr(ad);
+                pc = getadr(ad); chkpc();
                 break;
     case 114 /*lpa*/: getp(); getq(); /* place procedure address on stack */
                 pshadr(base(p));
@@ -2870,7 +3632,7 @@ void sinins()
                    /* if there is no surrounding frame, handle fixed */
                    if (expadr == 0) errorm(a1);
                    else { /* throw to new frame */
-                     mp = expmrk; sp = expstk; pc = expadr;
+                     mp = expmrk; sp = expstk; pc = expadr; chkpc();
                      popadr(a2); pshadr(a1);
                      ep = getadr(mp+MARKET); /* get the mark ep */
                      /* release to search vectors */
@@ -2886,7 +3648,7 @@ void sinins()
                     { store[ad] = 0; putdef(ad, FALSE); ad = ad+1; }
                   break;
     case 21 /*cal*/: getq(); pshadr(pc); pc = q; break;
-    case 22 /*ret*/: popadr(pc); break;
+    case 22 /*ret*/: popadr(pc); chkpc(); break;
     case 92 /*vbs*/: getq(); popadr(ad); varenter(ad, ad+q-1); break;
     case 96 /*vbe*/: varexit(); break;
     case 19 /*brk*/: break; /* breaks are no-ops here */
@@ -2920,17 +3682,13 @@ void sinins()
                       break;
 
     case 178 /*aps*/: getq(); popadr(ad1); popadr(ad); popadr(ad); popadr(i1);
-                       for (i = 0; i <= i1*q-1; i++) {
-                         store[ad+i] = store[ad1+i]; putdef(ad+i, getdef(ad1+i));
-                       }
+                       movstr(ad, ad1, i1*q);
                       break;
     case 210 /*apc*/: getq(); getq1(); popadr(ad1); popadr(ad); popadr(ad);
                        popadr(ad2);
                        for (i = 1; i <= q; i++)
                          { q1 = q1*getint(ad2); ad2 = ad2+INTSIZE; };
-                       for (i = 0; i <= q1-1; i++) {
-                         store[ad+i] = store[ad1+i]; putdef(ad+i, getdef(ad1+i));
-                       }
+                       movstr(ad, ad1, q1);
                       break;
     case 211 /*cxs*/: getq(); popint(i); popadr(ad); popint(i1);
                        if (i < 1 || i > i1) errore(VALUEOUTOFRANGE);
@@ -2960,9 +3718,7 @@ void sinins()
                        else for (i = 1; i <= q; i++)
                          { q1 = q1*getint(ad3); ad3 = ad3+INTSIZE; }
                        ad2 = sp-q1; alignd(STACKELSIZE, &ad2); sp = ad2;
-                       for (i = 0; i <= q1-1; i++) {
-                         store[ad2+i] = store[ad+i]; putdef(ad2+i, getdef(ad+i));
-                       };
+                       movstr(ad2, ad, q1);
                        pshadr(ad1); pshadr(ad2);
                      break;
     case 224 /*scp*/: popadr(ad); popadr(ad1); popadr(ad2); putadr(ad2, ad);
@@ -2970,24 +3726,142 @@ void sinins()
     case 225 /*ldp*/: popadr(ad); pshadr(getadr(ad+PTRSIZE));
                        pshadr(getadr(ad)); break;
     case 239 /*cpp*/: getq(); getq1(); ad = sp+MARKSIZE+q; sp = sp-q1; ad1 = sp;
-                      for (i = 0; i < q1; i++) {
-                        store[ad1] = store[ad]; putdef(ad1, getdef(ad));
-                        ad = ad+1; ad1 = ad1+1;
-                      }
+                      movstr(ad1, ad, q1);
                       break;
-    case 240 /*cpr*/: getq(); getq1(); ad = sp+q+q1; ad1 = sp+q;
-                      for (i = 0; i < q; i++) {
-                        ad = ad-1; ad1 = ad1-1;
-                        store[ad] = store[ad1]; putdef(ad, getdef(ad1));
-                      }
+    case 240 /*cpr*/: getq(); getq1(); movstr(sp+q1, sp, q);
                       sp = sp+q1;
                       break;
 
     case 241 /*lsa*/: getq(); pshadr(sp+q); break;
 
+    case 254 /*lgs*/: getp(); getq(); /* p = operation, q = size of sets */
+      switch (p) {
+        case 0 /*lod*/: popadr(ad); sp = sp-q; movstr(sp, ad, q); break;
+        case 1 /*sto*/: ad = getadr(sp+q); movstr(ad, sp, q);
+                        sp = sp+q+ADRSIZE; break;
+        case 2 /*uni*/: case 3 /*int*/: case 4 /*dif*/:
+                        lschk(sp, q); lschk(sp+q, q);
+                        lsop(sp+q, sp, q, p-2); sp = sp+q; break;
+        case 5 /*equ*/: case 6 /*neq*/:
+                        lschk(sp, q); lschk(sp+q, q);
+                        b = fnddif(sp+q, sp, q) == q; sp = sp+q*2;
+                        pshint(p == 5 ? b : !b); break;
+        case 7 /*leq*/: case 8 /*geq*/:
+                        lschk(sp, q); lschk(sp+q, q);
+                        if (p == 7) b = lsinc(sp+q, sp, q);
+                        else b = lsinc(sp, sp+q, q);
+                        sp = sp+q*2; pshint(b); break;
+        case 9 /*sgs*/: popint(i1);
+                        if (i1 < 0 || i1 >= q*8) errore(SETELEMENTOUTOFRANGE);
+                        sp = sp-q; lsclr(sp, q); store[sp+i1/8] |= 1<<i1%8;
+                        break;
+        case 10 /*rgs*/: popint(i2); popint(i1);
+                        if (i1 <= i2 && (i1 < 0 || i2 >= q*8))
+                          errore(SETELEMENTOUTOFRANGE);
+                        sp = sp-q; lsclr(sp, q);
+                        if (i1 <= i2) lsrng(sp, i1, i2);
+                        break;
+        case 11 /*inn*/: lschk(sp, q); i1 = getint(sp+q);
+                        b = i1 >= 0 && i1 < q*8 && !!(store[sp+i1/8] & 1<<i1%8);
+                        sp = sp+q+INTSIZE; pshint(b); break;
+        case 12 /*sfl*/: /* full set under i1 bytes to large */
+                        popint(i1); getset(sp+i1, s1); ad = sp;
+                        sp = sp-(q-SETSIZE); movstr(sp, ad, i1);
+                        lsclr(sp+i1, q); memcpy(&store[sp+i1], s1, SETSIZE);
+                        break;
+        case 13 /*slf*/: /* large set to full */
+                        lschk(sp, q);
+                        if (lsany(sp+SETSIZE, q-SETSIZE))
+                          errore(SETELEMENTOUTOFRANGE);
+                        getset(sp, s1); sp = sp+q-SETSIZE; putset(sp, s1);
+                        break;
+        case 14 /*rsz*/: /* large set of i2 bytes under i1 bytes to q bytes */
+                        popint(i1); popint(i2);
+                        if (q < i2) {
+                          lschk(sp+i1, i2);
+                          if (lsany(sp+i1+q, i2-q))
+                            errore(SETELEMENTOUTOFRANGE);
+                          movstr(sp+i1+(i2-q), sp+i1, q);
+                          movstr(sp+(i2-q), sp, i1); sp = sp+(i2-q);
+                        } else {
+                          ad = sp; sp = sp-(q-i2); movstr(sp, ad, i1);
+                          movstr(sp+i1, ad+i1, i2); lsclr(sp+i1+i2, q-i2);
+                        }
+                        break;
+        case 15 /*ina*/: popadr(ad); popint(i1);
+                        b = FALSE;
+                        if (i1 >= 0 && i1 < q*8) {
+                          chkdef(ad+i1/8); b = !!(store[ad+i1/8] & 1<<i1%8);
+                        }
+                        pshint(b); break;
+        /* sparse sets, the large set operations 16 on */
+        case 16 /*lod*/: popadr(ad); sp = sp-q; spmov(sp, ad); break;
+        case 17 /*sto*/: ad = getadr(sp+q); spmov(ad, sp);
+                        sp = sp+q+ADRSIZE; break;
+        case 18 /*uni*/: case 19 /*int*/: case 20 /*dif*/:
+                        spop(sp-q, sp+q, sp, q, p-18); spmov(sp+q, sp-q);
+                        sp = sp+q; break;
+        case 21 /*equ*/: case 22 /*neq*/:
+                        b = getint(sp) == getint(sp+q) && spinc(sp+q, sp);
+                        sp = sp+q*2; pshint(p == 21 ? b : !b); break;
+        case 23 /*leq*/: case 24 /*geq*/:
+                        if (p == 23) b = spinc(sp+q, sp);
+                        else b = spinc(sp, sp+q);
+                        sp = sp+q*2; pshint(b); break;
+        case 25 /*sgs*/: popint(i1);
+                        if (i1 < 0) errore(SETELEMENTOUTOFRANGE);
+                        sp = sp-q; putint(sp, 1); putint(sp+INTSIZE, i1);
+                        break;
+        case 26 /*rgs*/: popint(i2); popint(i1);
+                        sp = sp-q; i3 = 0;
+                        if (i1 <= i2) {
+                          if (i1 < 0) errore(SETELEMENTOUTOFRANGE);
+                          for (i = i1; i <= i2; i++) spadd(sp, q, &i3, i);
+                        }
+                        putint(sp, i3);
+                        break;
+        case 27 /*inn*/: b = spfnd(sp, getint(sp+q));
+                        sp = sp+q+INTSIZE; pshint(b); break;
+        case 28 /*dsp*/: /* large set of i2 bytes under i1 bytes to sparse */
+                        popint(i1); popint(i2); lschk(sp+i1, i2);
+                        ad = sp; sp = sp-(q-i2); spfrm(sp-q, ad+i1, i2, q);
+                        movstr(sp, ad, i1); spmov(sp+i1, sp-q);
+                        break;
+        case 29 /*spd*/: /* sparse set of i2 bytes under i1 bytes to large */
+                        popint(i1); popint(i2); spto(sp-q, sp+i1, q);
+                        ad = sp; sp = sp+(i2-q); movstr(sp, ad, i1);
+                        movstr(sp+i1, ad-q, q);
+                        break;
+        case 31 /*ina*/: popadr(ad); popint(i1); pshint(spfnd(ad, i1));
+                        break;
+      }
+      break;
+
+    case 255 /*bfd*/: getp(); getq(); /* p = operation, q = bits in field */
+      switch (p) {
+        case 0 /*lod*/: popint(i1); popadr(ad); pshint(bfdget(ad, i1, q));
+                        break;
+        case 1 /*sto*/: popint(i2); popint(i1); popadr(ad);
+                        bfdput(ad, i1, q, i2); break;
+        case 2 /*pck*/: /* i1 elements from unpacked of i2 bytes at a1+a2 */
+                        popint(i2); popint(i1); popadr(a3); popadr(a2);
+                        popadr(a1);
+                        if (a2+i1 > i2) errore(PACKELEMENTSOUTOFBOUNDS);
+                        for (i4 = 0; i4 < i1; i4++)
+                          bfdput(a3, i4, q, getbyt(a1+a2+i4));
+                        break;
+        case 3 /*upk*/: /* i1 elements to unpacked of i2 bytes at a2+a3 */
+                        popint(i2); popint(i1); popadr(a3); popadr(a2);
+                        popadr(a1);
+                        if (a3+i1 > i2) errore(UNPACKELEMENTSOUTOFBOUNDS);
+                        for (i4 = 0; i4 < i1; i4++)
+                          putbyt(a2+a3+i4, bfdget(a1, i4, q));
+                        break;
+      }
+      break;
+
     /* illegal instructions */
-    /* 228, 229, 230, 231, 232, 233, 234, 239, 240, 241, 242, 243, 244, 245, 246,
-       247, 248, 249, 250, 251, 252, 253, 254, 255 */
+    /* 228, 229, 230, 231, 232, 233, 234 */
     default: errorv(INVALIDINSTRUCTION); break;
 
   }
@@ -3006,6 +3880,10 @@ void main (long argc, char *argv[])
 
     varlst = NULL; /* set no VAR block entries */
     varfre = NULL;
+    vartre = NULL;
+    varseq = 0; varsed = 1;
+    lintab = NULL; /* set no source line table */
+    lincnt = 0; linmax = 0;
 
     argc--; argv++; /* discard the program parameter */
 
@@ -3071,6 +3949,7 @@ void main (long argc, char *argv[])
 #endif
     if (store[0] == 0) /* there is already a program in store */
         load(fp); /* assembles and stores code */
+    if (DOVERIFY) verify(); /* check code before running it */
 
     /* set status of standard files */
     filstate[INPUTFN] = fsread;
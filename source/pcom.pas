@@ -118,7 +118,7 @@
 #define ISO7185_PASCAL
 #endif
 
-program pcom(output,prd,prr);
+program pcom(output,prd,prr,prb);
 
 label 99; { terminate immediately }
 
@@ -187,16 +187,25 @@ const
    recal      = stackal;
    maxaddr    =  pmmaxint;
    maxsp      = 85;   { number of standard procedures/functions }
-   maxins     = 118;  { maximum number of instructions }
+   maxins     = 132;  { maximum number of instructions }
    maxids     = 250;  { maximum characters in id string (basically, a full line) }
    maxstd     = 81;   { number of standard identifiers }
    maxres     = 66;   { number of reserved words }
    reslen     = 9;    { maximum length of reserved words }
+   reshsh     = 126;  { top of reserved word hash table }
+   nmhsh      = 4092; { top of identifier name hash table }
+   idhsh      = 8190; { top of identifier hash table }
    explen     = 32;   { length of exception names }
    maxrld     = 22;   { maximum length of real in digit form }
    varsqt     = 10;   { variable string quanta }
+   maxtln     = 1000; { size of source line buffer, longer lines are read in 
+                        pieces }
    prtlln     = 10;   { number of label characters to print in dumps }
    minocc     = 50;   { minimum occupancy for case tables }
+   inldef     = 12;   { default size of largest routine inlined }
+   maxpkl     = 10;   { number of labels held back from output }
+   binmag     = 5256770; { first word of binary instructions, 'P6B' }
+   binver     = 1;    { version of binary instructions }
    varmax     = 1000; { maximum number of logical variants to track }
    cstoccmax=4000; cixmax=10000;
    fillen     = maxids;
@@ -293,7 +302,10 @@ type                                                        (*describing:*)
                                   declared: (fconst: ctp); standard: ());
                      subrange: (rangetype: stp; min,max: valu);
                      pointer:  (eltype: stp);
-                     power:    (elset: stp; matchpack: boolean);
+                     power:    (elset: stp; matchpack: boolean;
+                                { constructor built as the largest set for
+                                  want of the set it is used with }
+                                widset: boolean);
                      arrays:   (aeltype,inxtype: stp; tmpl: integer);
                      arrayc:   (abstype: stp);
                      records:  (fstfld: ctp; recvar: stp; recyc: stp);
@@ -326,15 +338,44 @@ type                                                        (*describing:*)
      rlstr = packed array [1..maxrld] of char;
      keyrng = 1..32; { range of standard call keys }
      filnam = packed array [1..fillen] of char; { filename strings }
+     { source line buffer. The line is lin[1..len], pos is the next character 
+       and pos > len is end of line. valid is false at end of file, or at the
+       private section of an included source, and part is true if the line
+       continues in the next piece. }
+     srcbufp = ^srcbuf;
+     srcbuf = record lin: linbuf; len, pos: integer; valid, part: boolean end;
+     { compile phases, for statistics }
+     phase = (phlex, phdcl, phstm, phgen, phmod, photh);
      filptr = ^filrec;
      filrec = record next: filptr; fn: filnam; mn: strvsp; f: text;
-                     priv: boolean end;
+                     priv: boolean; sb: srcbufp end;
      partyp = (ptval, ptvar, ptview, ptout);
      { procedure function attribute }
      fpattr = (fpanone,fpaoverload,fpastatic,fpavirtual,fpaoverride);
+     { interned identifier name }
+     nmp = ^nmrec;
+     nmrec = record
+               next: nmp; name: strvsp;
+               hsh: integer; { hash of name }
+               nid: integer { number of name }
+             end;
+     { instruction kept for inlining a procedure or function }
+     inlp = ^inlrec;
+     inlrec = record
+                next: inlp;
+                kind: 0..4; { generated by: 0 gen0, 1 gen0t, 2 gen1t, 3 gen2, 
+                              4 gen2t }
+                op: integer; p1, p2: integer; sp: stp
+              end;
      identifier = record
                    snm: integer; { serial number }
                    name: strvsp; llink, rlink: ctp;
+                   tpri: integer; { priority in name tree }
+                   tseq: integer; { order entered in name tree }
+                   hnid: integer; { number of interned name }
+                   hown: integer; { serial of the root of the name tree, 
+                                    0 if not entered }
+                   hlink: ctp; { next in hash chain }
                    idtype: stp; next: ctp; keep: boolean; 
                    refer: boolean; cbb: cbbufp;
                    case klass: idclass of
@@ -358,7 +399,14 @@ type                                                        (*describing:*)
                               standard: (key: keyrng);
                               declared: (pflev: levrange; pfname: integer;
                                           case pfkind: idkind of
-                                           actual: (forwdecl, externl: boolean);
+                                           actual: (forwdecl, externl: boolean;
+                                                    { code to inline, and
+                                                      lowest frame offset }
+                                                    pfinl: inlp;
+                                                    pfilc: stkoff;
+                                                    { frame never uses its
+                                                      static link }
+                                                    pflight: boolean);
                                            formal: ()));
                      alias: (actid: ctp; { actual id })
                    end;
@@ -381,7 +429,7 @@ type                                                        (*describing:*)
                         case access: vaccess of
                           drct: (vlevel: levrange; dplmt: addrrange);
                           indrct: (idplmt: addrrange);
-           inxd: ());
+           inxd: (bwid: integer)); { bit element, address and index on stack }
            expr: ()
               end;
 
@@ -406,6 +454,8 @@ type                                                        (*describing:*)
      disprec = record                      (*=blck:   id is variable id*)
                  fname: ctp; flabel: lbp;  (*=crec:   id is field id in record with*)
                  fconst: csp; fstruct: stp;
+                 labend: lbp; nlab: integer; { last of label list, and count }
+                 cstend: csp; ncst: integer; { last of constant list, and count }
                  packing: boolean;         { used for with derived from packed }
                  packcom: boolean;         { used for with derived from packed }
                  ptrref: boolean;          { used for with derived from pointer }
@@ -440,6 +490,7 @@ type                                                        (*describing:*)
      cmdinx = 1..maxcmd; { index for command line buffer }
      cmdnum = 0..maxcmd; { length of command line buffer }
      cmdbuf = packed array [cmdinx] of char; { buffer for command line }
+     linbuf = packed array [1..maxtln] of char; { buffer for a text line }
       
 (*-------------------------------------------------------------------------*)
 
@@ -449,6 +500,7 @@ var
 #ifndef SELF_COMPILE
     prd,prr: text;                  { output code file }
 #endif
+    prb: file of integer;           { binary instructions, option c2 }
 
                                     (*returned by source program scanner
                                      insymbol:
@@ -483,7 +535,9 @@ var
 
     dp: boolean;                    (*declaration part*)
     list: boolean;                  { -- l: source program listing }
-    prcode: boolean;                { -- c: print symbolic code }
+    prcode: boolean;                { -- c: print symbolic code, c2 writes
+                                         instructions to prb in binary }
+    dobin: boolean;                 { binary instructions }
     prtables: boolean;              { -- t: displaying ident and struct tables }
     chkvar: boolean;                { -- v: check variant records }
     debug: boolean;                 { -- d: Debug checks }
@@ -492,10 +546,22 @@ var
                                          and final }
     iso7185: boolean;               { -- s: restrict to iso7185 language }
     dodmplex: boolean;              { -- x: dump lexical }
-    doprtryc: boolean;              { -- z: dump recycling tracker counts }
+    doprtryc: boolean;              { -- z: dump recycling tracker counts, z2
+                                         adds compile statistics }
     doprtlab: boolean;              { -- b: print labels }
     dodmpdsp: boolean;              { -- y: dump the display }
     chkvbk: boolean;                { -- i: check VAR block violations } 
+    dopeep: boolean;                { -- k: peephole optimize code }
+    doglob: boolean;                { fold constants and unreachable code }
+    doinl: boolean;                 { inline small routines }
+
+    { j and k are used only here, and are not passed to pint. k<n> sets the
+      optimization level: 0 (or k-) none, 1 (or k+) peephole and jump 
+      threading, 2 also folds constants, skips unreachable code and makes self
+      tail calls, 3 also inlines small routines. j<n> sets the size of the
+      largest routine inlined, in instructions, and j0 (or j-) turns inlining
+      off. Inlining is also off where q is on, since the frame of an inlined
+      routine is not set undefined again for each call }
     
     { switches passed through to pint }
 
@@ -504,8 +570,6 @@ var
     { -- f: perform source level debugging }
     { -- m: break heap returned blocks as occupied }
     { -- h: add source line sets to code }
-    { -- j: trace source line executions (requires dosrclin) }
-    { -- k: dump heap space after execution }
     { -- n: obey heap space recycle requests }
     { -- p: check reuse of freed entry } 
     { -- q: check undefined accesses }   
@@ -516,7 +580,7 @@ var
 
                                     (*pointers:*)
                                     (***********)
-    parmptr,
+    parmptr,setptr,
     intptr,crdptr,realptr,charptr,
     boolptr,nilptr,textptr,
     exceptptr,stringptr,pstringptr,
@@ -570,6 +634,8 @@ var
     chartp : array[char] of chtp;
     rw:  array [1..maxres(*nr. of res. words*)] of restr;
     rsy: array [1..maxres(*nr. of res. words*)] of symbol;
+    rwh: array [0..reshsh] of 0..maxres; { reserved word hash chain heads }
+    rwn: array [1..maxres] of 0..maxres; { next reserved word in chain }
     ssy: array [char] of symbol;
     rop: array [1..maxres(*nr. of res. words*)] of operatort;
     sop: array [char] of operatort;
@@ -586,6 +652,32 @@ var
     errtbl: array [1..maxftl] of boolean; { error occurence tracking }
     toterr: integer; { total errors in program }
     topnew, topmin: integer;
+    { peephole window, an instruction held back from output }
+    pkop: integer; { held instruction, or -1 if none }
+    pkp1, pkp2: integer; { operands of that }
+    pksp: stp; { type of that }
+    pkcv: boolean; { a second constant is held under the ldc }
+    pkc1, pkc2: integer; { operands of that }
+    pklab: array [1..maxpkl] of integer; { labels held back, with nothing
+                                           held in the window }
+    pklcnt: 0..maxpkl; { number of those }
+    { capture of procedure and function code for inlining }
+    optlvl: integer; { level of k option }
+    prclvl: integer; { level of c option }
+    binopn: boolean; { prb has been opened }
+    bincnt: integer; { binary instructions written }
+    inlmax: integer; { largest routine inlined, in instructions }
+    inlcap: boolean; { capturing code }
+    inlok: boolean; { code captured so far can be inlined }
+    inlpnd: boolean; { instruction output but not captured }
+    inlsiz: integer; { instructions captured }
+    inlhd, inltl: inlp; { list of captured code }
+    lcinl: stkoff; { lowest lc used by inlined code in body }
+    dcllab: integer; { label ending unreachable code being skipped, or 0 }
+    dcltop: integer; { stack count at start of that }
+    lfok: boolean; { routine code so far never uses its static link }
+    setctx: addrrange; { size of set the operand being parsed is used with, 
+                         or 0 if not known }
     cstptr: array [1..cstoccmax] of csp;
     cstptrix: 0..cstoccmax;
     (*allows referencing of noninteger constants by an index
@@ -597,6 +689,24 @@ var
     incstk: filptr; { stack of included files }
     inclst: filptr; { discard list for includes }
     cbblst: cbbufp; { copyback buffer entry list }
+    prdsrc: srcbufp; { line buffer for prd }
+    insrc: srcbufp; { line buffer of the current source, prd or include }
+
+    { Free pools. Entries released when a display level is scrubbed go here 
+      instead of back to the heap, and are reused by the next allocation. }
+    strfre: strvsp; { strings }
+    cspfre: csp; { constants }
+    stpfre: stp; { structures }
+    ctpfre: ctp; { identifiers }
+    lbpfre: lbp; { labels }
+
+    { Identifier hash tables. Names are interned to numbers, and identifiers
+      are found by the number and the name tree they were entered in, which 
+      is known by the serial of its root. The root of a name tree is the 
+      first entered, and does not change. }
+    nmh: array [0..nmhsh] of nmp; { interned names by hash }
+    nmcnt: integer; { number of names interned }
+    idh: array [0..idhsh] of ctp; { identifiers by name and tree }
 
     { Recycling tracking counters, used to check for new/dispose mismatches. }
     strcnt: integer; { strings }
@@ -606,10 +716,23 @@ var
     lbpcnt: integer; { label counts }
     filcnt: integer; { file tracking counts }
     cipcnt: integer; { case entry tracking counts }
+    ilrcnt: integer; { inline code entries }
     
+    { compile statistics, printed with option z2 }
+    prtlvl: integer; { level of z option }
+    phcur: phase; { phase the time is going to }
+    phclk: integer; { clock at the last phase change }
+    phtim: array [phase] of integer; { time spent in each phase }
+    phmdl: integer; { depth of module loads }
+    bgnclk: integer; { clock at compile start }
+    inscnt: integer; { instructions output }
+    hpcnt: integer; { table entries taken from the heap }
+    thrcnt: integer; { labels moved to the target of a jump or to a return }
+
     { serial numbers to label structure and identifier entries for dumps }
     ctpsnm: integer;
     stpsnm: integer;
+    entcnt: integer; { ids entered in name trees, to order them by entry }
 
     f: boolean; { flag for if error number list entries were printed }
     i: 1..maxftl; { index for error number tracking array }
@@ -624,7 +747,8 @@ var
   { get string quanta }
   procedure getstr(var p: strvsp);
   begin
-     new(p); { get new entry }
+     if strfre <> nil then begin p := strfre; strfre := p^.next end
+     else begin new(p); hpcnt := hpcnt+1 end; { get new entry }
      strcnt := strcnt+1 { count }
   end;
 
@@ -632,46 +756,72 @@ var
   procedure putstrs(p: strvsp);
   var p1: strvsp;
   begin
-    while p <> nil do begin
-      p1 := p; p := p^.next; dispose(p1); strcnt := strcnt-1
+    if p <> nil then begin
+      { find the end, then join the whole list to the pool }
+      p1 := p; strcnt := strcnt-1;
+      while p1^.next <> nil do begin p1 := p1^.next; strcnt := strcnt-1 end;
+      p1^.next := strfre; strfre := p
     end
   end;
 
-  { get label entry }
+  { get label entry. Label lists join the pool whole, so any id label of a
+    pooled entry is released here }
   procedure getlab(var p: lbp);
   begin
-     new(p); { get new entry }
+     if lbpfre <> nil then 
+       begin p := lbpfre; lbpfre := p^.nextlab; putstrs(p^.labid) end
+     else begin new(p); hpcnt := hpcnt+1 end; { get new entry }
+     p^.labid := nil;
      lbpcnt := lbpcnt+1 { add to count }
   end;
 
-  { recycle label entry }
-  procedure putlab(p: lbp);
+  { get constant entry. Pooled entries are allocated without a variant, so
+    they can be reused for any class. Constant lists join the pool whole, so
+    any string of a pooled entry is released here }
+  procedure getcst(var p: csp);
   begin
-     putstrs(p^.labid); { release any id label } 
-     dispose(p); { release entry }
-     lbpcnt := lbpcnt-1 { remove from count }
+     if cspfre <> nil then begin p := cspfre; cspfre := p^.next;
+       if p^.cclass = strg then putstrs(p^.sval)
+     end else begin new(p); hpcnt := hpcnt+1 end; { get new entry }
+     p^.cclass := reel
   end;
 
   { push constant entry to list }
   procedure pshcst(p: csp);
   begin
      { push to constant list }
-     p^.next := display[top].fconst;
-     display[top].fconst := p;
+     with display[top] do begin
+       if fconst = nil then cstend := p;
+       p^.next := fconst; fconst := p; ncst := ncst+1
+     end;
      cspcnt := cspcnt+1 { count entries }
   end;
 
+  { remove constant entry from list }
+  procedure popcst(p: csp);
+  var lp: csp;
+  begin
+     with display[top] do begin
+       if fconst = p then begin
+         fconst := p^.next; if fconst = nil then cstend := nil
+       end else begin
+         lp := fconst;
+         while lp <> nil do
+           if lp^.next = p then begin 
+             lp^.next := p^.next; if cstend = p then cstend := lp; lp := nil 
+           end else lp := lp^.next
+       end;
+       ncst := ncst-1
+     end
+  end;
+
   { recycle constant entry }
   procedure putcst(p: csp);
   begin
      { recycle string if present }
      if p^.cclass = strg then putstrs(p^.sval);
-     { release entry }
-     case p^.cclass of
-       reel: dispose(p, reel);
-       pset: dispose(p, pset);
-       strg: dispose(p, strg)
-     end;
+     p^.cclass := reel;
+     p^.next := cspfre; cspfre := p; { release entry }
      cspcnt := cspcnt-1 { remove from count }
   end;
 
@@ -686,27 +836,28 @@ var
      p^.snm := stpsnm
   end;
 
+  { get structure entry, allocated without a variant like constants }
+  procedure getstc(var p: stp);
+  begin
+     if stpfre <> nil then begin p := stpfre; stpfre := p^.next end
+     else begin new(p); hpcnt := hpcnt+1 end { get new entry }
+  end;
+
   { recycle structure entry }
   procedure putstc(p: stp);
   begin
-     { release entry }
-     case p^.form of
-       scalar:   if p^.scalkind = declared then dispose(p, scalar, declared)
-                                           else dispose(p, scalar, standard);
-       subrange: dispose(p, subrange);
-       pointer:  dispose(p, pointer);
-       power:    dispose(p, power);
-       arrays:   dispose(p, arrays);
-       arrayc:   dispose(p, arrayc);
-       records:  dispose(p, records);
-       files:    dispose(p, files);
-       tagfld:   begin dispose(p^.vart); dispose(p, tagfld) end;
-       variant:  dispose(p, variant);
-       exceptf:  dispose(p, exceptf)
-     end;
+     if p^.form = tagfld then dispose(p^.vart);
+     p^.next := stpfre; stpfre := p; { release entry }
      stpcnt := stpcnt-1
   end;
 
+  { get identifier entry, allocated without a variant like constants }
+  procedure getnam(var p: ctp);
+  begin
+     if ctpfre <> nil then begin p := ctpfre; ctpfre := p^.next end
+     else begin new(p); hpcnt := hpcnt+1 end { get new entry }
+  end;
+
   { initialize and register identifier entry }
   procedure ininam(p: ctp);
   begin
@@ -714,12 +865,30 @@ var
      { clear fixed entries }
      p^.idtype := nil; p^.keep := false; p^.refer := false;
      p^.name := nil; p^.llink := nil; p^.rlink := nil; p^.next := nil; 
-     p^.cbb := nil;
+     p^.cbb := nil; p^.hown := 0; p^.hlink := nil;
      ctpsnm := ctpsnm+1; { identify entry in dumps }
      p^.snm := ctpsnm
   end;
 
   procedure putnam(p: ctp); forward;
+  procedure flushpk; forward;
+
+  { find the identifier hash chain for an interned name in a name tree }
+  function idhix(own, n: integer): integer;
+  begin idhix := ((own mod (idhsh+1))*31+n) mod (idhsh+1) end;
+
+  { remove identifier from its hash chain }
+  procedure idhunl(p: ctp);
+  var x: integer; lcp: ctp;
+  begin x := idhix(p^.hown, p^.hnid);
+    if idh[x] = p then idh[x] := p^.hlink
+    else begin lcp := idh[x];
+      while lcp <> nil do
+        if lcp^.hlink = p then begin lcp^.hlink := p^.hlink; lcp := nil end
+        else lcp := lcp^.hlink
+    end;
+    p^.hown := 0; p^.hlink := nil
+  end;
 
   { recycle parameter list }
   procedure putparlst(p: ctp);
@@ -737,6 +906,9 @@ var
   begin
      if (p^.klass = proc) or (p^.klass = func) then begin
         putparlst(p^.pflist); p^.pflist := nil;
+        if p^.pfdeckind = declared then 
+          if p^.pfkind = actual then 
+            begin putinl(p^.pfinl); p^.pfinl := nil end;
         while p^.grpnxt <> nil do begin
           { scavenge the group list }
           p1 := p^.grpnxt; p^.grpnxt := p1^.grpnxt;
@@ -744,23 +916,8 @@ var
         end
      end;
      if p^.klass <> alias then putstrs(p^.name); { release name string }
-     { release entry according to class }  
-     case p^.klass of
-       types: dispose(p, types);
-       konst: dispose(p, konst);
-       vars:  dispose(p, vars);
-       fixed: dispose(p, fixed);
-       field: dispose(p, field);
-       proc: if p^.pfdeckind = standard then dispose(p, proc, standard)
-                                        else if p^.pfkind = actual then 
-                                            dispose(p, proc, declared, actual)
-                                          else dispose(p, proc, declared, formal);
-       func: if p^.pfdeckind = standard then dispose(p, func, standard)
-                                        else if p^.pfkind = actual then 
-                                            dispose(p, func, declared, actual)
-                                          else dispose(p, func, declared, formal);
-       alias: dispose(p, alias)
-     end;
+     if p^.hown <> 0 then idhunl(p); { remove from hash chain }
+     p^.next := ctpfre; ctpfre := p; { release entry }
      ctpcnt := ctpcnt-1 { remove from count }
   end;
   
@@ -782,8 +939,8 @@ var
   begin
     with dr do begin
       fname := nil;
-      flabel := nil;
-      fconst := nil;
+      flabel := nil; labend := nil; nlab := 0;
+      fconst := nil; cstend := nil; ncst := 0;
       fstruct := nil;
       packing := false;
       packcom := false;
@@ -797,7 +954,7 @@ var
   
   { scrub display level }
   procedure putdsp(var dr: disprec);
-     var llp: lbp; lvp: csp; lsp: stp; oi: operatort;
+     var lsp: stp; oi: operatort;
      { release substructure }
      procedure putsub(p: stp);
         var p1: stp;
@@ -820,13 +977,15 @@ var
      end;
   begin { putdsp }
     putnams(dr.fname); { dispose of identifier tree }
-    { dispose of label list }
-    while dr.flabel <> nil do begin
-      llp := dr.flabel; dr.flabel := llp^.nextlab; putlab(llp)
+    { the label and constant lists belong only to the level, and join the 
+      pools whole. Their strings are released as the entries are reused }
+    if dr.flabel <> nil then begin
+      dr.labend^.nextlab := lbpfre; lbpfre := dr.flabel; 
+      lbpcnt := lbpcnt-dr.nlab; dr.flabel := nil; dr.labend := nil; dr.nlab := 0
     end;
-    { dispose of constant list }
-    while dr.fconst <> nil do begin
-      lvp := dr.fconst; dr.fconst := lvp^.next; putcst(lvp)
+    if dr.fconst <> nil then begin
+      dr.cstend^.next := cspfre; cspfre := dr.fconst; 
+      cspcnt := cspcnt-dr.ncst; dr.fconst := nil; dr.cstend := nil; dr.ncst := 0
     end;
     { dispose of structure list }
     while dr.fstruct <> nil do begin
@@ -860,6 +1019,21 @@ var
     if ptop > 0 then for t := ptop-1 downto 0 do putdsp(pile[t])
   end;
 
+  { return the free pools to the heap }
+  procedure putfre;
+  var sp: strvsp; vp: csp; tp: stp; cp: ctp; lp: lbp;
+  begin
+    while cspfre <> nil do begin vp := cspfre; cspfre := vp^.next;
+      if vp^.cclass = strg then putstrs(vp^.sval); dispose(vp) end;
+    while stpfre <> nil do begin tp := stpfre; stpfre := tp^.next; dispose(tp) end;
+    while ctpfre <> nil do begin cp := ctpfre; ctpfre := cp^.next; dispose(cp) end;
+    while lbpfre <> nil do 
+      begin lp := lbpfre; lbpfre := lp^.nextlab; putstrs(lp^.labid); 
+            dispose(lp) end;
+    { last, since the entries above can hold strings }
+    while strfre <> nil do begin sp := strfre; strfre := sp^.next; dispose(sp) end
+  end;
+
   { get external file entry }
   procedure getfil(var p: extfilep);
   begin
@@ -887,6 +1061,24 @@ var
      dispose(p); { release entry }
      cipcnt := cipcnt-1 { count entry }
   end;
+
+  { get inline code entry }
+  procedure getinl(var p: inlp);
+  begin
+     new(p); { get new entry }
+     ilrcnt := ilrcnt+1 { count entry }
+  end;
+
+  { recycle inline code list }
+  procedure putinl(p: inlp);
+  var p1: inlp;
+  begin
+     while p <> nil do begin
+       p1 := p; p := p^.next;
+       dispose(p1); { release entry }
+       ilrcnt := ilrcnt-1 { count entry }
+     end
+  end;
   
   { get copyback buffer }
   procedure getcbb(var p: cbbufp; id: ctp);
@@ -938,6 +1130,23 @@ var
     strequri := m
   end { equstr };
 
+  { find reserved word string equal to id string, where the id string is known
+    to be blank past reslen }
+  function strequrs(var a: restr; var b: idstr): boolean;
+  var m: boolean; i: integer;
+  begin
+    m := true; i := 1;
+    while m and (i <= reslen) do
+      if lcase(a[i]) <> lcase(b[i]) then m := false else i := i+1;
+    strequrs := m
+  end { strequrs };
+
+  { find reserved word hash from first and last characters and length }
+  function reshash(f, l: char; n: integer): integer;
+  begin
+    reshash := (16*ord(lcase(f))+22*ord(lcase(l))+n) mod (reshsh+1)
+  end { reshash };
+
   { write variable length id string to file }
   procedure writev(var f: text; s: strvsp; fl: integer);
   var i: integer; c: char;
@@ -1049,34 +1258,20 @@ var
      end
   end;
 
-  { compare variable length id strings }
-  function strequvv(a, b: strvsp): boolean;
-  var m: boolean; i: integer;
-  begin
-    m := true;
-    while (a <> nil) and (b <> nil) do begin
-      for i := 1 to varsqt do if lcase(a^.str[i]) <> lcase(b^.str[i]) then m := false;
-      a := a^.next; b := b^.next
-    end;
-    if a <> b then m := false;
-    strequvv := m
-  end;
-
-  { compare variable length id strings, a < b }
-  function strltnvv(a, b: strvsp): boolean;
-  var i: integer; ca, cb: char;
-  begin ca := ' '; cb := ' ';
-    while (a <> nil) or (b <> nil) do begin
-      i := 1;
-      while (i <= varsqt) and ((a <> nil) or (b <> nil)) do begin
+  { compare variable length id strings, giving -1 for a < b, 0 for a = b and
+    1 for a > b }
+  function strcmpvv(a, b: strvsp): integer;
+  var r, i: integer; ca, cb: char;
+  begin r := 0;
+    while ((a <> nil) or (b <> nil)) and (r = 0) do begin
+      for i := 1 to varsqt do if r = 0 then begin
         if a <> nil then ca := lcase(a^.str[i]) else ca := ' ';
         if b <> nil then cb := lcase(b^.str[i]) else cb := ' ';
-        if ca <> cb then begin a := nil; b := nil end;
-        i := i+1
+        if ca < cb then r := -1 else if ca > cb then r := 1
       end;
       if a <> nil then a := a^.next; if b <> nil then b := b^.next
     end;
-    strltnvv := ca < cb
+    strcmpvv := r
   end;
 
   { compare variable length id string to fixed }
@@ -1092,17 +1287,68 @@ var
     strequvf := m
   end;
 
-  { compare variable length id string to fixed, a < b }
-  function strltnvf(a: strvsp; var b: idstr): boolean;
-  var m: boolean; i, j, f: integer; c: char;
+  { compare variable length id string to fixed, giving -1 for a < b, 0 for
+    a = b and 1 for a > b }
+  function strcmpvf(a: strvsp; var b: idstr): integer;
+  var r, i, j: integer; c: char;
   begin
-    m := true; i := 1; j := 1;
-    while i < maxids do begin
-      c := ' '; if a <> nil then begin c := a^.str[j]; j := j+1 end;
-      if lcase(c) <> lcase(b[i]) then begin f := i; i := maxids end else i := i+1;
-      if j > varsqt then begin a := a^.next; j := 1 end
+    r := 0; i := 1; j := 1;
+    while (r = 0) and (i <= maxids) do begin
+      c := ' '; if a <> nil then begin c := lcase(a^.str[j]); j := j+1 end;
+      if c < lcase(b[i]) then r := -1 else if c > lcase(b[i]) then r := 1;
+      if j > varsqt then begin a := a^.next; j := 1 end;
+      i := i+1
+    end;
+    strcmpvf := r
+  end;
+
+  { find hash of variable length id string, without regard to case }
+  function strhshv(a: strvsp): integer;
+  var h, i: integer;
+  begin h := 0;
+    while a <> nil do begin
+      for i := 1 to varsqt do h := (h*31+ord(lcase(a^.str[i]))) mod 65521;
+      a := a^.next
     end;
-    strltnvf := lcase(c) < lcase(b[f])
+    strhshv := h
+  end;
+
+  { find hash of fixed id string, without regard to case }
+  function strhshf(var a: idstr): integer;
+  var h, i: integer;
+  begin h := 0; i := 1;
+    while i <= maxids do
+      if a[i] = ' ' then i := maxids+1
+      else begin h := (h*31+ord(lcase(a[i]))) mod 65521; i := i+1 end;
+    strhshf := h
+  end;
+
+  { find the number of an interned id string. A string not yet interned is
+    entered if ent is set, otherwise 0 is given for it }
+  function intern(var a: idstr; ent: boolean): integer;
+  var h, n: integer; p: nmp;
+  begin h := strhshf(a); p := nmh[h mod (nmhsh+1)]; n := 0;
+    while p <> nil do begin
+      if p^.hsh = h then 
+        if strcmpvf(p^.name, a) = 0 then begin n := p^.nid; p := nil end;
+      if p <> nil then p := p^.next
+    end;
+    if (n = 0) and ent then begin
+      new(p); nmcnt := nmcnt+1; n := nmcnt;
+      strassvf(p^.name, a); p^.hsh := h; p^.nid := n;
+      p^.next := nmh[h mod (nmhsh+1)]; nmh[h mod (nmhsh+1)] := p
+    end;
+    intern := n
+  end;
+
+  { release interned names }
+  procedure putnms;
+  var i: integer; p: nmp;
+  begin
+    for i := 0 to nmhsh do
+      while nmh[i] <> nil do begin
+        p := nmh[i]; nmh[i] := p^.next; putstrs(p^.name); dispose(p)
+      end
   end;
 
   { get character from variable length string }
@@ -1229,6 +1475,9 @@ begin
   errore(v)
 end;
 
+{ pcom reads its source a line at a time with readlntext }
+#define READLNTEXT
+
 #ifdef GNU_PASCAL
 #include "extend_gnu_pascal.inc"
 #endif
@@ -1241,6 +1490,55 @@ end;
 #include "extend_pascaline.inc"
 #endif
 
+{ switch the phase compile time is charged to, and return the last one. 
+  Loading a module is charged as a whole to that }
+procedure phsw(ph: phase; var old: phase);
+var t: integer;
+begin
+  old := phcur;
+  if phmdl = 0 then begin
+    if doprtryc and (prtlvl > 1) then begin
+      t := clocktime;
+      if t > phclk then phtim[phcur] := phtim[phcur]+(t-phclk);
+      phclk := t
+    end;
+    phcur := ph
+  end
+end;
+
+{ print compile statistics. Each line is "stat", a name and a value, so they 
+  can be picked out of the compiler output by tools. Times are in 
+  milliseconds, and read zero if there is no clock. Heap entries are the 
+  table entries allocated, which is also the peak held, since released entries
+  are kept for reuse }
+procedure prtstat;
+var t, tt: integer; ph: phase;
+begin
+  phsw(photh, ph); t := clocktime; tt := 0;
+  if t > bgnclk then tt := t-bgnclk;
+  writeln;
+  writeln('Compile statistics:');
+  writeln;
+  writeln('stat lines ', linecount:1);
+  writeln('stat time_total ', tt:1);
+  writeln('stat time_lex ', phtim[phlex]:1);
+  writeln('stat time_declare ', phtim[phdcl]:1);
+  writeln('stat time_statement ', phtim[phstm]:1);
+  writeln('stat time_generate ', phtim[phgen]:1);
+  writeln('stat time_modules ', phtim[phmod]:1);
+  writeln('stat time_other ', phtim[photh]:1);
+  writeln('stat identifiers ', ctpsnm:1);
+  writeln('stat names ', nmcnt:1);
+  writeln('stat types ', stpsnm:1);
+  writeln('stat labels ', intlabel:1);
+  writeln('stat instructions ', inscnt:1);
+  writeln('stat labels_threaded ', thrcnt:1);
+  writeln('stat heap_entries ', hpcnt:1);
+  if tt > 0 then writeln('stat lines_per_second ', linecount*1000 div tt:1)
+  else writeln('stat lines_per_second 0');
+  writeln
+end;
+
 (*-------------------------------------------------------------------------*)
 
   { dump the display }
@@ -1271,29 +1569,37 @@ end;
     writeln;
   end;
   
-  { this block of functions wraps source reads }
-  function eofinp: boolean;
+  { this block of functions wraps source reads. Each source is read a line at
+    a time into its buffer, and nextch takes characters from that }
+
+  { fill line buffer from file }
+  procedure fillinp(var f: text);
   begin
-    if incstk <> nil then begin
-      if incstk^.priv then eofinp := true else eofinp := eof(incstk^.f) 
-    end else eofinp := eof(prd)
+    with insrc^ do begin
+      len := 0; pos := 1; part := false; valid := not eof(f);
+      if valid then begin
+        readlntext(f, lin, len);
+        part := not eoln(f);
+        if not part then readln(f)
+      end
+    end
   end;
-  
-  function eolninp: boolean;
-  begin 
-    if eofinp then eolninp := true
-    else if incstk <> nil then eolninp := eoln(incstk^.f) 
-         else eolninp := eoln(prd)
+
+  { get the next line, or the next piece of the line, of the current source }
+  procedure getinp;
+  begin
+    if incstk <> nil then fillinp(incstk^.f) else fillinp(prd)
   end;
-  
-  procedure readinp(var c: char);
+
+  { an included source also ends at its private section, see declare }
+  function eofinp: boolean;
   begin
-    if incstk <> nil then read(incstk^.f, c) else read(prd, c)
+    eofinp := not insrc^.valid
   end;
   
   function bufinp: char;
   begin
-    if incstk <> nil then bufinp := incstk^.f^ else bufinp := prd^
+    with insrc^ do if pos <= len then bufinp := lin[pos] else bufinp := ' '
   end;
   { --- }
 
@@ -1645,13 +1951,19 @@ end;
         ev: integer;
         rv: real;
         sgn: integer;
+        oph: phase;
 
     procedure nextch;
     begin if eol then
       begin if list then writeln(output); endofline
       end;
-      if not eofinp then
-       begin eol := eolninp; readinp(ch);
+      if insrc^.valid then with insrc^ do
+       begin eol := pos > len;
+        if eol then begin ch := ' '; getinp end { end of line }
+        else begin
+          ch := lin[pos]; pos := pos+1;
+          if (pos > len) and part then getinp { line continues }
+        end;
         if list then write(ch);
         chcnt := chcnt + 1
        end
@@ -1664,20 +1976,50 @@ end;
     procedure options;
     var
       ch1 : char; dummy: boolean;
+      { pass option setting to pint, unless used only here }
+      procedure passopt(c: char);
+      begin
+        if not (ch1 in ['j', 'k']) then writeln(prr, 'o ', ch1, c)
+      end;
       procedure switch(var opt: boolean );
       begin
-        nextch;
+        nextch; flushpk; 
+        inlok := false; { option changes are not carried into inlined code }
         if (ch='+') or (ch='-') then begin
           opt := ch = '+';
           option[ch1] := opt;
-          writeln(prr, 'o ', ch1, ch);
+          passopt(ch);
           nextch;
         end else begin { just default to on }
           opt := true;
           option[ch1] := true;
-          writeln(prr, 'o ', ch1, '+')
+          passopt('+')
         end
       end; { switch() }
+      { switch that can take a count in place of + or -, where zero is off }
+      procedure nswitch(var opt: boolean; var n: integer);
+      begin
+        nextch; flushpk; inlok := false;
+        if ch in ['0'..'9'] then begin
+          n := 0;
+          while ch in ['0'..'9'] do begin
+            if n <= 9999 then n := n*10+ord(ch)-ord('0');
+            nextch
+          end;
+          opt := n > 0;
+          option[ch1] := opt;
+          if opt then passopt('+') else passopt('-')
+        end else if (ch='+') or (ch='-') then begin
+          opt := ch = '+';
+          option[ch1] := opt;
+          passopt(ch);
+          nextch;
+        end else begin { just default to on }
+          opt := true;
+          option[ch1] := true;
+          passopt('+')
+        end
+      end; { nswitch() }
     begin { options() }
       repeat
         nextch;
@@ -1688,16 +2030,32 @@ end;
           if not list then writeln(output)
         end
         else if ch1 = 'd' then switch(debug)
-        else if ch1 = 'c' then switch(prcode)
+        else if ch1 = 'c' then begin
+          nswitch(prcode, prclvl);
+          if not prcode then prclvl := 0
+          else if prclvl = 0 then prclvl := 1;
+          dobin := prclvl >= 2;
+          if dcllab <> 0 then prcode := false { still skipping code }
+        end
         else if ch1 = 'v' then switch(chkvar)
         else if ch1 = 'r' then switch(chkref)
         else if ch1 = 'u' then switch(chkudtc)
         else if ch1 = 's' then switch(iso7185)
         else if ch1 = 'x' then switch(dodmplex)
-        else if ch1 = 'z' then switch(doprtryc)
+        else if ch1 = 'z' then nswitch(doprtryc, prtlvl)
         else if ch1 = 'b' then switch(doprtlab)
         else if ch1 = 'y' then switch(dodmpdsp)
         else if ch1 = 'i' then switch(chkvbk)
+        else if ch1 = 'k' then begin
+          nswitch(dopeep, optlvl);
+          if not dopeep then optlvl := 0
+          else if optlvl = 0 then optlvl := 1;
+          doglob := optlvl >= 2; doinl := optlvl >= 3
+        end else if ch1 = 'j' then begin
+          nswitch(dummy, inlmax);
+          if not dummy then inlmax := 0
+          else if inlmax = 0 then inlmax := inldef
+        end
         else if ch1 in ['a'..'z'] then
           switch(dummy) { pass through unknown options }
         else begin 
@@ -1783,6 +2141,7 @@ end;
     end;
 
   begin (*insymbol*)
+    phsw(phlex, oph);
     { copy current to last scanner block }
     lsy := sy; lop := op; lval := val; llgth := lgth; lid := id; lkk := kk;
     if nvalid then begin { there is a lookahead }
@@ -1819,16 +2178,20 @@ end;
             repeat id[kk] := ' '; kk := kk - 1
             until kk = k;
           sy := ident; op := noop;
-          if k <= reslen then
-            for i := 1 to maxres do
-              if strequri(rw[i], id) then
+          if k <= reslen then begin
+            i := rwh[reshash(id[1], id[k], k)];
+            while i <> 0 do
+              if strequrs(rw[i], id) then
                 begin sy := rsy[i]; op := rop[i];
                   { if in ISO 7185 mode and keyword is extended, then revert it
                     to label. Note that forward and external get demoted to
                     "word symbols" in ISO 7185 }
                   if iso7185 and ((sy >= forwardsy) or (op >= bcmop)) then
-                    begin sy := ident; op := noop end 
-                end;
+                    begin sy := ident; op := noop end;
+                  i := 0
+                end
+              else i := rwn[i]
+          end
       end;
       chhex, choct, chbin, number:
         begin op := noop; i := 0; r := 10;
@@ -1884,7 +2247,7 @@ end;
                     end
                   end;
                 if ev < 0 then rv := rv/pwrten(ev) else rv := rv*pwrten(ev);
-                new(lvp,reel); pshcst(lvp); sy:= realconst;
+                getcst(lvp); pshcst(lvp); sy:= realconst;
                 lvp^.cclass := reel;
                 with lvp^ do lvp^.rval := rv;
                 val.intval := false;
@@ -1954,7 +2317,7 @@ end;
             { can't let zero length propagate up, we change to space }
             error(205); val.intval := true; val.ival := ord(' '); lgth := 1
           end else begin
-            new(lvp,strg); pshcst(lvp);
+            getcst(lvp); pshcst(lvp);
             lvp^.cclass:=strg;
             if lgth > strglgth then
               begin error(26); lgth := strglgth end;
@@ -2075,7 +2438,7 @@ end;
       writeln
 
     end;
-    2:;
+    2: phsw(oph, oph)
   end (*insymbol*) ;
   
   procedure pushback;
@@ -2091,74 +2454,108 @@ end;
   procedure enterid(fcp: ctp);
     (*enter id pointed at by fcp into the name-table,
      which on each declaration level is organised as
-     an unbalanced binary tree*)
-    var lcp, lcp1: ctp; lleft: boolean;
+     a binary tree, kept balanced as a treap with the
+     hash of the name as priority. The first id entered
+     stays at the root, since the root is also taken as
+     the head of parameter and field lists. Searches go
+     by the identifier hash table, which it is also
+     entered in, after any of the same name*)
+    var nm: idstr; x: integer; lcp: ctp;
+    function ins(lcp: ctp): ctp;
+      var lcp1: ctp; c: integer;
+    begin
+      if lcp = nil then ins := fcp
+      else begin
+        c := strcmpvv(lcp^.name, fcp^.name);
+        if c = 0 then begin 
+          (*name conflict, follow right link*)
+          if incstk <> nil then begin
+            writeln; write('*** Duplicate in uses/joins: '); 
+            writevp(output, fcp^.name);
+            writeln
+          end; 
+          { give appropriate error }
+          if lcp^.klass = alias then error(242) else error(101)
+        end;
+        if c > 0 then begin
+          lcp^.llink := ins(lcp^.llink); lcp1 := lcp^.llink;
+          if lcp1^.tpri > lcp^.tpri then
+            begin lcp^.llink := lcp1^.rlink; lcp1^.rlink := lcp; lcp := lcp1 end
+        end else begin
+          lcp^.rlink := ins(lcp^.rlink); lcp1 := lcp^.rlink;
+          if lcp1^.tpri > lcp^.tpri then
+            begin lcp^.rlink := lcp1^.llink; lcp1^.llink := lcp; lcp := lcp1 end
+        end;
+        ins := lcp
+      end
+    end;
   begin
-    lcp := display[top].fname;
-    if lcp = nil then
-      display[top].fname := fcp
-    else
-      begin
-        repeat lcp1 := lcp;
-          if strequvv(lcp^.name, fcp^.name) then begin 
-            (*name conflict, follow right link*)
-            if incstk <> nil then begin
-              writeln; write('*** Duplicate in uses/joins: '); 
-              writevp(output, fcp^.name);
-              writeln
-            end; 
-            { give appropriate error }
-            if lcp^.klass = alias then error(242) else error(101); 
-            lcp := lcp^.rlink; lleft := false
-          end else
-            if strltnvv(lcp^.name, fcp^.name) then
-              begin lcp := lcp^.rlink; lleft := false end
-            else begin lcp := lcp^.llink; lleft := true end
-        until lcp = nil;
-        if lleft then lcp1^.llink := fcp else lcp1^.rlink := fcp
-      end;
-    fcp^.llink := nil; fcp^.rlink := nil
+    fcp^.llink := nil; fcp^.rlink := nil;
+    entcnt := entcnt+1; fcp^.tseq := entcnt;
+    if display[top].fname = nil then fcp^.tpri := maxint
+    else fcp^.tpri := strhshv(fcp^.name);
+    display[top].fname := ins(display[top].fname);
+    strassfv(nm, fcp^.name); fcp^.hnid := intern(nm, true); 
+    fcp^.hown := display[top].fname^.snm; fcp^.hlink := nil;
+    x := idhix(fcp^.hown, fcp^.hnid);
+    if idh[x] = nil then idh[x] := fcp
+    else begin lcp := idh[x];
+      while lcp^.hlink <> nil do lcp := lcp^.hlink;
+      lcp^.hlink := fcp
+    end
   end (*enterid*) ;
 
   procedure searchsection(fcp: ctp; var fcp1: ctp);
     (*to find record fields and forward declared procedure id's
      --> procedure proceduredeclaration
      --> procedure selector*)
-     label 1;
+     var n, own: integer;
   begin
-    while fcp <> nil do
-      if strequvf(fcp^.name, id) then goto 1
-      else if strltnvf(fcp^.name, id) then fcp := fcp^.rlink
-        else fcp := fcp^.llink;
-1:  if fcp <> nil then 
-      if fcp^.klass = alias then fcp := fcp^.actid;
-    fcp1 := fcp
+    fcp1 := nil; n := intern(id, false);
+    if (fcp <> nil) and (n <> 0) then begin
+      own := fcp^.snm; fcp := idh[idhix(own, n)];
+      while fcp <> nil do
+        if (fcp^.hown = own) and (fcp^.hnid = n) then 
+          begin fcp1 := fcp; fcp := nil end
+        else fcp := fcp^.hlink
+    end;
+    if fcp1 <> nil then 
+      if fcp1^.klass = alias then fcp1 := fcp1^.actid
   end (*searchsection*) ;
 
-  procedure schsecidnenm(lcp: ctp; fidcls: setofids; var fcp: ctp; 
-                         var mm: boolean);
-  var lcp1: ctp;
+  { search the name tree with root lcp for interned name n }
+  procedure schsecnid(lcp: ctp; n: integer; fidcls: setofids; var fcp: ctp; 
+                      var mm: boolean);
+  var lcp1: ctp; own: integer;
   begin
     mm := false; fcp := nil;
-    while lcp <> nil do begin
-      if strequvf(lcp^.name, id) then begin
-        lcp1 := lcp; if lcp1^.klass = alias then lcp1 := lcp1^.actid;
-        if lcp1^.klass in fidcls then begin fcp := lcp1; lcp := nil end
-        else begin mm := true; lcp := lcp^.rlink end
-      end else
-        if strltnvf(lcp^.name, id) then lcp := lcp^.rlink
-        else lcp := lcp^.llink
+    if (lcp <> nil) and (n <> 0) then begin
+      own := lcp^.snm; lcp := idh[idhix(own, n)];
+      while lcp <> nil do begin
+        if (lcp^.hown = own) and (lcp^.hnid = n) then begin
+          lcp1 := lcp; if lcp1^.klass = alias then lcp1 := lcp1^.actid;
+          if lcp1^.klass in fidcls then begin fcp := lcp1; lcp := nil end
+          else mm := true
+        end;
+        if lcp <> nil then lcp := lcp^.hlink
+      end
     end
+  end (*schsecnid*) ;
+
+  procedure schsecidnenm(lcp: ctp; fidcls: setofids; var fcp: ctp; 
+                         var mm: boolean);
+  begin
+    schsecnid(lcp, intern(id, false), fidcls, fcp, mm)
   end (*searchidne*) ;
 
   procedure searchidnenm(fidcls: setofids; var fcp: ctp; var mm: boolean);
     label 1;
-    var disxl: disprange;
+    var disxl: disprange; n: integer;
   begin
-    mm := false; disx := 0;
+    mm := false; disx := 0; n := intern(id, false);
     for disxl := top downto 0 do
       begin 
-        schsecidnenm(display[disxl].fname, fidcls, fcp, mm);
+        schsecnid(display[disxl].fname, n, fidcls, fcp, mm);
         if fcp <> nil then begin disx := disxl; goto 1 end
       end;
     1:;
@@ -2198,7 +2595,7 @@ end;
       lcp^.refer := true;
       if (disx <> top) and (display[top].define) then begin
         { downlevel, create an alias and link to bottom }
-        new(lcp1, alias); ininam(lcp1); lcp1^.klass := alias; 
+        getnam(lcp1); ininam(lcp1); lcp1^.klass := alias; 
         lcp1^.name := lcp^.name; lcp1^.actid := lcp;
         enterid(lcp1)
       end 
@@ -2270,6 +2667,28 @@ end;
     getbounds(fsp, fmin, fmax); 
     isbyte := (fmin >= 0) and (fmax <= 255)
   end;
+
+  { find width in bits of the elements of an array held as bit fields, or 0
+    if they are whole bytes. Packed arrays of booleans and of enumerations
+    of up to 16 values are packed 8, 4 or 2 to the byte }
+  function bitwid(fsp: stp): integer;
+  var fmin, fmax: integer; t: stp;
+  begin bitwid := 0;
+    if fsp <> nil then
+      if (fsp^.form = arrays) and fsp^.packing and (fsp^.aeltype <> nil) then 
+        begin t := fsp^.aeltype;
+          if t^.form = subrange then t := t^.rangetype;
+          if t <> nil then
+            if (t^.form = scalar) and (fsp^.aeltype^.size = 1) then
+              if t^.scalkind = declared then begin 
+                getbounds(fsp^.aeltype, fmin, fmax);
+                if fmin >= 0 then
+                  if fmax <= 1 then bitwid := 1
+                  else if fmax <= 3 then bitwid := 2
+                  else if fmax <= 15 then bitwid := 4
+              end
+        end
+  end;
   
   function basetype(fsp: stp): stp;
     { remove any subrange types }
@@ -2285,6 +2704,15 @@ end;
     basetype := fsp
   end;
 
+  { find size of large set holding elements up to h }
+  function lsetsz(h: integer): addrrange;
+  begin lsetsz := (h div 8 div intsize + 1)*intsize end;
+
+  { check set size is that of a sparse set, the one size above the largest
+    large set }
+  function sprsz(sz: addrrange): boolean;
+  begin sprsz := sz > lsetsz(lsethigh) end;
+
   { alignment for general memory placement }
   function alignquot(fsp: stp): integer;
   begin
@@ -2294,13 +2722,21 @@ end;
         case form of
           scalar:   if fsp=intptr then alignquot := intal
                     else if fsp=boolptr then alignquot := boolal
-                    else if scalkind=declared then alignquot := intal
+                    else if scalkind=declared then begin
+                      { in natural layout, byte enumerations align to bytes }
+                      if natal and (size < intal) then alignquot := size
+                      else alignquot := intal
+                    end
                     else if fsp=charptr then alignquot := charal
                     else if fsp=realptr then alignquot := realal
                     else (*parmptr*) alignquot := parmal;
-          subrange: alignquot := alignquot(rangetype);
+          subrange: if natal and (size < alignquot(rangetype)) then 
+                      alignquot := size
+                    else alignquot := alignquot(rangetype);
           pointer:  alignquot := adral;
-          power:    alignquot := setal;
+          power:    if sprsz(size) then alignquot := intal
+                    else if size >= setsize then alignquot := setal
+                    else alignquot := intal;
           files:    alignquot := fileal;
           arrays:   alignquot := alignquot(aeltype);
           arrayc:   alignquot := alignquot(abstype);
@@ -2558,17 +2994,48 @@ end;
     if not eol then write(' ':chcnt+16)
   end (*printtables*);
 
+  { Unreferenced ids are listed in the order of the unbalanced tree that
+    entering the ids one after another would give, as before enterid balanced
+    the tree. That tree is the one with the ids in name order, and each id
+    entered before those under it, so it is built from the name order with a
+    stack, then walked left, right, then id. }
   procedure chkrefs(p: ctp; var w: boolean);
+  type refp = ^refnod;
+       refnod = record id: ctp; l, r, up: refp end;
+  var s, rt: refp;
+  procedure place(p: ctp);
+  var n, last: refp; done: boolean;
+  begin
+    if p <> nil then begin
+      place(p^.llink);
+      new(n); n^.id := p; n^.r := nil; last := nil;
+      { ids entered later than this one go under it, to the left }
+      done := s = nil;
+      while not done do
+        if s^.id^.tseq > p^.tseq then 
+          begin last := s; s := s^.up; done := s = nil end
+        else done := true;
+      n^.l := last; if s <> nil then s^.r := n;
+      n^.up := s; s := n;
+      place(p^.rlink)
+    end
+  end;
+  procedure report(n: refp);
+  begin
+    if n <> nil then begin
+      report(n^.l); report(n^.r);
+      if not n^.id^.refer and (n^.id^.klass <> alias) then begin 
+        if not w then writeln; writev(output, n^.id^.name, 10); 
+        writeln(' unreferenced'); w := true
+      end;
+      dispose(n)
+    end
+  end;
   begin
     if chkref then begin
-      if p <> nil then begin
-        chkrefs(p^.llink, w); { check left }
-        chkrefs(p^.rlink, w); { check right }
-        if not p^.refer and (p^.klass <> alias) then begin 
-          if not w then writeln; writev(output, p^.name, 10); 
-          writeln(' unreferenced'); w := true
-        end
-      end
+      s := nil; place(p);
+      rt := s; if rt <> nil then while rt^.up <> nil do rt := rt^.up;
+      report(rt)
     end
   end;
   
@@ -2631,8 +3098,31 @@ end;
 
   procedure putlabel(labname: integer);
   begin 
-    if prcode then begin prtlabel(labname); writeln(prr) end 
+    if (dcllab <> 0) and (labname = dcllab) then begin
+      { end of unreachable code, resume output }
+      dcllab := 0; prcode := option['c']; topnew := dcltop
+    end;
+    if prcode then begin
+      { a held jump to this label is a jump to the next instruction }
+      if (pkop = 57(*ujp*)) and (pkp2 = labname) then pkop := -1
+      else flushpk;
+      inlok := false; { code with labels is not inlined }
+      if dopeep then begin
+        { hold the label until the instruction it labels is known }
+        if pklcnt = maxpkl then flushpk;
+        pklcnt := pklcnt+1; pklab[pklcnt] := labname
+      end else begin prtlabel(labname); writeln(prr) end
+    end
   end (*putlabel*);
+
+  { output the labels held back as labels of the return that follows. pint
+    replaces unconditional jumps to them with a copy of the return }
+  procedure pkret;
+  var i: integer;
+  begin
+    for i := 1 to pklcnt do begin prtlabel(pklab[i]); writeln(prr, '=r') end;
+    thrcnt := thrcnt+pklcnt; pklcnt := 0
+  end;
       
   procedure searchlabel(var llp: lbp; level: disprange; isid: boolean);
   var fllp: lbp; { found label entry }
@@ -2670,6 +3160,7 @@ end;
             ipcref := false; minlvl := pmmaxint; bact := false; 
             refer := false
           end;
+        if flabel = nil then labend := llp; nlab := nlab+1;
         flabel := llp
       end
   end;
@@ -2739,7 +3230,7 @@ end;
            pointer,
            files,
            exceptf:  ss := 5;
-           power:    ss := 6;
+           power:    if size = setsize then ss := 6 else ss := 1;
            records,arrays,arrayc: ss := 7;
            tagfld,variant: error(501)
           end;
@@ -2752,19 +3243,222 @@ end;
   end (*mest*);
 
   procedure putic;
-  begin if ic mod 10 = 0 then writeln(prr,'!',ic:5) end;
+  begin flushpk; inscnt := inscnt+1;
+    if inlcap then begin
+      { the last instruction must have been captured }
+      if inlpnd then inlok := false;
+      inlpnd := true
+    end;
+    if (ic mod 10 = 0) and not dobin then writeln(prr,'!',ic:5) 
+  end;
 
-  procedure gen0(fop: oprange);
+  { start an instruction in binary, option c2. prb gets a header of twice
+    the number of operands, plus one if the last is a near label, then the
+    mnemonic and type letter packed five bits to a letter. prr gets a '#'
+    line in its place, which keeps the order with the lines that stay text.
+    The caller writes the operands. The binary starts with the magic word
+    and version, matched by a '#!' line, and ends with the count of
+    instructions, matched by a '#.' line, so pint can find it out of step }
+  procedure putbin(fop: oprange; t: char; n: integer; lab: boolean);
+  var i, c: integer;
   begin
-    if prcode then begin putic; writeln(prr,mn[fop]:4) end;
-    ic := ic + 1; mes(fop)
+    if not binopn then begin 
+      rewrite(prb); binopn := true; bincnt := 0;
+      writeln(prr, '#!'); write(prb, binmag, binver)
+    end;
+    writeln(prr, '#'); c := 0; bincnt := bincnt+1;
+    for i := 1 to 4 do
+      if mn[fop][i] <> ' ' then c := c*32+ord(mn[fop][i])-ord('a')+1;
+    if t <> ' ' then c := c*32+ord(t)-ord('a')+1;
+    write(prb, n*2+ord(lab), c)
+  end;
+
+  { find standard type that outputs the same as the given type, or nil if
+    there is none }
+  function inltyp(fsp: stp): stp;
+  begin
+    inltyp := nil;
+    if fsp <> nil then 
+      if fsp^.size > 1 then
+        case fsp^.form of
+          scalar: if (fsp = intptr) or (fsp = realptr) or (fsp = boolptr) or
+                     (fsp = charptr) then inltyp := fsp
+                  else if fsp^.scalkind = declared then inltyp := intptr;
+          subrange: inltyp := inltyp(fsp^.rangetype);
+          pointer: inltyp := nilptr;
+          power,arrays,arrayc,records,files,tagfld,variant,exceptf: 
+        end
+      else if (fsp = boolptr) or (fsp = charptr) then inltyp := fsp
+  end;
+
+  { capture the instruction just output, for inlining. Only code that can be
+    moved to another frame is taken, which is local access at level 0, global
+    access, constants and operators. Anything else stops the capture }
+  procedure inlput(k: integer; fop: oprange; fp1, fp2: integer; fsp: stp);
+    var p: inlp; ok: boolean;
+  begin
+    if inlcap then begin
+      inlpnd := false;
+      if inlok then begin
+        ok := false;
+        case k of
+          0: ok := fop in [0,1,2,3,4,6,7,9,10,13,14,15,16,17,18,20,21,22,24,
+                           25,27,59,61,83];
+          1: ok := fop in [19,26,58,76];
+          2: ok := fop in [31,34,35,39,43];
+          3: if fop = 51(*ldc*) then ok := fp1 in [1,3,4,6]
+             else if fop = 50(*lda*) then ok := fp1 = 0
+             else if fop in [47,48,49,52,53,55] then 
+               ok := chr(fp1) in ['i','r','b','c','a'];
+          4: if fop = 45(*chk*) then ok := true
+             else if fop in [54,56] then ok := fp1 = 0
+        end;
+        if ok and (fsp <> nil) then 
+          begin fsp := inltyp(fsp); ok := fsp <> nil end;
+        inlsiz := inlsiz+1;
+        if ok and (inlsiz <= inlmax) then begin
+          getinl(p); p^.next := nil; p^.kind := k; p^.op := fop; 
+          p^.p1 := fp1; p^.p2 := fp2; p^.sp := fsp;
+          if inlhd = nil then inlhd := p else inltl^.next := p; 
+          inltl := p
+        end else inlok := false
+      end
+    end
+  end;
+
+  { check routine code can be captured for inlining. It must be a plain
+    procedure or function, with value parameters of simple type or VAR
+    parameters }
+  function inlcand(fcp: ctp): boolean;
+    var ok: boolean; lcp: ctp;
+  begin ok := false;
+    if fcp <> nil then
+      if fcp^.pfdeckind = declared then
+        if fcp^.pfkind = actual then
+          ok := not fcp^.externl and not fcp^.pext and 
+                (fcp^.pfattr = fpanone) and (fcp^.grpnxt = nil) and 
+                (fcp^.grppar = nil);
+    if ok then if fcp^.klass = func then ok := inltyp(fcp^.idtype) <> nil;
+    if ok then begin
+      lcp := fcp^.pflist;
+      while lcp <> nil do begin
+        if lcp^.klass <> vars then ok := false
+        else if lcp^.idtype = nil then ok := false
+        else if (lcp^.vkind = actual) or (lcp^.part = ptview) then begin
+          if inltyp(lcp^.idtype) = nil then ok := false
+        end else if lcp^.idtype^.form = arrayc then ok := false;
+        lcp := lcp^.next
+      end
+    end;
+    inlcand := ok
+  end;
+
+  { remove the top held constant }
+  procedure pkpop;
+  begin
+    if pkcv then begin pkp1 := pkc1; pkp2 := pkc2; pkcv := false end
+    else pkop := -1
+  end;
+
+  { check a held ldci can be removed along with the operator that follows it,
+    which is x+0, x-0, x*1 and x div 1 }
+  function pkident(fop: oprange): boolean;
+  begin
+    pkident := false;
+    if dopeep and prcode and (pkop = 51(*ldc*)) and (pkp1 = 1) then
+      pkident := ((pkp2 = 0) and ((fop = 2(*adi*)) or (fop = 21(*sbi*)))) or
+                 ((pkp2 = 1) and ((fop = 15(*mpi*)) or (fop = 6(*dvi*))))
+  end;
+
+  { fold an operator on the two held constants into one. This is only done
+    where the run time checks would pass, so the result is the same }
+  function pkfold(fop: oprange): boolean;
+    var a, b: integer; ok: boolean;
+  begin
+    ok := false;
+    if doglob and prcode and (pkop = 51(*ldc*)) and pkcv and 
+       (pkp1 = pkc1) then begin
+      a := pkc2; b := pkp2;
+      if pkp1 = 1 then begin { integer }
+        if fop in [2,6,14,15,21,47,48,49,52,53,55] then case fop of
+          2(*adi*): if ((a<0) <> (b<0)) or (pmmaxint-abs(a) >= abs(b)) then
+                      begin ok := true; a := a+b end;
+          21(*sbi*): if ((a<0) = (b<0)) or (pmmaxint-abs(a) >= abs(b)) then
+                       begin ok := true; a := a-b end;
+          15(*mpi*): if (a = 0) or (b = 0) then begin ok := true; a := 0 end
+                     else if abs(a) <= pmmaxint div abs(b) then
+                       begin ok := true; a := a*b end;
+          6(*dvi*): if b <> 0 then begin ok := true; a := a div b end;
+          { negative dividends are left, since machines differ on the result }
+          14(*mod*): if (a >= 0) and (b > 0) then 
+                       begin ok := true; a := a mod b end;
+          47(*equ*): begin ok := true; a := ord(a = b) end;
+          55(*neq*): begin ok := true; a := ord(a <> b) end;
+          53(*les*): begin ok := true; a := ord(a < b) end;
+          52(*leq*): begin ok := true; a := ord(a <= b) end;
+          49(*grt*): begin ok := true; a := ord(a > b) end;
+          48(*geq*): begin ok := true; a := ord(a >= b) end
+        end
+      end else begin { boolean }
+        if fop in [4,13,47,48,49,52,53,55,83] then case fop of
+          4(*and*): begin ok := true; a := ord((a = 1) and (b = 1)) end;
+          13(*ior*): begin ok := true; a := ord((a = 1) or (b = 1)) end;
+          83(*xor*): begin ok := true; a := ord(a <> b) end;
+          47(*equ*): begin ok := true; a := ord(a = b) end;
+          55(*neq*): begin ok := true; a := ord(a <> b) end;
+          53(*les*): begin ok := true; a := ord(a < b) end;
+          52(*leq*): begin ok := true; a := ord(a <= b) end;
+          49(*grt*): begin ok := true; a := ord(a > b) end;
+          48(*geq*): begin ok := true; a := ord(a >= b) end
+        end
+      end;
+      if ok then begin
+        pkcv := false; pkp2 := a;
+        if fop in [47,48,49,52,53,55] then pkp1 := 3 { result is boolean }
+      end
+    end;
+    pkfold := ok
+  end;
+
+  { check type can be held in store/load pairs, which must have a dup }
+  function pkdup(fsp: stp): boolean;
+  begin
+    pkdup := false;
+    if fsp <> nil then
+      pkdup := (fsp = intptr) or (fsp = realptr) or (fsp = boolptr) or
+               (fsp = charptr) or (fsp^.form = pointer)
+  end;
+
+  procedure gen0(fop: oprange);
+    var oph: phase;
+  begin phsw(phgen, oph);
+    if pkfold(fop) then { constant result held }
+    else if doglob and prcode and (fop = 17(*ngi*)) and (pkop = 51(*ldc*)) and
+            (pkp1 = 1) then pkp2 := -pkp2
+    else if pkident(fop) then pkpop { drop both }
+    else begin
+      if prcode then 
+        begin putic;
+          if dobin then putbin(fop,' ',0,false) else writeln(prr,mn[fop]:4);
+          inlput(0,fop,0,0,nil)
+        end;
+      ic := ic + 1; mes(fop)
+    end;
+    phsw(oph, oph)
   end (*gen0*) ;
 
   procedure gen1s(fop: oprange; fp2: integer; symptr: ctp);
-    var k, j: integer; p: strvsp;
-  begin
-    if prcode then
-      begin putic; write(prr,mn[fop]:4);
+    var k, j: integer; p: strvsp; oph: phase; bin: boolean;
+  begin phsw(phgen, oph);
+    { a constant pushed only to be dumped is dropped with the dump }
+    if dopeep and prcode and (fop = 71(*dmp*)) and (pkop = 51(*ldc*)) and 
+       (pkp1 = 1) and (fp2 = intsize) then pkpop
+    else if prcode then
+      begin if fop = 42(*ret*) then pkret; putic;
+        { names, strings and labels stay text under c2 }
+        bin := dobin and not (fop in [30,38,105]) and not chkext(symptr) and
+               not chkfix(symptr);
+        if not bin then write(prr,mn[fop]:4);
         if fop = 30 then
           begin writeln(prr,sna[fp2]:12);
             mesl(pdx[fp2]);
@@ -2784,9 +3478,14 @@ end;
                  end;
                  writeln(prr,'''')
                end
+            else if bin then begin
+              if fop = 42 then putbin(fop,chr(fp2),0,false)
+              else begin putbin(fop,' ',1,false); write(prb,fp2) end
+            end
             else if fop = 42 then writeln(prr,chr(fp2))
             else if fop = 67 then writeln(prr,fp2:4)
-            else if fop = 105 then begin write(prr, ' '); putlabel(fp2) end
+            else if fop = 105 then 
+              begin write(prr, ' '); prtlabel(fp2); writeln(prr) end
             else if chkext(symptr) then 
               begin write(prr, ' '); prtflabel(symptr); writeln(prr) end
             else if chkfix(symptr) then
@@ -2797,7 +3496,8 @@ end;
             else mes(fop)
           end
       end;
-    ic := ic + 1
+    ic := ic + 1;
+    phsw(oph, oph)
   end (*gen1s*) ;
   
   procedure gen1(fop: oprange; fp2: integer);
@@ -2806,22 +3506,45 @@ end;
   end;
   
   procedure gen2(fop: oprange; fp1,fp2: integer);
-    var k : integer;
-  begin
-    if prcode then
-      begin putic; write(prr,mn[fop]:4);
+    var k : integer; oph: phase;
+  begin phsw(phgen, oph);
+    if (fop in [50(*lda*),74(*lip*)]) and (fp1 > 0) then lfok := false;
+    if prcode and (fop = 51(*ldc*)) and 
+       ((dopeep and (fp1 = 1)) or (doglob and ((fp1 = 1) or (fp1 = 3)))) then 
+      begin { hold ldci or ldcb }
+        if doglob and (pkop = 51(*ldc*)) and not pkcv then
+          begin pkcv := true; pkc1 := pkp1; pkc2 := pkp2 end
+        else flushpk;
+        pkop := fop; pkp1 := fp1; pkp2 := fp2 
+      end
+    else if (fop in [47,48,49,52,53,55]) and 
+            ((fp1 = ord('i')) or (fp1 = ord('b'))) and pkfold(fop) then
+      { constant result held }
+    else if prcode then
+      begin putic; inlput(3,fop,fp1,fp2,nil);
+        { ldc of reals, chars and sets stays text under c2 }
+        if not dobin or (fop = 51) and not (fp1 in [1,3,4]) then 
+          write(prr,mn[fop]:4);
         case fop of
-          45,50,54,56,74,62,63,81,82,96,97,102,104,109,112,115,116,117: 
+          45,50,54,56,74,62,63,81,82,96,97,102,104,109,112,115,116,117,119: 
             begin
-              writeln(prr,' ',fp1:3,' ',fp2:8);
+              if dobin then 
+                begin putbin(fop,' ',2,false); write(prb,fp1,fp2) end
+              else writeln(prr,' ',fp1:3,' ',fp2:8);
               if fop = 116 then mesl(-fp2)
               else if fop = 117 then mesl(fp2-fp1)
               else mes(fop)
             end;
           47,48,49,52,53,55:
-            begin write(prr,chr(fp1));
-              if chr(fp1) = 'm' then write(prr,' ',fp2:11);
-              writeln(prr);
+            begin
+              if dobin then begin
+                putbin(fop,chr(fp1),ord(chr(fp1) = 'm'),false);
+                if chr(fp1) = 'm' then write(prb,fp2)
+              end else begin
+                write(prr,chr(fp1));
+                if chr(fp1) = 'm' then write(prr,' ',fp2:11);
+                writeln(prr)
+              end;
               case chr(fp1) of
                 'i': mesl(cdxs[cdx[fop]][1]);
                 'r': mesl(cdxs[cdx[fop]][2]);
@@ -2836,7 +3559,10 @@ end;
           51:
             begin
               case fp1 of
-                1: begin writeln(prr,'i ',fp2:1);
+                1: begin
+                     if dobin then 
+                       begin putbin(fop,'i',1,false); write(prb,fp2) end
+                     else writeln(prr,'i ',fp2:1);
                      mesl(cdxs[cdx[fop]][1]) 
                    end;
                 2: begin write(prr,'r ');
@@ -2844,10 +3570,15 @@ end;
                      writeln(prr);
                      mesl(cdxs[cdx[fop]][2]);
                    end;
-                3: begin writeln(prr,'b ',fp2:1);
+                3: begin
+                     if dobin then 
+                       begin putbin(fop,'b',1,false); write(prb,fp2) end
+                     else writeln(prr,'b ',fp2:1);
                      mesl(cdxs[cdx[fop]][3]) 
                    end;
-                4: begin writeln(prr,'n');
+                4: begin
+                     if dobin then putbin(fop,'n',0,false)
+                     else writeln(prr,'n');
                      mesl(-ptrsize)
                    end;
                 6: begin
@@ -2869,59 +3600,95 @@ end;
             end
         end
       end;
-    ic := ic + 1
+    ic := ic + 1;
+    phsw(oph, oph)
   end (*gen2*) ;
 
-  procedure gentypindicator(fsp: stp);
-  begin
+  { find the type letter of an instruction, or space for none }
+  function typind(fsp: stp): char;
+    var c: char;
+  begin c := ' ';
     if fsp<>nil then
       with fsp^ do
         case form of
-         scalar: if fsp=intptr then write(prr,'i')
+         scalar: if fsp=intptr then c := 'i'
                  else
-                   if fsp=boolptr then write(prr,'b')
+                   if fsp=boolptr then c := 'b'
                    else
-                     if fsp=charptr then write(prr,'c')
+                     if fsp=charptr then c := 'c'
                      else
                        if scalkind = declared then begin
-                         if fsp^.size = 1 then write(prr, 'x')
-                         else write(prr,'i')
-                       end else write(prr,'r');
-         subrange: if fsp^.size = 1 then write(prr, 'x')
-                   else gentypindicator(rangetype);
+                         if fsp^.size = 1 then c := 'x'
+                         else c := 'i'
+                       end else c := 'r';
+         subrange: if fsp^.size = 1 then c := 'x'
+                   else c := typind(rangetype);
          pointer,
          files,
-         exceptf:  write(prr,'a');
-         power:    write(prr,'s');
-         records,arrays,arrayc: write(prr,'m');
+         exceptf:  c := 'a';
+         power:    if size = setsize then c := 's'
+                   else if size < setsize then c := 'i'
+                   else c := 'm';
+         records,arrays,arrayc: c := 'm';
          tagfld,variant: error(503)
-        end
+        end;
+    typind := c
+  end (*typind*);
+
+  procedure gentypindicator(fsp: stp);
+    var c: char;
+  begin c := typind(fsp);
+    if c <> ' ' then write(prr,c)
   end (*typindicator*);
 
   procedure gen0t(fop: oprange; fsp: stp);
-  begin
-    if prcode then
-      begin putic;
-        write(prr,mn[fop]:4);
-        gentypindicator(fsp);
-        writeln(prr);
+    var oph: phase;
+  begin phsw(phgen, oph);
+    if doglob and prcode and (fop = 19(*not*)) and (fsp = boolptr) and
+       (pkop = 51(*ldc*)) and (pkp1 = 3) then pkp2 := 1-pkp2
+    else if prcode then
+      begin if fop = 42(*ret*) then pkret; putic;
+        if dobin then putbin(fop,typind(fsp),0,false)
+        else begin
+          write(prr,mn[fop]:4);
+          gentypindicator(fsp);
+          writeln(prr)
+        end;
+        inlput(1,fop,0,0,fsp)
       end;
-    ic := ic + 1; mest(fop, fsp)
+    ic := ic + 1; mest(fop, fsp);
+    phsw(oph, oph)
   end (*gen0t*);
 
   procedure gen1ts(fop: oprange; fp2: integer; fsp: stp; symptr: ctp);
-  begin
-    if prcode then
-      begin putic;
-        write(prr,mn[fop]:4);
-        gentypindicator(fsp);
-        write(prr, ' ');
-        if chkext(symptr) then prtflabel(symptr) 
-        else if chkfix(symptr) then prtlabel(symptr^.floc)
-        else write(prr,fp2:11);
-        writeln(prr)
-      end;
-    ic := ic + 1; mest(fop, fsp)
+    var oph: phase;
+  begin phsw(phgen, oph);
+    if dopeep and prcode and (fop = 39(*ldo*)) and (pkop = 43(*sro*)) and
+       (symptr = nil) and (pkp2 = fp2) and (pksp = fsp) then begin
+      { load of the global just stored, keep a copy instead }
+      pkop := -1; gen0t(76(*dup*),fsp); gen1ts(43(*sro*),fp2,fsp,nil)
+    end else if dopeep and prcode and (fop = 43(*sro*)) and (symptr = nil) and
+                pkdup(fsp) then begin
+      flushpk; pkop := fop; pkp2 := fp2; pksp := fsp { hold sro }
+    end else begin
+      if prcode then
+        begin if fop = 42(*ret*) then pkret; putic;
+          if dobin and not chkext(symptr) and not chkfix(symptr) then begin
+            putbin(fop,typind(fsp),1,false); write(prb,fp2); 
+            inlput(2,fop,0,fp2,fsp)
+          end else begin
+            write(prr,mn[fop]:4);
+            gentypindicator(fsp);
+            write(prr, ' ');
+            if chkext(symptr) then prtflabel(symptr) 
+            else if chkfix(symptr) then prtlabel(symptr^.floc)
+            else begin write(prr,fp2:11); inlput(2,fop,0,fp2,fsp) end;
+            writeln(prr)
+          end
+        end;
+      ic := ic + 1; mest(fop, fsp)
+    end;
+    phsw(oph, oph)
   end (*gen1ts*);
   
   procedure gen1t(fop: oprange; fp2: integer; fsp: stp);
@@ -2930,72 +3697,176 @@ end;
   end;
 
   procedure gen2t(fop: oprange; fp1,fp2: integer; fsp: stp);
-  begin
-    if prcode then
-      begin putic;
-        write(prr,mn[fop]: 4);
-        gentypindicator(fsp);
-        writeln(prr,' ', fp1:3+5*ord(abs(fp1)>99),' ',fp2:11);
-      end;
-    ic := ic + 1; mest(fop, fsp)
+    var oph: phase;
+  begin phsw(phgen, oph);
+    if (fop in [54(*lod*),56(*str*)]) and (fp1 > 0) then lfok := false;
+    if dopeep and prcode and (fop = 54(*lod*)) and (pkop = 56(*str*)) and
+       (pkp1 = fp1) and (pkp2 = fp2) and (pksp = fsp) then begin
+      { load of the local just stored, keep a copy instead }
+      pkop := -1; gen0t(76(*dup*),fsp); gen2t(56(*str*),fp1,fp2,fsp)
+    end else if dopeep and prcode and (fop = 56(*str*)) and pkdup(fsp) then
+      begin flushpk; pkop := fop; pkp1 := fp1; pkp2 := fp2; pksp := fsp end
+    else begin
+      if prcode then
+        begin putic;
+          if dobin then 
+            begin putbin(fop,typind(fsp),2,false); write(prb,fp1,fp2) end
+          else begin
+            write(prr,mn[fop]: 4);
+            gentypindicator(fsp);
+            writeln(prr,' ', fp1:3+5*ord(abs(fp1)>99),' ',fp2:11)
+          end;
+          inlput(4,fop,fp1,fp2,fsp)
+        end;
+      ic := ic + 1; mest(fop, fsp)
+    end;
+    phsw(oph, oph)
   end (*gen2t*);
 
   procedure genujpxjpcal(fop: oprange; fp2: integer);
-  begin
-   if prcode then
-      begin putic; write(prr,mn[fop]:4, ' '); prtlabel(fp2); writeln(prr) end;
-    ic := ic + 1; mes(fop)
+    var oph: phase; i: integer;
+  begin phsw(phgen, oph);
+    if (dopeep or doglob) and prcode and (fop = 57(*ujp*)) then begin
+      { labels of a jump are the labels of its target, unless one of them is
+        the target itself }
+      i := 1; 
+      while i <= pklcnt do
+        if pklab[i] = fp2 then i := pklcnt+2 else i := i+1;
+      if i = pklcnt+1 then begin
+        for i := 1 to pklcnt do
+          begin prtlabel(pklab[i]); write(prr, '='); prtlabel(fp2); 
+            writeln(prr) end;
+        thrcnt := thrcnt+pklcnt; pklcnt := 0
+      end;
+      flushpk; pkop := fop; pkp2 := fp2 { hold ujp }
+    end
+    else begin
+      if prcode then
+        begin putic;
+          if dobin then begin putbin(fop,' ',1,true); write(prb,fp2) end
+          else begin write(prr,mn[fop]:4, ' '); prtlabel(fp2); writeln(prr) end
+        end;
+      ic := ic + 1; mes(fop)
+    end;
+    phsw(oph, oph)
   end (*genujpxjpcal*);
+
+  { output the held instruction or labels, if any }
+  procedure flushpk;
+    var op, i: integer; sv, svg: boolean;
+  begin
+    for i := 1 to pklcnt do begin prtlabel(pklab[i]); writeln(prr) end;
+    pklcnt := 0;
+    if pkop >= 0 then begin
+      op := pkop; pkop := -1; sv := dopeep; dopeep := false;
+      svg := doglob; doglob := false;
+      case op of
+        51: begin
+              if pkcv then gen2(51(*ldc*),pkc1,pkc2);
+              pkcv := false; gen2(51(*ldc*),pkp1,pkp2)
+            end;
+        57: genujpxjpcal(57(*ujp*),pkp2);
+        56: gen2t(56(*str*),pkp1,pkp2,pksp);
+        43: gen1t(43(*sro*),pkp2,pksp)
+      end;
+      dopeep := sv; doglob := svg
+    end
+  end;
+
+  { output the code captured for a routine in place of a call to it. Frame
+    addresses are moved by d into the caller's frame }
+  procedure geninl(p: inlp; d: integer);
+  begin
+    while p <> nil do begin
+      case p^.kind of
+        0: gen0(p^.op);
+        1: gen0t(p^.op,p^.sp);
+        2: gen1t(p^.op,p^.p2,p^.sp);
+        3: if p^.op = 50(*lda*) then gen2(p^.op,p^.p1,p^.p2+d)
+           else gen2(p^.op,p^.p1,p^.p2);
+        4: if p^.op = 45(*chk*) then gen2t(p^.op,p^.p1,p^.p2,p^.sp)
+           else gen2t(p^.op,p^.p1,p^.p2+d,p^.sp)
+      end;
+      p := p^.next
+    end
+  end;
   
   procedure gencjp(fop: oprange; fp1,fp2,fp3: integer);
-  begin
+    var oph: phase;
+  begin phsw(phgen, oph);
    if prcode then
       begin putic; 
-        write(prr,mn[fop]:4, ' ', fp1:3+5*ord(abs(fp1)>99),' ',fp2:11,
-                    ' '); prtlabel(fp3); writeln(prr) 
+        if dobin then begin putbin(fop,' ',3,true); write(prb,fp1,fp2,fp3) end
+        else begin
+          write(prr,mn[fop]:4, ' ', fp1:3+5*ord(abs(fp1)>99),' ',fp2:11,
+                      ' '); prtlabel(fp3); writeln(prr) 
+        end
       end;
-    ic := ic + 1; mes(fop)
+    ic := ic + 1; mes(fop);
+    phsw(oph, oph)
   end (*gencjp*);
 
   procedure genipj(fop: oprange; fp1, fp2: integer);
-  begin
+    var oph: phase;
+  begin phsw(phgen, oph); lfok := false;
    if prcode then
-      begin putic; write(prr,mn[fop]:4,fp1:4,' '); prtlabel(fp2); writeln(prr) end;
-    ic := ic + 1; mes(fop)
+      begin putic;
+        if dobin then begin putbin(fop,' ',2,true); write(prb,fp1,fp2) end
+        else 
+          begin write(prr,mn[fop]:4,fp1:4,' '); prtlabel(fp2); writeln(prr) end
+      end;
+    ic := ic + 1; mes(fop);
+    phsw(oph, oph)
   end (*genipj*);
 
   procedure gencupent(fop: oprange; fp1,fp2: integer; fcp: ctp);
-  begin
+    var oph: phase;
+  begin phsw(phgen, oph);
     if prcode then
       begin putic;
         if fop = 32 then begin { create ents or ente instructions }
-          if fp1 = 1 then 
-            begin write(prr,mn[fop]:4,'s '); prtlabel(fp2) end
-          else 
-            begin write(prr,mn[fop]:4,'e '); prtlabel(fp2) end;
-          writeln(prr);
+          if dobin then begin
+            if fp1 = 1 then putbin(fop,'s',1,true) else putbin(fop,'e',1,true);
+            write(prb,fp2)
+          end else begin
+            if fp1 = 1 then 
+              begin write(prr,mn[fop]:4,'s '); prtlabel(fp2) end
+            else 
+              begin write(prr,mn[fop]:4,'e '); prtlabel(fp2) end;
+            writeln(prr)
+          end;
           mes(fop)
         end else begin
-          write(prr,mn[fop]:4,fp1:4,' ');
-          if chkext(fcp) then prtflabel(fcp) else prtlabel(fp2);
-          writeln(prr);
+          if dobin and not chkext(fcp) then 
+            begin putbin(fop,' ',2,true); write(prb,fp1,fp2) end
+          else begin
+            write(prr,mn[fop]:4,fp1:4,' ');
+            if chkext(fcp) then prtflabel(fcp) else prtlabel(fp2);
+            writeln(prr)
+          end;
           mesl(fp1)
         end
       end;
-    ic := ic + 1
+    ic := ic + 1;
+    phsw(oph, oph)
   end;
 
   procedure genlpa(fp1,fp2: integer);
-  begin
+    var oph: phase;
+  begin phsw(phgen, oph); lfok := false;
     if prcode then
       begin putic;
-        write(prr,mn[68]:4,fp2:4, ' '); prtlabel(fp1); writeln(prr);
+        if dobin then begin putbin(68,' ',2,true); write(prb,fp2,fp1) end
+        else 
+          begin write(prr,mn[68]:4,fp2:4, ' '); prtlabel(fp1); writeln(prr) end
       end;
-    ic := ic + 1; mes(68)
+    ic := ic + 1; mes(68);
+    phsw(oph, oph)
   end (*genlpa*);
   
   procedure gensuv(fp1, fp2: integer; sym: ctp);
-  begin
+    var oph: phase;
+  begin phsw(phgen, oph);
     if prcode then begin
       putic; write(prr,mn[92(*suv*)]:4);
       write(prr, ' '); prtlabel(fp1); 
@@ -3003,26 +3874,51 @@ end;
         begin write(prr, ' '); prtflabel(sym); writeln(prr) end
       else writeln(prr, ' ', fp2:1)
     end;
-    ic := ic + 1; mes(92)
+    ic := ic + 1; mes(92);
+    phsw(oph, oph)
   end;
 
   procedure genctaivtcvb(fop: oprange; fp1,fp2,fp3: integer; fsp: stp);
-  begin if fp3 < 0 then error(511);
+    var oph: phase;
+  begin phsw(phgen, oph); if fp3 < 0 then error(511);
     if prcode then
       begin putic; write(prr,mn[fop]:4); 
             if fop <> 81(*cta*) then gentypindicator(fsp); 
             write(prr,' ',fp1:3,' ',fp2:8,' ');
-            mes(fop); putlabel(fp3)
+            mes(fop); prtlabel(fp3); writeln(prr)
       end;
-    ic := ic + 1
+    ic := ic + 1;
+    phsw(oph, oph)
   end (*gen2*) ;
   
   procedure genmst(lev: levrange; lb: integer);
-  begin
+    var oph: phase;
+  begin phsw(phgen, oph); lfok := false;
     if prcode then begin
-      putic; write(prr,mn[41(*mst*)]:4); write(prr,lev:12, ' '); prtlabel(lb); 
-      writeln(prr)
-    end
+      putic;
+      if dobin then begin putbin(41(*mst*),' ',2,true); write(prb,lev,lb) end
+      else begin
+        write(prr,mn[41(*mst*)]:4); write(prr,lev:12, ' '); prtlabel(lb); 
+        writeln(prr)
+      end
+    end;
+    phsw(oph, oph)
+  end;
+
+  { mark stack for a routine that never uses its static link. The caller
+    needs no static link of its own for that }
+  procedure genmsl(lev: levrange; lb: integer);
+    var oph: phase;
+  begin phsw(phgen, oph);
+    if prcode then begin
+      putic;
+      if dobin then begin putbin(121(*msl*),' ',2,true); write(prb,lev,lb) end
+      else begin
+        write(prr,mn[121(*msl*)]:4); write(prr,lev:12, ' '); prtlabel(lb); 
+        writeln(prr)
+      end
+    end;
+    phsw(oph, oph)
   end;
   
   function comptypes(fsp1,fsp2: stp) : boolean; forward;
@@ -3206,7 +4102,8 @@ end;
             arrays,
             arrayc: begin
               if ((fsp1^.form = arrayc) or (fsp2^.form = arrayc)) and
-                 (fsp1^.packing = fsp2^.packing) then begin
+                 (fsp1^.packing = fsp2^.packing) and 
+                 (bitwid(fsp1) = bitwid(fsp2)) then begin
                 { one or both are containers and have same packing status }
                 if fsp1^.form = arrays then ty1 := fsp1^.aeltype 
                 else ty1 := fsp1^.abstype;
@@ -3324,7 +4221,7 @@ end;
             if lgth = 1 then lsp := charptr
             else
               begin
-                new(lsp,arrays); pshstc(lsp);
+                getstc(lsp); pshstc(lsp);
                 with lsp^ do
                   begin form := arrays; aeltype := charptr; inxtype := nil;
                     tmpl := -1; size := lgth*charsize; packing := true
@@ -3336,7 +4233,7 @@ end;
         else if sy = lbrack then begin
           { set }
           insymbol;
-          new(lvp,pset); pshcst(lvp); lvp^.cclass := pset; lvp^.pval := [];
+          getcst(lvp); pshcst(lvp); lvp^.cclass := pset; lvp^.pval := [];
           if sy <> rbrack then repeat
             constexpr(fsys+[rbrack,comma,range], fsp, fvalu);
             if not fvalu.intval then error(134);
@@ -3384,7 +4281,7 @@ end;
       lvp := nil;
       if ((lop in [mul,minus]) and ((lsp = realptr) or (fsp = realptr))) or
          (lop = rdiv) then 
-        begin new(lvp,reel); pshcst(lvp); lvp^.cclass := reel end;
+        begin getcst(lvp); pshcst(lvp); lvp^.cclass := reel end;
       case lop of { operator }
         { * } mul: if (lsp = intptr) and (fsp = intptr) then begin
                      if (lv.ival <> 0) and (fvalu.ival <> 0) then
@@ -3437,7 +4334,7 @@ end;
       if (fsp <> intptr) and (fsp <> realptr) then error(106);
       if sign = neg then { must flip sign }
         if fsp = intptr then fvalu.ival := -fvalu.ival
-        else if fsp = realptr then begin new(lvp,reel); pshcst(lvp); 
+        else if fsp = realptr then begin getcst(lvp); pshcst(lvp); 
           lvp^.cclass := reel; lvp^.rval := -fvalu.valp^.rval; 
           fvalu.valp := lvp; svp := lvp;
         end else begin fvalu.intval := true; fvalu.ival := 0 end
@@ -3447,7 +4344,7 @@ end;
       constterm(fsys+[addop], fsp, fvalu);
       lvp := nil;
       if (lop in [plus,minus]) and ((lsp = realptr) or (fsp = realptr)) then 
-        begin new(lvp,reel); pshcst(lvp); lvp^.cclass := reel end;
+        begin getcst(lvp); pshcst(lvp); lvp^.cclass := reel end;
       case lop of { operator }
         { + } plus: if (lsp = intptr) and (fsp = intptr) then begin
                       if (lv.ival<0) = (fvalu.ival<0) then 
@@ -3484,20 +4381,170 @@ end;
                        else fvalu.ival := bxor(lv.ival, fvalu.ival)
                      else error(134)
       end;
-      { if left negated, recycle it just once }
-      if svp <> nil then begin putcst(svp); svp := nil end;
+      { if left negated, take it off the constant list and recycle it just 
+        once }
+      if svp <> nil then begin popcst(svp); putcst(svp); svp := nil end;
       if lvp <> nil then fvalu.valp := lvp; { place result }
       if lsp = realptr then fsp := realptr { mixed types = real }
     end
   end (*constexpr*) ;
     
+  { Sets with all elements in 0..wsethigh are held in a word, as the bits of
+    a positive integer, and are loaded and stored as integers. Sets with
+    elements above sethigh, up to lsethigh, are large sets. These are bitmaps
+    of as many words as the base type needs, and are worked by the lgs
+    instruction, which takes the operation and the set size. Sets with
+    elements above lsethigh are sparse sets. These are a count, then the
+    elements held in ascending order, each a word, in one word more than the
+    largest large set. They hold as many elements as that has words, from 
+    anywhere in 0..maxint. So the size of a set type tells its 
+    representation: less than setsize is a word, more is a large set, and 
+    more than the largest large set is a sparse set. }
+
+  { check set type is held in a word }
+  function wrdset(fsp: stp): boolean;
+  begin wrdset := false;
+    if fsp <> nil then 
+      if fsp^.form = power then wrdset := fsp^.size < setsize
+  end;
+
+  { check set type is a large or sparse set, both being worked by lgs }
+  function lrgset(fsp: stp): boolean;
+  begin lrgset := false;
+    if fsp <> nil then 
+      if fsp^.form = power then lrgset := fsp^.size > setsize
+  end;
+
+  { check set type is a sparse set }
+  function sprset(fsp: stp): boolean;
+  begin sprset := false;
+    if fsp <> nil then 
+      if fsp^.form = power then sprset := sprsz(fsp^.size)
+  end;
+
+  { find size of sparse sets }
+  function spssz: addrrange;
+  begin spssz := lsetsz(lsethigh)+intsize end;
+
+  { find size of sets of the base type }
+  function setsz(fsp: stp): addrrange;
+    var lmin, lmax: integer;
+  begin setsz := setsize;
+    if fsp <> nil then
+      if (fsp^.form <= subrange) and (fsp <> intptr) and (fsp <> realptr) then
+        begin getbounds(fsp,lmin,lmax); 
+          if lmin >= setlow then
+            if lmax <= wsethigh then setsz := intsize
+            else if lmax > sethigh then
+              if lmax <= lsethigh then setsz := lsetsz(lmax)
+              else setsz := spssz
+        end
+  end;
+
+  { generate large set operation fp1 on sets of size fp2. The operations
+    on sparse sets are 16 on from those on large sets, and they build a
+    result in fp2 bytes below the stack }
+  procedure genlgs(fp1: integer; fp2: addrrange);
+    var oph: phase; p: integer;
+  begin phsw(phgen, oph); p := fp1;
+    if sprsz(fp2) then if (fp1 <= 11) or (fp1 = 15) then p := fp1+16;
+    if prcode then 
+      begin putic; writeln(prr,mn[131]:4,' ',p:3,' ',fp2:8) end;
+    ic := ic+1;
+    if fp1 = 0 (*lod*) then mesl(adrsize-fp2)
+    else if fp1 = 1 (*sto*) then mesl(adrsize+fp2)
+    else if fp1 <= 4 (*uni,int,dif*) then mesl(fp2)
+    else if fp1 <= 8 (*equ,neq,leq,geq*) then mesl(fp2*2-intsize)
+    else if fp1 = 9 (*sgs*) then mesl(intsize-fp2)
+    else if fp1 = 10 (*rgs*) then mesl(intsize*2-fp2)
+    else if fp1 = 11 (*inn*) then mesl(fp2)
+    else if fp1 = 12 (*sfl*) then mesl(intsize+setsize-fp2)
+    else if fp1 = 13 (*slf*) then mesl(fp2-setsize)
+    else if fp1 = 14 (*rsz*) then mesl(intsize*2-fp2) { plus the old size }
+    else if fp1 = 15 (*ina*) then mesl(adrsize)
+    else if (fp1 = 28) or (fp1 = 29) (*dsp,spd*) then 
+      mesl(intsize*2-fp2); { plus the old size }
+    { reach below the stack for the result }
+    if p in [18(*uni*),19(*int*),20(*dif*)] then
+      begin mesl(-fp2*2); mesl(fp2*2) end
+    else if p in [28(*dsp*),29(*spd*)] then begin mesl(-fp2); mesl(fp2) end;
+    phsw(oph, oph)
+  end;
+
+  { generate bit field operation fp1 on fields of fp2 bits }
+  procedure genbfd(fp1, fp2: integer);
+    var oph: phase;
+  begin phsw(phgen, oph);
+    if prcode then 
+      begin putic; writeln(prr,mn[132]:4,' ',fp1:3,' ',fp2:8) end;
+    ic := ic+1;
+    if fp1 = 0 (*lod*) then mesl(adrsize)
+    else if fp1 = 1 (*sto*) then mesl(adrsize+intsize*2)
+    else mesl(adrsize*2+intsize*3) (*pck,upk*);
+    phsw(oph, oph)
+  end;
+
+  { convert set of size fsz, under q bytes on the stack, to size tsz. Sets 
+    are narrowed to a full set or word only on top. Sparse sets are made 
+    from and to large sets, going through the smallest one from a full set
+    or word }
+  procedure setcvt(fsz, tsz, q: addrrange);
+    var lsz: addrrange;
+  begin
+    if fsz < tsz then begin
+      if fsz < setsize then begin gen1(129(*swf*),q); fsz := setsize end;
+      if fsz < tsz then
+        if fsz = setsize then begin
+          lsz := tsz; if sprsz(tsz) then lsz := lsetsz(sethigh+1);
+          gen2(51(*ldc*),1,q); genlgs(12(*sfl*),lsz); fsz := lsz
+        end;
+      if fsz < tsz then begin
+        gen2(51(*ldc*),1,fsz); gen2(51(*ldc*),1,q); 
+        if sprsz(tsz) then genlgs(28(*dsp*),tsz) else genlgs(14(*rsz*),tsz);
+        mesl(fsz)
+      end
+    end else if fsz > tsz then begin
+      if sprsz(fsz) then begin
+        lsz := tsz; if lsz <= setsize then lsz := lsetsz(sethigh+1);
+        gen2(51(*ldc*),1,fsz); gen2(51(*ldc*),1,q); genlgs(29(*spd*),lsz);
+        mesl(fsz); fsz := lsz
+      end;
+      if fsz > tsz then
+        if fsz > setsize then
+          if tsz > setsize then begin 
+            gen2(51(*ldc*),1,fsz); gen2(51(*ldc*),1,q); 
+            genlgs(14(*rsz*),tsz); mesl(fsz); fsz := tsz
+          end else begin genlgs(13(*slf*),fsz); fsz := setsize end;
+      if fsz > tsz then gen0(130(*sfw*))
+    end
+  end;
+
+  { check set constant fits a word }
+  function wrdcst(fvp: csp): boolean;
+    var i: integer; f: boolean;
+  begin f := true;
+    for i := wsethigh+1 to sethigh do if i in fvp^.pval then f := false;
+    wrdcst := f
+  end;
+
+  { find word value of set constant }
+  function cstwrd(fvp: csp): integer;
+    var i, w, b: integer;
+  begin w := 0; b := 1;
+    for i := setlow to wsethigh do begin
+      if i in fvp^.pval then w := w+b;
+      if i < wsethigh then b := b*2
+    end;
+    cstwrd := w
+  end;
+
   procedure checkbnds(fsp: stp);
     var lmin,lmax: integer;
-        fsp2: stp;
+        fsp2: stp; w: boolean;
   begin
     if fsp <> nil then begin
       { if set use the base type for the check }
-      fsp2 := fsp;
+      fsp2 := fsp; w := wrdset(fsp);
       if fsp^.form = power then fsp := fsp^.elset;
       if fsp <> nil then
         if fsp <> intptr then
@@ -3505,7 +4552,11 @@ end;
             if fsp^.form <= subrange then
               begin
                 getbounds(fsp,lmin,lmax);
-                gen2t(45(*chk*),lmin,lmax,fsp2)
+                if w then begin { check word set as full set }
+                  gen1(129(*swf*),0); gen2t(45(*chk*),lmin,lmax,setptr);
+                  gen0(130(*sfw*))
+                end else if not lrgset(fsp2) then { large sets are not checked }
+                  gen2t(45(*chk*),lmin,lmax,fsp2)
               end
     end
   end (*checkbnds*);
@@ -3531,6 +4582,8 @@ end;
     else containerbase := bp^.size
   end;
     
+  procedure loadaddress; forward;
+
   procedure load;
   begin
     with gattr do
@@ -3555,7 +4608,9 @@ end;
                          else
                            gen2(51(*ldc*),5,cstptrix)
                        end;
-            varbl: case access of
+            varbl: if lrgset(typtr) then begin { copy large set from address }
+                     loadaddress; genlgs(0(*lod*),typtr^.size)
+                   end else case access of
                      drct:   if vlevel<=1 then begin
                                if (chkext(symptr) or chkfix(symptr)) and 
                                   (dplmt <> 0) then begin
@@ -3572,7 +4627,7 @@ end;
                                end
                              end else gen2t(54(*lod*),level-vlevel,dplmt,typtr);
                      indrct: gen1t(35(*ind*),idplmt,typtr);
-                     inxd:   error(400)
+                     inxd:   genbfd(0(*lod*),bwid)
                    end;
             expr:
           end;
@@ -3583,6 +4638,58 @@ end;
           symptr := nil { break variable association }
         end
   end (*load*) ;
+
+  { load set, a constant being loaded as a word if sets of fsp are words and
+    it fits }
+  procedure loadset(fsp: stp);
+  begin
+    if gattr.typtr <> nil then
+      if (gattr.kind = cst) and (gattr.typtr^.form = power) and wrdset(fsp) then
+        begin
+          if wrdcst(gattr.cval.valp) and comptypes(fsp,gattr.typtr) then begin
+            gen2(51(*ldc*),1,cstwrd(gattr.cval.valp));
+            gattr.typtr := fsp; gattr.kind := expr
+          end else load
+        end
+      else load
+  end;
+
+  { load set and convert it to the representation of sets of fsp }
+  procedure setrep(fsp: stp);
+  begin loadset(fsp);
+    if gattr.typtr <> nil then
+      if (gattr.typtr^.form = power) and (fsp^.size <> gattr.typtr^.size) then
+        if comptypes(fsp,gattr.typtr) then begin
+          setcvt(gattr.typtr^.size,fsp^.size,0);
+          gattr.typtr := fsp
+        end
+  end;
+
+  { bring set operands to the same representation. The smaller set is 
+    widened to the other, except that a constructor on the left that was
+    built as a sparse set, not knowing the right, is narrowed to the 
+    right, or to the smallest large set if the right is not large. An 
+    element of it the right cannot hold is then out of range }
+  procedure setmix(var fattr: attr);
+    var lsz, rsz, nsz: addrrange;
+  begin
+    if (fattr.typtr <> nil) and (gattr.typtr <> nil) then
+      if (fattr.typtr^.form = power) and (gattr.typtr^.form = power) then
+        begin lsz := fattr.typtr^.size; rsz := gattr.typtr^.size;
+          if lsz <> rsz then
+            if comptypes(fattr.typtr,gattr.typtr) then
+              if lsz < rsz then begin 
+                setcvt(lsz,rsz,rsz); fattr.typtr := gattr.typtr
+              end else if fattr.typtr^.widset then begin
+                nsz := rsz; if nsz <= setsize then nsz := lsetsz(sethigh+1);
+                setcvt(lsz,nsz,rsz); fattr.typtr^.size := nsz; 
+                fattr.typtr^.widset := false;
+                if rsz < nsz then 
+                  begin setcvt(rsz,nsz,0); gattr.typtr := fattr.typtr end
+                else fattr.typtr := gattr.typtr
+              end else begin setcvt(rsz,lsz,0); gattr.typtr := fattr.typtr end
+        end
+  end;
   
   procedure loadaddress;
   begin
@@ -3611,7 +4718,7 @@ end;
                              end else gen2(50(*lda*),level-vlevel,dplmt);
                      indrct: if idplmt <> 0 then
                                gen1t(34(*inc*),idplmt,nilptr);
-                     inxd:   error(404)
+                     inxd:   error(287) { bit elements have no address }
                    end;
             expr:  error(405);
           end;
@@ -3637,6 +4744,7 @@ end;
           drct:   if vlevel <= 1 then gen1ts(43(*sro*),dplmt,typtr,symptr)
                   else gen2t(56(*str*),level-vlevel,dplmt,typtr);
           indrct: if idplmt <> 0 then error(401)
+                  else if lrgset(typtr) then genlgs(1(*sto*),typtr^.size)
                   else if typtr^.form in [records,arrays] then begin
                     lsize := typtr^.size;
                     alignu(parmptr,lsize);
@@ -3644,7 +4752,7 @@ end;
                     mesl(adrsize+lsize)
                   end else 
                     gen0t(26(*sto*),typtr);
-          inxd:   error(402)
+          inxd:   genbfd(1(*sto*),bwid)
         end
   end (*store*) ;
   
@@ -3971,7 +5079,12 @@ end;
                           lattr.packing or gattr.typtr^.packing;
                         lsize := gattr.typtr^.size; { get base size }
                         cc := containers(lattr.typtr);
-                        if lattr.typtr^.form = arrays then gen1(36(*ixa*),lsize)
+                        if bitwid(lattr.typtr) > 0 then begin
+                          { bit element, leave the index for the access }
+                          gattr.access := inxd;
+                          gattr.bwid := bitwid(lattr.typtr)
+                        end else if lattr.typtr^.form = arrays then 
+                          gen1(36(*ixa*),lsize)
                         else if cc = 1 then 
                           gen1(103(*cxs*),lsize) { simple container index }
                         else begin { complex container index }
@@ -4545,7 +5658,11 @@ end;
             end
           else error(116);
       if (gattr.typtr <> nil) and (lattr.typtr <> nil) then
-        gen2(62(*pck*),gattr.typtr^.size,lattr.typtr^.size)
+        if bitwid(gattr.typtr) > 0 then begin { pack to bit fields }
+          gen2(51(*ldc*),1,spana(gattr.typtr));
+          gen2(51(*ldc*),1,lattr.typtr^.size);
+          genbfd(2(*pck*),bitwid(gattr.typtr))
+        end else gen2(62(*pck*),gattr.typtr^.size,lattr.typtr^.size)
     end (*pack*) ;
 
     procedure unpackprocedure;
@@ -4582,7 +5699,11 @@ end;
       gen2(51(*ldc*),1,bs);
       gen0(15(*mpi*));
       if (lattr.typtr <> nil) and (lattr1.typtr <> nil) then
-        gen2(63(*upk*),lattr.typtr^.size,lattr1.typtr^.size)
+        if bitwid(lattr.typtr) > 0 then begin { unpack from bit fields }
+          gen2(51(*ldc*),1,spana(lattr.typtr));
+          gen2(51(*ldc*),1,lattr1.typtr^.size);
+          genbfd(3(*upk*),bitwid(lattr.typtr))
+        end else gen2(63(*upk*),lattr.typtr^.size,lattr1.typtr^.size)
     end (*unpack*) ;
 
     procedure newdisposeprocedure(disp: boolean);
@@ -4939,6 +6060,8 @@ end;
           locpar, llc: addrrange; varp: boolean; lsize: addrrange;
           frlab: integer; prcnt: integer; fcps: ctp; ovrl: boolean;
           test: boolean; match: boolean; e: boolean; mm: boolean;
+          inl: boolean; ilc: stkoff; ild: integer; tc: boolean;
+          sctx: addrrange;
     procedure cpy2adr;
       var lsize: addrrange;
     begin
@@ -4988,11 +6111,39 @@ end;
       end
     end;
     begin fcps := fcp; locpar := 0; genlabel(frlab); prcnt := 1; ovrl := fcp^.grpnxt <> nil;
+      { see if the routine code was kept to be inlined }
+      inl := false; ilc := lc; ild := 0;
+      if doinl and prcode and not option['q'] then
+        if not inherit and not ovrl then
+          if fcp^.pfkind = actual then inl := fcp^.pfinl <> nil;
+      if inl then begin
+        { make room for the routine's frame in ours. Its addresses run from
+          the lowest local up to the end of the function result }
+        lsize := 0;
+        if fcp^.klass = func then
+          begin lsize := fcp^.idtype^.size; alignu(parmptr,lsize) end;
+        lc := lc-(lsize-fcp^.pfilc); alignd(parmptr,lc);
+        if lc < lcinl then lcinl := lc;
+        ild := lc-fcp^.pfilc
+      end;
+      { at k2 and up, a call of the procedure from its own block can be made
+        a tail call, unless it is under a with, or passes anything that lives
+        in our frame, which is reused for the call. Unlike inlining, this is
+        kept under q, since the entry the call goes to clears the locals }
+      tc := false;
+      if doglob and prcode and not inl and not inherit and not ovrl then
+        if (fcp^.klass = proc) and (fcp^.pfkind = actual) then
+          if fcp^.pfattr = fpanone then
+            if display[top].occur = blck then tc := display[top].bname = fcp;
       with fcp^ do
         begin nxt := pflist; lkind := pfkind;
           { I don't know why these are dups, guess is a badly formed far call }
-          if pfkind = actual then begin { it's a system call }
-            if not externl then genmst(level-pflev,frlab)
+          if inl then { no mark for inlined code }
+          else if pfkind = actual then begin { it's a system call }
+            if not externl then
+              if pflight and (pfattr = fpanone) and not ovrl and not inherit
+                then genmsl(level-pflev,frlab)
+              else genmst(level-pflev,frlab)
           end else genmst(level-pflev,frlab) { its an indirect }
         end;
       if sy = lparent then
@@ -5031,7 +6182,7 @@ end;
             { match same thing for all procs/funcs }
             if nxt <> nil then lb := nxt^.klass in [proc,func];
             if lb then   (*pass function or procedure*)
-              begin
+              begin tc := false;
                 if sy <> ident then
                   begin error(2); skip(fsys + [comma,rparent]) end
                 else if nxt <> nil then
@@ -5058,7 +6209,12 @@ end;
               end (*if lb*)
             else
               begin varp := false;
+                { a set parameter sizes a set built for it }
+                sctx := setctx; setctx := 0;
+                if nxt <> nil then if nxt^.idtype <> nil then
+                  if nxt^.idtype^.form = power then setctx := nxt^.idtype^.size;
                 expression(fsys + [comma,rparent], varp);
+                setctx := sctx;
                 { find the appropriate overload }
                 match := false;
                 repeat
@@ -5082,7 +6238,9 @@ end;
                           begin
                             if (nxt^.vkind = actual) or (nxt^.part = ptview) then begin
                               if lsp^.form <= power then
-                                begin load;
+                                begin 
+                                  if lsp^.form = power then setrep(lsp) 
+                                  else load;
                                   if debug then checkbnds(lsp);
                                   if comptypes(realptr,lsp)
                                      and (gattr.typtr = intptr) then
@@ -5091,9 +6249,11 @@ end;
                                     end;
                                   locpar := locpar+lsp^.size;
                                   alignu(parmptr,locpar);
+                                  { place parameter in inlined frame }
+                                  if inl then gen2t(56(*str*),0,nxt^.vaddr+ild,lsp)
                                 end
                               else
-                                begin
+                                begin tc := false; { copied at entry }
                                   if gattr.kind = expr then cpy2adr
                                   else loadaddress; 
                                   fixpar(lsp,gattr.typtr);
@@ -5106,7 +6266,16 @@ end;
                                   if not e then error(142)
                             end else begin
                               if gattr.kind = varbl then
-                                begin if gattr.packcom then error(197);
+                                begin
+                                  { only outer variables and our own VAR
+                                    parameters are left by a tail call }
+                                  if gattr.symptr = nil then tc := false
+                                  else if gattr.symptr^.klass = vars then
+                                    if gattr.symptr^.vlev = level then
+                                      if (gattr.symptr^.vkind = actual) or
+                                         (gattr.symptr^.part = ptview) then
+                                        tc := false;
+                                  if gattr.packcom then error(197);
                                   if gattr.tagfield then error(198);
                                   if gattr.kind = expr then cpy2adr
                                   else loadaddress; 
@@ -5115,6 +6284,8 @@ end;
                                     locpar := locpar+ptrsize*2
                                   else locpar := locpar+ptrsize;
                                   alignu(parmptr,locpar);
+                                  if inl then 
+                                    gen2t(56(*str*),0,nxt^.vaddr+ild,nilptr)
                                 end
                               else error(154);
                               if lsp <> gattr.typtr then 
@@ -5141,7 +6312,8 @@ end;
           lsize := fcp^.idtype^.size;
           alignu(parmptr,lsize);
       end;
-      if prcode then begin prtlabel(frlab); writeln(prr,'=',lsize:1) end;
+      if prcode and not inl then 
+        begin prtlabel(frlab); writeln(prr,'=',lsize:1) end;
       if lkind = actual then
         begin if nxt <> nil then if ovrl then error(275) else error(126);
           with fcp^ do
@@ -5157,9 +6329,14 @@ end;
                   end else gen1s(91(*cuv*),fcp^.pfvid^.vaddr,fcp^.pfvid)
                 end else begin
                   if inherit then error(234);
-                  gencupent(46(*cup*),locpar,pfname,fcp)
+                  if inl then begin
+                    geninl(pfinl,ild);
+                    { get function result }
+                    if klass = func then gen2t(54(*lod*),0,ild,idtype)
+                  end else if tc then gencupent(122(*cut*),locpar,pfname,fcp)
+                  else gencupent(46(*cup*),locpar,pfname,fcp)
                 end;
-                mesl(-lsize)
+                if not inl then mesl(-lsize)
               end
             end
         end
@@ -5169,6 +6346,7 @@ end;
         mesl(locpar); { remove stack parameters }
         mesl(-lsize)
       end;
+      lc := ilc; { release inlined frame }
       gattr.typtr := fcp^.idtype;
       { clean any copyback buffers out of list }
       nxt := fcp^.pflist;
@@ -5338,6 +6516,7 @@ end;
   
   procedure expression{(fsys: setofsys; threaten: boolean)};
     var lattr: attr; lop: operatort; typind: char; lsize: addrrange; fcp: ctp;
+        inw: boolean;
 
     procedure simpleexpression(fsys: setofsys; threaten: boolean);
       var lattr: attr; lop: operatort; fsy: symbol; fop: operatort; fcp: ctp;
@@ -5348,6 +6527,100 @@ end;
         procedure factor(fsys: setofsys; threaten: boolean);
           var lcp,fcp: ctp; lvp: csp; varpart: boolean; inherit: boolean;
               cstpart: setty; lsp: stp; tattr, rattr: attr; test: boolean;
+              csz, lsz, lctx: addrrange;
+
+        { check elements of type can be above the largest set sized from a
+          type, as integers are }
+        function widelt(fsp: stp): boolean;
+        var lmin, lmax: integer;
+        begin widelt := false;
+          if fsp = intptr then widelt := true
+          else if fsp <> nil then
+            if fsp^.form <= subrange then 
+              begin getbounds(fsp,lmin,lmax); widelt := lmax > lsethigh end
+        end;
+
+        { find size of set an element needs, from its value if constant,
+          otherwise from its type. An element that may not fit a full set is
+          built in the large set the constructor is used with. If the set it
+          is used with is not known yet, as for the left operand of an
+          operator, an element that can be anything builds a sparse set,
+          and the operator narrows that to the other operand }
+        function eltsz(var fattr: attr): addrrange;
+        var esz: addrrange;
+        begin eltsz := setsize;
+          if fattr.kind = cst then begin
+            if fattr.cval.intval then
+              if (fattr.cval.ival >= setlow) and 
+                 (fattr.cval.ival <= wsethigh) then eltsz := intsize
+              else if (fattr.cval.ival > sethigh) and 
+                      (fattr.cval.ival <= lsethigh) then 
+                eltsz := lsetsz(fattr.cval.ival)
+              else if fattr.cval.ival > lsethigh then eltsz := spssz
+          end else begin esz := setsz(fattr.typtr);
+            if (esz = setsize) or sprsz(esz) then
+              if lctx > setsize then esz := lctx
+              else if lctx = 0 then begin
+                if widelt(fattr.typtr) then esz := spssz
+              end else esz := setsize;
+            eltsz := esz
+          end
+        end;
+
+        { find the size the constructor is built in. The first variable
+          element sets it, and a later element that needs a larger set
+          widens the set built so far, which is under that element's q 
+          bytes }
+        procedure setmode(esz, q: addrrange);
+        begin
+          if not varpart then csz := esz
+          else if esz > csz then begin setcvt(csz,esz,q); csz := esz end
+        end;
+
+        { join element set to the set built so far }
+        procedure setuni;
+        begin
+          if varpart then begin
+            if csz < setsize then gen0(13(*ior*))
+            else if csz = setsize then gen0(28(*uni*))
+            else genlgs(2(*uni*),csz)
+          end else varpart := true
+        end;
+
+        { add single variable element }
+        procedure sngelt;
+        begin load;
+          if not comptypes(gattr.typtr,intptr)
+          then gen0t(58(*ord*),gattr.typtr);
+          setmode(lsz,intsize);
+          if csz < setsize then gen0(123(*sgw*))
+          else if csz = setsize then gen0(23(*sgs*))
+          else genlgs(9(*sgs*),csz);
+          setuni
+        end;
+
+        { add variable range of elements, the low side in gattr and the high
+          in rattr }
+        procedure rngelt;
+        begin
+          if gattr.kind = cst then begin
+            load;
+            if not comptypes(gattr.typtr,intptr)
+              then gen0t(58(*ord*),gattr.typtr)
+          end;
+          if eltsz(rattr) > lsz then lsz := eltsz(rattr);
+          tattr := gattr; gattr := rattr;
+          load;
+          gattr := tattr;
+          if not comptypes(rattr.typtr,intptr)
+          then gen0t(58(*ord*),rattr.typtr);
+          setmode(lsz,intsize*2);
+          if csz < setsize then gen0(124(*rgw*))
+          else if csz = setsize then gen0(64(*rgs*))
+          else genlgs(10(*rgs*),csz);
+          setuni
+        end;
+
         begin
           if not (sy in facbegsys) then
             begin error(58); skip(fsys + facbegsys);
@@ -5437,7 +6710,7 @@ end;
                       begin
                         if lgth = 1 then typtr := charptr
                         else
-                          begin new(lsp,arrays); pshstc(lsp);
+                          begin getstc(lsp); pshstc(lsp);
                             with lsp^ do
                               begin form:=arrays; aeltype := charptr; 
                                 packing := true; inxtype := nil; tmpl := -1; 
@@ -5469,10 +6742,12 @@ end;
                   end;
         (*[*)     lbrack:
                   begin insymbol; cstpart := [ ]; varpart := false;
-                    new(lsp,power); pshstc(lsp);
+                    csz := setsize; lctx := setctx; setctx := 0;
+                    getstc(lsp); pshstc(lsp);
                     with lsp^ do
                       begin form:=power; elset:=nil;size:=setsize;
-                            packing := false; matchpack := false end;
+                            packing := false; matchpack := false; 
+                            widset := false end;
                     if sy = rbrack then
                       begin
                         with gattr do
@@ -5483,7 +6758,7 @@ end;
                       begin
                         repeat
                           expression(fsys + [comma,range,rbrack], false);
-                          rattr.typtr := nil;
+                          rattr.typtr := nil; lsz := eltsz(gattr);
                           if sy = range then begin insymbol;
                             { if the left side is not constant, load it
                               and coerce it to integer now }
@@ -5517,46 +6792,25 @@ end;
                                           if (gattr.kind = cst) and
                                              (rattr.kind = cst) then
                                             if (rattr.cval.ival < setlow) or
-                                               (rattr.cval.ival > sethigh) or
-                                               (gattr.cval.ival < setlow) or
-                                               (gattr.cval.ival > sethigh) then
+                                               (gattr.cval.ival < setlow) then
                                               error(304)
-                                            else
+                                            else if (rattr.cval.ival <= sethigh) 
+                                                    and (gattr.cval.ival <= 
+                                                         sethigh) then
                                               cstpart := cstpart+
                                                 [gattr.cval.ival..rattr.cval.ival]
-                                          else
-                                            begin
-                                              if gattr.kind = cst then begin
-                                                load;
-                                                if not comptypes(gattr.typtr,intptr)
-                                                  then gen0t(58(*ord*),gattr.typtr)
-                                              end;
-                                              tattr := gattr; gattr := rattr;
-                                              load;
-                                              gattr := tattr;
-                                              if not comptypes(rattr.typtr,intptr)
-                                              then gen0t(58(*ord*),rattr.typtr);
-                                              gen0(64(*rgs*));
-                                              if varpart then gen0(28(*uni*))
-                                              else varpart := true
-                                            end
+                                            else rngelt { large constant }
+                                          else rngelt
                                         end
                                       else error(137)
                                   end else begin
                                     if gattr.kind = cst then
-                                      if (gattr.cval.ival < setlow) or
-                                        (gattr.cval.ival > sethigh) then
+                                      if gattr.cval.ival < setlow then
                                         error(304)
-                                      else
+                                      else if gattr.cval.ival <= sethigh then
                                         cstpart := cstpart+[gattr.cval.ival]
-                                    else
-                                      begin load;
-                                        if not comptypes(gattr.typtr,intptr)
-                                        then gen0t(58(*ord*),gattr.typtr);
-                                        gen0(23(*sgs*));
-                                        if varpart then gen0(28(*uni*))
-                                        else varpart := true
-                                      end
+                                      else sngelt { large constant }
+                                    else sngelt
                                   end;
                                   lsp^.elset := gattr.typtr;
                                   gattr.typtr := lsp
@@ -5570,20 +6824,31 @@ end;
                     if varpart then
                       begin
                         if cstpart <> [ ] then
-                          begin new(lvp,pset); pshcst(lvp);
+                          begin getcst(lvp); pshcst(lvp);
                             lvp^.pval := cstpart;
                             lvp^.cclass := pset;
-                            if cstptrix = cstoccmax then error(254)
+                            if csz < setsize then if not wrdcst(lvp) then
+                              begin setcvt(csz,setsize,0); csz := setsize end;
+                            if csz < setsize then
+                              begin gen2(51(*ldc*),1,cstwrd(lvp));
+                                gen0(13(*ior*)); gattr.kind := expr
+                              end
+                            else if cstptrix = cstoccmax then error(254)
                             else
                               begin cstptrix := cstptrix + 1;
                                 cstptr[cstptrix] := lvp;
                                 gen2(51(*ldc*),5,cstptrix);
-                                gen0(28(*uni*)); gattr.kind := expr
+                                if csz > setsize then begin
+                                  setcvt(setsize,csz,0); genlgs(2(*uni*),csz)
+                                end else gen0(28(*uni*)); 
+                                gattr.kind := expr
                               end
-                          end
+                          end;
+                        lsp^.size := csz;
+                        lsp^.widset := (lctx = 0) and sprsz(csz)
                       end
                     else
-                      begin new(lvp,pset); pshcst(lvp);
+                      begin getcst(lvp); pshcst(lvp);
                         lvp^.cclass := pset;
                         lvp^.pval := cstpart;
                         gattr.cval.intval := false;
@@ -5610,10 +6875,14 @@ end;
               if gattr.typtr <> nil then 
                 if gattr.typtr^.form <= power then load else loadaddress;
             lattr := gattr; lop := op;
-            insymbol; factor(fsys + [mulop], threaten); 
+            setctx := 0;
+            if lattr.typtr <> nil then
+              if lattr.typtr^.form = power then setctx := lattr.typtr^.size;
+            insymbol; factor(fsys + [mulop], threaten); setctx := 0;
             if gattr.kind <> expr then
               if gattr.typtr <> nil then 
-                if gattr.typtr^.form <= power then load else loadaddress;
+                if sett(lattr.typtr) then loadset(lattr.typtr)
+                else if gattr.typtr^.form <= power then load else loadaddress;
             if (lattr.typtr <> nil) and (gattr.typtr <> nil) then
               case lop of
       (***)     mul: begin fndopr2(lop, lattr, fcp);
@@ -5636,7 +6905,12 @@ end;
                                (gattr.typtr=realptr) then gen0(16(*mpr*))
                             else if (lattr.typtr^.form=power) and 
                                     comptypes(lattr.typtr,gattr.typtr) then
-                              gen0(12(*int*))
+                              begin setmix(lattr);
+                                if wrdset(gattr.typtr) then gen0(4(*and*))
+                                else if lrgset(gattr.typtr) then
+                                  genlgs(3(*int*),gattr.typtr^.size)
+                                else gen0(12(*int*))
+                              end
                             else begin error(134); gattr.typtr:=nil end
                           end
                   end
@@ -5708,10 +6982,14 @@ end;
             if gattr.typtr <> nil then 
               if gattr.typtr^.form <= power then load else loadaddress; 
           lattr := gattr; lop := op;
-          insymbol; term(fsys + [addop], threaten);
+          setctx := 0;
+          if lattr.typtr <> nil then
+            if lattr.typtr^.form = power then setctx := lattr.typtr^.size;
+          insymbol; term(fsys + [addop], threaten); setctx := 0;
           if gattr.kind <> expr then
             if gattr.typtr <> nil then 
-              if gattr.typtr^.form <= power then load else loadaddress; 
+              if sett(lattr.typtr) then loadset(lattr.typtr)
+              else if gattr.typtr^.form <= power then load else loadaddress; 
           if (lattr.typtr <> nil) and (gattr.typtr <> nil) then
             case lop of
     (*+,-*)    plus,minus: begin fndopr2(lop, lattr, fcp);
@@ -5734,7 +7012,15 @@ end;
                        if lop = plus then gen0(3(*adr*)) else gen0(22(*sbr*))
                      end else if (lattr.typtr^.form=power) and
                                  comptypes(lattr.typtr,gattr.typtr) then begin
-                       if lop = plus then gen0(28(*uni*)) else gen0(5(*dif*))
+                       setmix(lattr);
+                       if wrdset(gattr.typtr) then begin
+                         if lop = plus then gen0(13(*ior*)) 
+                         else gen0(126(*dfw*))
+                       end else if lrgset(gattr.typtr) then begin
+                         if lop = plus then genlgs(2(*uni*),gattr.typtr^.size)
+                         else genlgs(4(*dif*),gattr.typtr^.size)
+                       end else
+                         if lop = plus then gen0(28(*uni*)) else gen0(5(*dif*))
                      end else begin error(134); gattr.typtr:=nil end
                    end
                  end
@@ -5753,7 +7039,7 @@ end;
         end (*while*)
     end (*simpleexpression*) ;
 
-  begin (*expression*)
+  begin (*expression*) inw := false;
     simpleexpression(fsys + [relop], threaten);
     if sy = relop then begin
       if gattr.typtr <> nil then
@@ -5763,17 +7049,45 @@ end;
       if lop = inop then
         if not comptypes(gattr.typtr,intptr) then
           gen0t(58(*ord*),gattr.typtr);
-      insymbol; simpleexpression(fsys, threaten);
+      { the set of in is sized from its element, other sets from the left }
+      if lop = inop then setctx := setsz(lattr.typtr)
+      else begin setctx := 0;
+        if lattr.typtr <> nil then
+          if lattr.typtr^.form = power then setctx := lattr.typtr^.size
+      end;
+      insymbol; simpleexpression(fsys, threaten); setctx := 0;
       if gattr.typtr <> nil then
-        if gattr.typtr^.form <= power then load
+        if lop = inop then begin
+          { a constant set that fits is tested as a word }
+          if gattr.kind = cst then
+            if gattr.typtr^.form = power then
+              if wrdcst(gattr.cval.valp) then begin
+                gen2(51(*ldc*),1,cstwrd(gattr.cval.valp)); 
+                gattr.kind := expr; inw := true
+              end;
+          { a large set variable is tested in place }
+          if gattr.kind = varbl then 
+            if lrgset(gattr.typtr) then loadaddress;
+          if gattr.kind = cst then load
+          else if gattr.kind = varbl then 
+            if not lrgset(gattr.typtr) then load;
+          if gattr.typtr^.form = power then
+            if wrdset(gattr.typtr) then inw := true 
+        end else if sett(lattr.typtr) then loadset(lattr.typtr)
+        else if gattr.typtr^.form <= power then load
         else loadaddress;
       if (lattr.typtr <> nil) and (gattr.typtr <> nil) then begin
         fndopr2(lop, lattr, fcp);
         if fcp <> nil then callop2(fcp, lattr) else begin
           if lop = inop then
             if gattr.typtr^.form = power then
-              if comptypes(lattr.typtr,gattr.typtr^.elset) then
-                gen0(11(*inn*))
+              if comptypes(lattr.typtr,gattr.typtr^.elset) then begin
+                if inw then gen0(125(*inw*)) 
+                else if lrgset(gattr.typtr) then begin
+                  if gattr.kind = varbl then genlgs(15(*ina*),gattr.typtr^.size)
+                  else genlgs(11(*inn*),gattr.typtr^.size)
+                end else gen0(11(*inn*))
+              end
               else begin error(129); gattr.typtr := nil end
             else begin error(130); gattr.typtr := nil end
           else
@@ -5807,7 +7121,20 @@ end;
                       end;
                     power: 
                       begin if lop in [ltop,gtop] then error(132);
-                        typind := 's'
+                        setmix(lattr); lsize := lattr.typtr^.size;
+                        if wrdset(lattr.typtr) then begin
+                          typind := 'i';
+                          { inclusion on words has its own operators }
+                          if lop = leop then 
+                            begin gen0(127(*lew*)); typind := ' ' end
+                          else if lop = geop then 
+                            begin gen0(128(*gew*)); typind := ' ' end
+                        end else if lrgset(lattr.typtr) then begin
+                          if lop = eqop then genlgs(5(*equ*),lsize)
+                          else if lop = neop then genlgs(6(*neq*),lsize)
+                          else if lop = leop then genlgs(7(*leq*),lsize)
+                          else if lop = geop then genlgs(8(*geq*),lsize)
+                        end else typind := 's'
                       end;
                     arrays, arrayc:
                       begin
@@ -5845,7 +7172,7 @@ end;
   procedure body(fsys: setofsys; fprocp: ctp); forward;
 
   procedure declare(fsys: setofsys);
-    var lsy: symbol;
+    var lsy: symbol; oph: phase;
 
     { resolve all pointer references in the forward list }
     procedure resolvep;
@@ -5888,7 +7215,7 @@ end;
             if sy = lparent then
               begin ttop := top;   (*decl. consts local to innermost block*)
                 while display[top].occur <> blck do top := top - 1;
-                new(lsp,scalar,declared); pshstc(lsp);
+                getstc(lsp); pshstc(lsp);
                 with lsp^ do
                   begin form := scalar; size := intsize; scalkind := declared; 
                     packing := false
@@ -5896,7 +7223,7 @@ end;
                 lcp1 := nil; lcnt := 0;
                 repeat insymbol;
                   if sy = ident then
-                    begin new(lcp,konst); ininam(lcp);
+                    begin getnam(lcp); ininam(lcp);
                       with lcp^ do
                         begin klass := konst; strassvf(name, id); idtype := lsp;
                           next := lcp1; values.intval := true; 
@@ -5922,7 +7249,7 @@ end;
                   begin searchid([types,konst],lcp);
                     insymbol;
                     if lcp^.klass = konst then
-                      begin new(lsp,subrange); pshstc(lsp);
+                      begin getstc(lsp); pshstc(lsp);
                         with lsp^, lcp^ do
                           begin form := subrange; rangetype := idtype; 
                             if stringt(rangetype) then
@@ -5948,7 +7275,7 @@ end;
                       end
                   end (*sy = ident*)
                 else
-                  begin new(lsp,subrange); pshstc(lsp);
+                  begin getstc(lsp); pshstc(lsp);
                     lsp^.form := subrange; lsp^.packing := false;
                     constexpr(fsys + [range],lsp1,lvalu);
                     if stringt(lsp1) then
@@ -6001,7 +7328,7 @@ end;
           begin nxt := nxt1;
             repeat
               if sy = ident then
-                begin new(lcp,field); ininam(lcp); 
+                begin getnam(lcp); ininam(lcp); 
                   if fstlab = nil then fstlab := lcp;
                   with lcp^ do
                     begin klass := field; strassvf(name, id); idtype := nil;
@@ -6041,7 +7368,7 @@ end;
           with nxt1^ do
             begin lcp := next; next := nxt; nxt := nxt1; nxt1 := lcp end;
         if sy = casesy then
-          begin new(lsp,tagfld); pshstc(lsp);
+          begin getstc(lsp); pshstc(lsp);
             with lsp^ do
               begin form := tagfld; tagfieldp := nil; fstvar := nil;  
                     packing := false; new(vart); 
@@ -6055,7 +7382,7 @@ end;
                 { find possible type first }
                 searchidnenm([types],lcp1,mm);
                 { now set up as field id }
-                new(lcp,field); ininam(lcp);
+                getnam(lcp); ininam(lcp);
                 with lcp^ do
                   begin klass:=field; strassvf(name, id); idtype := nil; 
                     next := nil; fldaddr := displ; varnt := vartyp;
@@ -6115,7 +7442,7 @@ end;
                     begin rvalu.intval := true; rvalu.ival := 1 end;
                   if lvalu.ival > rvalu.ival then error(225);
                   repeat { case range }
-                    new(lsp3,variant); pshstc(lsp3); 
+                    getstc(lsp3); pshstc(lsp3); 
                     with lsp3^ do
                       begin form := variant; varln := varlnm; 
                             nxtvar := lsp1; subvar := lsp2; varval := lvalu;
@@ -6195,14 +7522,14 @@ end;
           if sy in simptypebegsys then simpletype(fsys,fsp,fsize)
           else
     (*^*)     if sy = arrow then
-              begin new(lsp,pointer); pshstc(lsp); fsp := lsp;
+              begin getstc(lsp); pshstc(lsp); fsp := lsp;
                 with lsp^ do
                   begin form:=pointer; eltype := nil; size := ptrsize;  
                         packing := false end;
                 insymbol;
                 if sy = ident then
                   begin { forward reference everything }
-                    new(lcp,types); ininam(lcp);
+                    getnam(lcp); ininam(lcp);
                     with lcp^ do
                       begin klass := types; strassvf(name,id); idtype := lsp;
                         next := fwptr; 
@@ -6228,7 +7555,7 @@ end;
                     if (sy = ofsy) and not iso7185 then begin
                       lsp1 := nil;
                       { process container array }
-                      new(lsp,arrayc); pshstc(lsp);
+                      getstc(lsp); pshstc(lsp);
                       with lsp^ do
                           begin form:=arrayc; abstype := lsp1; 
                                 packing := ispacked end;
@@ -6236,7 +7563,7 @@ end;
                     end else if (sy <> lbrack) and not iso7185 then begin
                       { process Pascaline array }
                       lsp1 := nil;
-                      repeat new(lsp,arrays); pshstc(lsp);
+                      repeat getstc(lsp); pshstc(lsp);
                         with lsp^ do
                           begin form:=arrays; aeltype := lsp1; inxtype := nil; 
                                 tmpl := -1; packing := ispacked end;
@@ -6249,7 +7576,7 @@ end;
                           begin error(238); lvalu.ival := 1 end;
                         lsp1^.size := lsize;
                         { build subrange type based on 1..n }
-                        new(lsp2,subrange); pshstc(lsp2);
+                        getstc(lsp2); pshstc(lsp2);
                           with lsp2^ do
                             begin form := subrange; rangetype := intptr; 
                                   min.ival := 1; max := lvalu end;
@@ -6260,7 +7587,7 @@ end;
                     end else begin if sy = lbrack then insymbol;
                       { process ISO 7185 array }
                       lsp1 := nil;
-                      repeat new(lsp,arrays); pshstc(lsp);
+                      repeat getstc(lsp); pshstc(lsp);
                         with lsp^ do
                           begin form:=arrays; aeltype := lsp1; inxtype := nil; 
                                 tmpl := -1; packing := ispacked end;
@@ -6296,6 +7623,8 @@ end;
                             if span < 1 then error(509);
                             if lsize > pmmaxint div span then 
                               begin error(237); lsize := 1 end
+                            else if bitwid(lsp1) > 0 then
+                              lsize := (span*bitwid(lsp1)+7) div 8
                             else lsize := lsize*span;
                             size := lsize
                           end;
@@ -6318,7 +7647,7 @@ end;
                       else error(250);
                       displ := 0;
                       fieldlist(fsys-[semicolon]+[endsy],lsp1,nil,nil,1,lcp);
-                      new(lsp,records);
+                      getstc(lsp);
                       with lsp^ do
                         begin form := records; fstfld := display[top].fname;
                           display[top].fname := nil;
@@ -6347,13 +7676,16 @@ end;
                               begin error(169); lsp1 := nil end
                             else
                               begin getbounds(lsp1,lmin,lmax);
-                                if (lmin < setlow) or (lmax > sethigh)
-                                  then error(169);
+                                if lmin < setlow then error(169)
                               end;
-                        new(lsp,power); pshstc(lsp);
+                        getstc(lsp); pshstc(lsp);
                         with lsp^ do
                           begin form:=power; elset:=lsp1; size:=setsize; 
-                                packing := ispacked; matchpack := true end;
+                                packing := ispacked; matchpack := true; 
+                                widset := false end;
+                        { small sets fit a word, large ones are sized to
+                          the base type, and wider ones are sparse }
+                        lsp^.size := setsz(lsp1);
                       end
                     else
     (*file*)        if sy = filesy then
@@ -6361,7 +7693,7 @@ end;
                             if sy = ofsy then insymbol else error(8);
                             typ(fsys,lsp1,lsize);
                             if filecomponent(lsp1) then error(190);
-                            new(lsp,files); pshstc(lsp);
+                            getstc(lsp); pshstc(lsp);
                             with lsp^ do
                               begin form := files; filtype := lsp1; 
                                  size := filesize+lsize; packing := ispacked
@@ -6403,7 +7735,7 @@ end;
       if sy <> ident then
         begin error(2); skip(fsys + [ident]) end;
       while sy = ident do
-        begin new(lcp,konst); ininam(lcp);
+        begin getnam(lcp); ininam(lcp);
           with lcp^ do
             begin klass:=konst; strassvf(name, id); idtype := nil; next := nil; 
               refer := false
@@ -6428,7 +7760,7 @@ end;
       if sy <> ident then
         begin error(2); skip(fsys + [ident]) end;
       while sy = ident do
-        begin new(lcp,types); ininam(lcp);
+        begin getnam(lcp); ininam(lcp);
           with lcp^ do
             begin klass := types; strassvf(name, id); idtype := nil; 
               refer := false
@@ -6544,8 +7876,21 @@ end;
                      the actual type }
                    if fi > 0 then wrtint(fi) else wrttypsub(eltype) 
                  end;
-        power: begin wrtchr('s'); wrttypsub(elset) end;
-        arrays: begin wrtchr('a'); wrttypsub(inxtype); wrttypsub(aeltype) end;
+        { word sets are 'w', large sets 'l' and sparse sets 'z', both with
+          their size in bytes }
+        power: if wrdset(tp) then begin wrtchr('w'); wrttypsub(elset) end
+               else if sprset(tp) then
+                 begin wrtchr('z'); wrtint(size); wrttypsub(elset) end
+               else if lrgset(tp) then 
+                 begin wrtchr('l'); wrtint(size); wrttypsub(elset) end
+               else begin wrtchr('s'); wrttypsub(elset) end;
+        { arrays held as bit fields are 'k' and the width of the fields }
+        arrays: if bitwid(tp) > 0 then begin 
+                  wrtchr('k'); wrtint(bitwid(tp)); wrttypsub(inxtype); 
+                  wrttypsub(aeltype) 
+                end else begin 
+                  wrtchr('a'); wrttypsub(inxtype); wrttypsub(aeltype) 
+                end;
         arrayc: begin wrtchr('v'); wrttypsub(abstype) end;
         records: begin wrtchr('r'); wrtchr('('); wrtrfd(fstfld); 
                    if recvar <> nil then if recvar^.form = tagfld then
@@ -6577,15 +7922,42 @@ end;
     end;
     
     procedure vardeclaration;
-      var lcp,nxt: ctp; lsp: stp; lsize: addrrange;
+      var lcp,nxt,pnd: ctp; lsp: stp; lsize: addrrange;
           test: boolean; maxpar, curpar: integer; cc: integer;
-    begin nxt := nil;
+
+      { place the held locals, largest alignment first so that padding is 
+        least }
+      procedure placelcl;
+        var lcp,lcp1: ctp; al: integer; lsize: addrrange;
+      begin
+        while pnd <> nil do begin
+          { find the largest alignment held }
+          al := 1; lcp := pnd;
+          while lcp <> nil do begin
+            if alignquot(lcp^.idtype) > al then al := alignquot(lcp^.idtype);
+            lcp := lcp^.next
+          end;
+          { place those, and hold the rest again }
+          lcp := pnd; pnd := nil;
+          while lcp <> nil do begin lcp1 := lcp^.next;
+            if alignquot(lcp^.idtype) = al then begin
+              lsize := 1; if lcp^.idtype <> nil then lsize := lcp^.idtype^.size;
+              lc := lc - lsize; alignd(lcp^.idtype,lc); lcp^.vaddr := lc;
+              lcp^.next := nil;
+              if prcode then wrtsym(lcp, 'l')
+            end else begin lcp^.next := pnd; pnd := lcp end;
+            lcp := lcp1
+          end
+        end
+      end;
+
+    begin nxt := nil; pnd := nil;
       repeat { id:type group }
         maxpar := 0;
         repeat {ids }
           lcp := nil;
           if sy = ident then
-            begin new(lcp,vars); ininam(lcp); curpar := 0;
+            begin getnam(lcp); ininam(lcp); curpar := 0;
               with lcp^ do
                begin klass := vars; strassvf(name, id); next := nxt; 
                   idtype := nil; vkind := actual; vlev := level;
@@ -6599,7 +7971,9 @@ end;
             end
           else error(2);
           if (sy = lparent) and not iso7185 then begin
-            { parameterized type specification }
+            { parameterized type specification, which can use the locals 
+              held }
+            placelcl;
             if nxt <> nil then begin { gen code strip label }
               lcp^.ininxt := display[top].inilst; display[top].inilst := lcp;
               genlabel(lcp^.inilab); putlabel(lcp^.inilab) 
@@ -6641,28 +8015,34 @@ end;
           with nxt^ do
             begin
               idtype := lsp; 
-              { globals are alloc/increment, locals are decrement/alloc }
-              if level <= 1 then 
-                begin alignu(lsp,gc); vaddr := gc; gc := gc + lsize end
-              else 
-                begin lc := lc - lsize; alignd(lsp,lc); vaddr := lc end;
-              { mark symbol }
-              if prcode then
-                if level <= 1 then wrtsym(nxt, 'g') else wrtsym(nxt, 'l');
-              nxt := next;
-              if maxpar > 0 then begin
-                { load variable address }
-                if level <= 1 then gen1(37(*lao*),vaddr)
-                else gen2(50(*lda*),level-vlev,vaddr);
+              if natal and (level > 1) and (maxpar = 0) then begin
+                { in natural layout, locals are held to be placed by 
+                  alignment }
+                lcp := next; next := pnd; pnd := nxt; nxt := lcp
+              end else begin
+                { globals are alloc/increment, locals are decrement/alloc }
                 if level <= 1 then 
-                  { issue vector init ptr instruction }
-                  gen2(97(*vip*),maxpar,containerbase(lsp)) 
+                  begin alignu(lsp,gc); vaddr := gc; gc := gc + lsize end
                 else 
-                  { issue vector init stack instruction }
-                  gen2(96(*vis*),maxpar,containerbase(lsp));
-                gen0(90(*ret*)); { issue code strip return }
-                { remove initializers, var addr }
-                mesl(maxpar*intsize+adrsize)
+                  begin lc := lc - lsize; alignd(lsp,lc); vaddr := lc end;
+                { mark symbol }
+                if prcode then
+                  if level <= 1 then wrtsym(nxt, 'g') else wrtsym(nxt, 'l');
+                nxt := next;
+                if maxpar > 0 then begin
+                  { load variable address }
+                  if level <= 1 then gen1(37(*lao*),vaddr)
+                  else gen2(50(*lda*),level-vlev,vaddr);
+                  if level <= 1 then 
+                    { issue vector init ptr instruction }
+                    gen2(97(*vip*),maxpar,containerbase(lsp)) 
+                  else 
+                    { issue vector init stack instruction }
+                    gen2(96(*vis*),maxpar,containerbase(lsp));
+                  gen0(90(*ret*)); { issue code strip return }
+                  { remove initializers, var addr }
+                  mesl(maxpar*intsize+adrsize)
+                end
               end
             end;
         if sy = semicolon then
@@ -6672,6 +8052,7 @@ end;
           end
         else error(14)
       until (sy <> ident) and not (sy in typedels);
+      placelcl;
       resolvep
     end (*vardeclaration*) ;
     
@@ -6679,8 +8060,8 @@ end;
       var lcp: ctp; lsp: stp; lsize: addrrange;
           test: boolean; v: integer; d: boolean; dummy: stp; fvalu: valu;
     procedure fixeditem(fsys: setofsys; lsp: stp; size: integer; var v: integer; var d: boolean);
-      var fvalu: valu; lsp1: stp; c:char; lcp: ctp; i, min, max: integer; 
-          test: boolean;
+      var fvalu: valu; lsp1: stp; c:char; lcp: ctp; i, j, w, min, max: integer; 
+          k, m, lmin, lmax: integer; test: boolean;
     begin v := 0; d := false;
       if lsp <> nil then begin
         case lsp^.form of
@@ -6733,12 +8114,39 @@ end;
                     end;
           power: begin { get value to satisfy entry }
                    constexpr(fsys,lsp1,fvalu);
-                   if comptypes(lsp, lsp1) then begin
-                     write(prr, 'c p (');
-                     for i := setlow to sethigh do 
-                       if i in fvalu.valp^.pval then write(prr,' ',i:1);
-                     writeln(prr, ')')
-                   end else error(245)
+                   if comptypes(lsp, lsp1) then 
+                     if wrdset(lsp) then begin { word set is an integer }
+                       if wrdcst(fvalu.valp) then 
+                         writeln(prr, 'c i ', cstwrd(fvalu.valp):1)
+                       else error(304)
+                     end else if sprset(lsp) then begin
+                       { sparse set is a count then elements, by words }
+                       j := 0;
+                       for i := setlow to sethigh do 
+                         if i in fvalu.valp^.pval then j := j+1;
+                       writeln(prr, 'c i ', j:1);
+                       for i := setlow to sethigh do 
+                         if i in fvalu.valp^.pval then 
+                           writeln(prr, 'c i ', i:1);
+                       for i := j+2 to lsp^.size div intsize do 
+                         writeln(prr, 'c i 0')
+                     end else if lrgset(lsp) then begin 
+                       { large set is a bitmap, output by bytes }
+                       for i := 0 to lsp^.size-1 do begin
+                         w := 0; 
+                         for j := 7 downto 0 do begin w := w*2;
+                           if i*8+j <= sethigh then
+                             if i*8+j in fvalu.valp^.pval then w := w+1
+                         end;
+                         writeln(prr, 'c x ', w:1)
+                       end
+                     end else begin
+                       write(prr, 'c p (');
+                       for i := setlow to sethigh do 
+                         if i in fvalu.valp^.pval then write(prr,' ',i:1);
+                       writeln(prr, ')')
+                     end 
+                   else error(245)
                  end;
           arrays: begin getbounds(lsp^.inxtype, min, max);
                     if (sy = stringconst) and stringt(lsp) then begin
@@ -6751,6 +8159,31 @@ end;
                         writev(prr, fvalu.valp^.sval, fvalu.valp^.slgth);
                         writeln(prr, '''')
                       end else error(245)
+                    end else if bitwid(lsp) > 0 then begin
+                      { bit fields, output by bytes. k is the weight of the
+                        next field in the byte, and m steps that }
+                      getbounds(lsp^.aeltype, lmin, lmax);
+                      m := 1; for j := 1 to bitwid(lsp) do m := m*2;
+                      i := min; k := 1; w := 0;
+                      if sy = arraysy then insymbol else error(28);
+                      repeat
+                        constexpr(fsys+[comma,endsy],lsp1,fvalu);
+                        if not comptypes(lsp^.aeltype,lsp1) then error(245)
+                        else if not fvalu.intval then error(245)
+                        else if (fvalu.ival < lmin) or (fvalu.ival > lmax) then
+                          error(246)
+                        else w := w+fvalu.ival*k;
+                        i := i+1; k := k*m;
+                        if k = 256 then 
+                          begin writeln(prr, 'c x ', w:1); k := 1; w := 0 end;
+                        if not (sy in [comma,endsy]) then
+                          begin error(29); skip(fsys+[comma,endsy]+typedels) end;
+                        test := sy <> comma;
+                        if not test then insymbol
+                      until test;
+                      if k > 1 then writeln(prr, 'c x ', w:1);
+                      if i-1 <> max then error(247);
+                      if sy = endsy then insymbol else error(13)
                     end else begin
                       { iterate array elements }
                       i := min; if sy = arraysy then insymbol else error(28);
@@ -6794,7 +8227,7 @@ end;
       repeat { id:type group }
         lcp := nil;
         if sy = ident then
-          begin new(lcp,fixed); ininam(lcp);
+          begin getnam(lcp); ininam(lcp);
             with lcp^ do
              begin klass := fixed; strassvf(name, id);
                idtype := nil; floc := -1; fext := incstk <> nil; fmod := incstk
@@ -6889,7 +8322,7 @@ end;
                   begin
                     insymbol; lcp := nil; if opr then error(285);
                     if sy = ident then
-                      begin new(lcp,proc,declared,formal); ininam(lcp);
+                      begin getnam(lcp); ininam(lcp);
                         lc := lc-ptrsize*2; { mp and addr }
                         alignd(parmptr,lc);
                         with lcp^ do
@@ -6919,7 +8352,7 @@ end;
                       begin lcp2 := nil; if opr then error(285);
                         insymbol;
                         if sy = ident then
-                          begin new(lcp,func,declared,formal); ininam(lcp);
+                          begin getnam(lcp); ininam(lcp);
                             lc := lc-ptrsize*2; { mp and addr }
                             alignd(parmptr,lc);
                             with lcp^ do
@@ -6981,7 +8414,7 @@ end;
                         count := 0;
                         repeat
                           if sy = ident then
-                            begin new(lcp,vars); ininam(lcp);
+                            begin getnam(lcp); ininam(lcp);
                               with lcp^ do
                                 begin klass:=vars; strassvf(name,id); 
                                   idtype:=nil; vkind := lkind; next := lcp2;
@@ -7207,10 +8640,7 @@ end;
           lcp1 := lcp; { save original }
           if not forw then { create a new proc/func entry }
             begin
-              if (fsy = procsy) or ((fsy = operatorsy) and (opt = bcmop)) then
-                new(lcp,proc,declared,actual)
-              else { func/opr } new(lcp,func,declared,actual); 
-              ininam(lcp);
+              getnam(lcp); ininam(lcp);
               with lcp^ do
                 begin 
                   if (fsy = procsy) or 
@@ -7235,13 +8665,14 @@ end;
                   idtype := nil; next := nil;
                   externl := false; pflev := level; genlabel(lbname);
                   pfdeckind := declared; pfkind := actual; pfname := lbname;
+                  pfinl := nil; pfilc := 0; pflight := false;
                   pflist := nil; asgn := false; 
                   pext := incstk <> nil; pmod := incstk; refer := false; 
                   pfattr := fpat; grpnxt := nil; grppar := nil;
                   if pfattr in [fpavirtual, fpaoverride] then begin { alloc vector }
                     if pfattr = fpavirtual then begin
                       { have to create a label for far references to virtual }
-                      new(lcp2,vars); ininam(lcp2);
+                      getnam(lcp2); ininam(lcp2);
                       with lcp2^ do begin klass := vars;
                         strassvf(name, id); strcatvr(name, '__virtvec');
                         idtype := nilptr; vkind := actual; next := nil; 
@@ -7324,6 +8755,8 @@ end;
                     if not (lsp^.form in [scalar,subrange,pointer,power,
                                           arrays,records]) then
                       begin error(274); lcp^.idtype := nil end
+                    else if lrgset(lsp) then
+                      begin error(274); lcp^.idtype := nil end
                   end;
                 insymbol
               end
@@ -7379,13 +8812,16 @@ end;
     end (*procdeclaration*) ;
     
   begin (*declare*)
+    phsw(phdcl, oph);
     dp := true;
     repeat
       repeat
         if sy = privatesy then begin insymbol;
           if level > 1 then error(266);
           if (incstk <> nil) and (level <= 1) then 
-            incstk^.priv := true { flag private encountered }
+            begin incstk^.priv := true; { flag private encountered }
+              insrc^.valid := false { and end the source there }
+            end
         end;
         if not inpriv then begin { if private, get us out quickly }
           if sy = labelsy then
@@ -7407,6 +8843,7 @@ end;
         begin error(18); skip(fsys) end
     until (sy in statbegsys) or eofinp or inpriv;
     dp := false;
+    phsw(oph, oph)
   end (*declare*) ;
 
   procedure body{(fsys: setofsys)};
@@ -7420,6 +8857,7 @@ end;
         printed: boolean;
         lsize: addrrange;
         stalvl: integer; { statement nesting level }
+        oph: phase;
         ilp: ctp;
 
     { add statement level }
@@ -7445,14 +8883,31 @@ end;
     end;
   
     procedure genfjp(faddr: integer);
+      var b: integer;
     begin load;
       if gattr.typtr <> nil then
         if gattr.typtr <> boolptr then error(144);
-      if prcode then 
-        begin putic; write(prr,mn[33]:4,' '); prtlabel(faddr); writeln(prr) end;
-      ic := ic + 1; mes(33)
+      if doglob and prcode and (pkop = 51(*ldc*)) and (pkp1 = 3) then begin
+        { constant condition, the jump is always or never taken }
+        b := pkp2; pkpop;
+        if b = 0 then genujpxjpcal(57(*ujp*),faddr)
+      end else begin
+        if prcode then 
+          begin putic; write(prr,mn[33]:4,' '); prtlabel(faddr); writeln(prr) end;
+        ic := ic + 1; mes(33)
+      end
     end (*genfjp*) ;
 
+    { skip code up to the label, if the jump just made to it is unconditional.
+      Nothing between can be reached, since jumps into a statement are not
+      allowed }
+    procedure skipto(lab: integer);
+    begin
+      if (pkop = 57(*ujp*)) and (pkp2 = lab) and (dcllab = 0) then begin
+        pkop := -1; dcllab := lab; dcltop := topnew; prcode := false
+      end
+    end;
+
     procedure statement(fsys: setofsys);
       var lcp: ctp; llp: lbp; inherit: boolean;
 
@@ -7474,13 +8929,22 @@ end;
             lattr2 := gattr; { save access before load }
             if gattr.typtr <> nil then
               if (gattr.access<>drct) or (gattr.typtr^.form>power) or
-                 tagasc then { if tag checking, force address load }
-                if gattr.kind <> expr then loadaddress;
+                 lrgset(gattr.typtr) or tagasc then 
+                { if tag checking or large set, force address load. A bit
+                  element is stored from its address and index }
+                if gattr.kind <> expr then 
+                  if gattr.access <> inxd then loadaddress;
             lattr := gattr;
-            insymbol; expression(fsys, false);
+            setctx := 0;
+            if lattr.typtr <> nil then
+              if lattr.typtr^.form = power then setctx := lattr.typtr^.size;
+            insymbol; expression(fsys, false); setctx := 0;
             if gattr.typtr <> nil then
               { process expression rights as load }
-              if (gattr.typtr^.form <= power) or (gattr.kind = expr) then load
+              if (gattr.typtr^.form = power) and sett(lattr.typtr) then
+                setrep(lattr.typtr) { to representation of the target }
+              else if (gattr.typtr^.form <= power) or (gattr.kind = expr) then 
+                load
               else loadaddress;
             if (lattr.typtr <> nil) and (gattr.typtr <> nil) then begin
               fndopr2(lop, lattr, fcp2);
@@ -7613,7 +9077,7 @@ end;
       procedure ifstatement;
         var lcix1,lcix2: integer;
       begin expression(fsys + [thensy], false);
-        genlabel(lcix1); genfjp(lcix1);
+        genlabel(lcix1); genfjp(lcix1); skipto(lcix1);
         if sy = thensy then insymbol else error(52);
         addlvl;
         statement(fsys + [elsesy]);
@@ -7633,7 +9097,7 @@ end;
       procedure casestatement;
         label 1;
         var lsp,lsp1,lsp2: stp; fstptr,lpt1,lpt2,lpt3: cip; lvals,lvale: valu;
-            laddr, lcix, lcix1, lelse, lelse2, lmin, lmax: integer;
+            laddr, lcix, lcix1, lelse, lmin, lmax: integer;
             test: boolean; i,occ: integer;
       function casecount(cp: cip): integer;
       var c: integer;
@@ -7642,6 +9106,12 @@ end;
           begin c := c+cp^.cslabe-cp^.cslabs+1; cp := cp^.next end;
         casecount := c
       end;
+      function caseranges(cp: cip): integer;
+      var c: integer;
+      begin c := 0; 
+        while cp <> nil do begin c := c+1; cp := cp^.next end;
+        caseranges := c
+      end;
       begin expression(fsys + [ofsy,comma,colon], false);
         load; genlabel(lcix); lelse := 0;
         lsp := gattr.typtr;
@@ -7704,9 +9174,6 @@ end;
           if not test then insymbol
         until test;
         if sy = elsesy then begin chkstd; insymbol; genlabel(lelse);
-          genlabel(lelse2); putlabel(lelse2);
-          mesl(-intsize); { put selector on stack }
-          gen1(71(*dmp*),intsize); 
           putlabel(lelse);
           addlvl;
           statement(fsys + [semicolon]);
@@ -7725,60 +9192,46 @@ end;
             until lpt1 = nil;
             lmin := fstptr^.cslabs;
             { find occupancy }
-            occ := casecount(fstptr)*100 div (lmax-lmin+1);
-            if lmax - lmin < cixmax then 
-              begin
-                if occ >= minocc then begin { build straight vector table }
-                  if lelse > 0 then begin
-                    gen0t(76(*dup*),intptr); 
-                    gen2(51(*ldc*),1,lmin);
-                    gen2(53(*les*),ord('i'),0);
-                    genujpxjpcal(73(*tjp*),lelse2); 
-                    gen0t(76(*dup*),intptr);
-                    gen2(51(*ldc*),1,lmax); 
-                    gen2(49(*grt*),ord('i'),0);
-                    genujpxjpcal(73(*tjp*),lelse2);
-                  end else gen2t(45(*chk*),lmin,lmax,intptr);
-                  gen2(51(*ldc*),1,lmin); gen0(21(*sbi*)); genlabel(lcix);
-                  genujpxjpcal(44(*xjp*),lcix); putlabel(lcix);
-                  repeat
-                    with fstptr^ do
-                      begin
-                        while cslabs > lmin do begin
-                           if lelse > 0 then genujpxjpcal(57(*ujp*),lelse)
-                           else gen0(60(*ujc error*));
-                           lmin := lmin+1
-                        end;
-                        for i := cslabs to cslabe do
-                          genujpxjpcal(57(*ujp*),csstart);
-                        lpt1 := fstptr; fstptr := next; lmin := cslabe+1;
-                        putcas(lpt1);
-                      end
-                  until fstptr = nil;
-                end else begin
-                  { devolve to comp/jmp seq }
-                  repeat
-                    with fstptr^ do begin
-                      gencjp(87(*cjp*),cslabs,cslabe,csstart);   
-                      lpt1 := fstptr; fstptr := next; lmin := cslabe+1;
-                      putcas(lpt1);
-                    end
-                  until fstptr = nil;
-                  if lelse > 0 then genujpxjpcal(57(*ujp*),lelse2);
-                  mesl(+intsize) { remove selector from stack }
-                end;
-                putlabel(laddr)
-              end
-            else begin
-              error(157);
+            occ := 0;
+            if lmax - lmin < cixmax then
+              occ := casecount(fstptr)*100 div (lmax-lmin+1);
+            if occ >= minocc then begin 
+              { build straight vector table. The selector indexes the table
+                directly, and the first entry is taken when it is out of
+                range }
+              gen2(119(*xjt*),lmin,lmax);
+              if lelse > 0 then genujpxjpcal(57(*ujp*),lelse)
+              else gen0(60(*ujc error*));
               repeat
                 with fstptr^ do
                   begin
-                    lpt1 := fstptr; fstptr := next;
+                    while cslabs > lmin do begin
+                       if lelse > 0 then genujpxjpcal(57(*ujp*),lelse)
+                       else gen0(60(*ujc error*));
+                       lmin := lmin+1
+                    end;
+                    for i := cslabs to cslabe do
+                      genujpxjpcal(57(*ujp*),csstart);
+                    lpt1 := fstptr; fstptr := next; lmin := cslabe+1;
                     putcas(lpt1);
                   end
               until fstptr = nil
-            end
+            end else begin
+              { build sparse table of case ranges in ascending order, which is
+                binary searched for the selector. The entry after the table is
+                taken if no range matches }
+              gen1(120(*xjs*),caseranges(fstptr));
+              repeat
+                with fstptr^ do begin
+                  gencjp(87(*cjp*),cslabs,cslabe,csstart);
+                  lpt1 := fstptr; fstptr := next;
+                  putcas(lpt1);
+                end
+              until fstptr = nil;
+              if lelse > 0 then genujpxjpcal(57(*ujp*),lelse)
+              else gen0(60(*ujc error*))
+            end;
+            putlabel(laddr)
           end;
         if sy = endsy then insymbol else error(13)
       end (*casestatement*) ;
@@ -7809,6 +9262,7 @@ end;
         var laddr, lcix: integer;
       begin genlabel(laddr); putlabel(laddr);
         expression(fsys + [dosy], false); genlabel(lcix); genfjp(lcix);
+        skipto(lcix);
         if sy = dosy then insymbol else error(54);
         addlvl;
         statement(fsys);
@@ -8209,6 +9663,7 @@ end;
     end;
           
   begin (*body*)
+    phsw(phstm, oph);
     stalvl := 0; { clear statement nesting level }
     cstptrix := 0; topnew := 0; topmin := 0;
     { if processing procedure/function, use that entry label, otherwise set 
@@ -8218,6 +9673,14 @@ end;
     genlabel(gblsize);
     gencupent(32(*ents*),1,segsize,fprocp); 
     gencupent(32(*ente*),2,stackbot,fprocp);
+    { capture the routine code if it might be inlined }
+    inlcap := false; inlok := false;
+    if doinl and (inlmax > 0) and prcode and not option['q'] then 
+      if inlcand(fprocp) then begin
+        inlcap := true; inlok := true; inlpnd := false; inlsiz := 0; 
+        inltl := nil
+      end;
+    lfok := true; { see if the frame needs its static link }
     if fprocp <> nil then (*copy multiple values into local cells*)
       begin llc1 := lcaftermarkstack;
         lcp := fprocp^.pflist;
@@ -8262,7 +9725,7 @@ end;
               lcp := lcp^.next;
             end;
       end;
-    lcmin := lc;
+    lcmin := lc; lcinl := lc;
     addlvl;
     if level = 1 then begin { perform module setup tasks }
       externalheader; { process external header files }
@@ -8279,6 +9742,12 @@ end;
       test := sy <> semicolon;
       if not test then insymbol
     until test;
+    if inlcap then begin { end capture }
+      flushpk; if inlpnd or not prcode then inlok := false;
+      inlcap := false;
+      if not inlok then begin putinl(inlhd); inlhd := nil end
+    end;
+    if fprocp <> nil then fprocp^.pflight := lfok;
     { deinitialize containers }
     if level = 1 then begin
       ilp := display[top].inilst;
@@ -8304,6 +9773,8 @@ end;
         end;
     printed := false; 
     if (fprocp <> nil) or iso7185 then chkrefs(display[top].fname, printed);
+    if lcinl < lcmin then lcmin := lcinl; { add frames of inlined code }
+    flushpk; { settle the stack count }
     if toterr = 0 then
       if (topnew <> 0) and prcode then
         error(504); { stack should have wound to zero }
@@ -8322,6 +9793,13 @@ end;
           gen1t(42(*ret*),fprocp^.idtype^.size,basetype(fprocp^.idtype))
         else gen0t(42(*ret*),basetype(fprocp^.idtype));
         alignd(parmptr,lcmin);
+        if inlhd <> nil then begin { keep code for inlining }
+          fprocp^.pfinl := inlhd; fprocp^.pfilc := lcmin; inlhd := nil;
+          if list then begin
+            if not printed then writeln; writev(output, fprocp^.name, 10);
+            writeln(' inlined, ', inlsiz:1, ' instructions'); printed := true
+          end
+        end;
         if prcode then
         begin prtlabel(segsize); writeln(prr,'=',lcmin:1);
            prtlabel(stackbot); writeln(prr,'=',topmin:1)
@@ -8340,6 +9818,7 @@ end;
           begin writeln(output); printtables(true)
           end
       end;
+    phsw(oph, oph)
   end (*body*) ;
 
   procedure openinput(var ff: boolean);
@@ -8348,7 +9827,8 @@ end;
     { have not previously parsed this module }
     new(fp); 
     with fp^ do begin
-      next := incstk; incstk := fp; strassvf(mn, id); priv := false;
+      next := incstk; incstk := fp; strassvf(mn, id); priv := false; 
+      sb := nil;
       fn := id; i := fillen; while (i > 1) and (fn[i] = ' ') do i := i-1;
       if i > fillen-4-1 then error(265);
       for x := 1 to 4 do begin i := i+1; fn[i] := es[x] end;
@@ -8357,7 +9837,9 @@ end;
         incstk := incstk^.next;
         dispose(fp);
         ff := false 
-      end else begin assigntext(f, fn); reset(f) end
+      end else begin assigntext(f, fn); reset(f);
+        new(sb); insrc := sb; getinp { read first line }
+      end
     end
   end;
     
@@ -8366,8 +9848,11 @@ end;
   begin
     if incstk = nil then error(505);
     closetext(incstk^.f);
+    dispose(incstk^.sb); incstk^.sb := nil;
     { remove top include entry }
     fp := incstk; incstk := incstk^.next;
+    { back to the buffer of the including source }
+    if incstk <> nil then insrc := incstk^.sb else insrc := prdsrc;
     fp^.next := inclst; { put on discard list }
     inclst := fp
   end;
@@ -8376,7 +9861,9 @@ end;
   var fp: filptr;
   begin
     while fl <> nil do begin
-      fp := fl; fl := fl^.next; putstrs(fp^.mn); dispose(fp)
+      fp := fl; fl := fl^.next; putstrs(fp^.mn); 
+      if fp^.sb <> nil then dispose(fp^.sb);
+      dispose(fp)
     end
   end;
   
@@ -8393,13 +9880,14 @@ end;
   procedure usesjoins;
   var sys: symbol; prcodes: boolean; ff: boolean; chs: char; eols: boolean;
       lists: boolean; nammods, modnams, thismod: strvsp; gcs: addrrange; 
-      curmods: modtyp; entnames: integer; sym: symbol;
+      curmods: modtyp; entnames: integer; sym: symbol; oph: phase;
   function schnam(fp: filptr): boolean;
   begin schnam := false;
     while fp <> nil do 
       begin if fp^.fn = id then schnam := true; fp := fp^.next end
   end;
   begin
+    phsw(phmod, oph); phmdl := phmdl+1;
     sym := sy; insymbol; { skip uses/joins }
     repeat { modules }
       if sy <> ident then error(2) else begin
@@ -8428,6 +9916,7 @@ end;
             { clear display for next }
             with display[top] do
               begin fname := nil; flabel := nil; fconst := nil; fstruct := nil;
+                    labend := nil; nlab := 0; cstend := nil; ncst := 0;
                     packing := false; packcom := false; ptrref := false; 
                     define := true; occur := blck; bname := nil end
           end
@@ -8436,7 +9925,8 @@ end;
       sys := sy;
       if sy = comma then insymbol
     until sys <> comma;
-    if sy = semicolon then insymbol else error(14)
+    if sy = semicolon then insymbol else error(14);
+    phmdl := phmdl-1; phsw(oph, oph)
   end;
     
   function searchext: boolean;
@@ -8539,7 +10029,7 @@ end;
         end
       end;
       if prcode then begin
-        putlabel(nxtname); { set skip module stack }
+        putlabel(nxtname); flushpk; { set skip module stack }
         writeln(prr,'g ',gc:1);
         writeln(prr, 'e m') { mark module block end }
       end
@@ -8551,6 +10041,7 @@ end;
     end;
     if (sy <> period) and not inpriv then begin error(21); skip([period]) end;
     if prcode then begin
+      if binopn then begin writeln(prr, '#.'); write(prb, bincnt) end;
       writeln(prr, 'f ', toterr:1);
       { only terminate intermediate if we are a cap cell (program) }
       if curmod = mtprogram then writeln(prr,'q')
@@ -8599,64 +10090,69 @@ end;
   begin                                                 (*type underlying:*)
                                                         (******************)
 
-    new(intptr,scalar,standard); pshstc(intptr);               (*integer*)
+    getstc(intptr); pshstc(intptr);                            (*integer*)
     with intptr^ do
       begin form := scalar; size := intsize; scalkind := standard; 
             packing := false end;
-    new(crdptr,subrange); pshstc(crdptr);                      (*cardinal*)
+    getstc(crdptr); pshstc(crdptr);                            (*cardinal*)
     with crdptr^ do
       begin form := subrange; size := intsize; rangetype := intptr; 
             min.intval := true; min.ival := 0; 
             max.intval := true; max.ival := pmmaxint; packing := false end;
-    new(realptr,scalar,standard); pshstc(realptr);             (*real*)
+    getstc(realptr); pshstc(realptr);                          (*real*)
     with realptr^ do
       begin form := scalar; size := realsize; scalkind := standard; 
             packing := false end;
-    new(charptr,scalar,standard); pshstc(charptr);             (*char*)
+    getstc(charptr); pshstc(charptr);                          (*char*)
     with charptr^ do
       begin form := scalar; size := charsize; scalkind := standard;
             packing := false end;
-    new(boolptr,scalar,declared); pshstc(boolptr);             (*boolean*)
+    getstc(boolptr); pshstc(boolptr);                          (*boolean*)
     with boolptr^ do
       begin form := scalar; size := boolsize; scalkind := declared;
             packing := false end;
-    new(nilptr,pointer); pshstc(nilptr);                       (*nil*)
+    getstc(nilptr); pshstc(nilptr);                            (*nil*)
     with nilptr^ do
       begin form := pointer; eltype := nil; size := ptrsize; 
             packing := false end;
     (*for alignment of parameters*)
-    new(parmptr,scalar,standard); pshstc(parmptr);
+    getstc(parmptr); pshstc(parmptr);
     with parmptr^ do
       begin form := scalar; size := parmsize; scalkind := standard;
             packing := false end ;
-    new(textptr,files); pshstc(textptr);                       (*text*)
+    (*for sets converted from words*)
+    getstc(setptr); pshstc(setptr);
+    with setptr^ do
+      begin form := power; elset := nil; size := setsize; packing := false;
+            matchpack := false; widset := false end;
+    getstc(textptr); pshstc(textptr);                          (*text*)
     with textptr^ do
       begin form := files; filtype := charptr; size := filesize+charsize; 
             packing := false end;
-    new(exceptptr,exceptf); pshstc(exceptptr);                 (*exception*)
+    getstc(exceptptr); pshstc(exceptptr);                      (*exception*)
     with exceptptr^ do
       begin form := exceptf; size := exceptsize; packing := false end;
       
     { common types }
-    new(stringptr,arrayc); pshstc(stringptr);                  (*string*)
+    getstc(stringptr); pshstc(stringptr);                      (*string*)
     with stringptr^ do
       begin form := arrayc; size := 0; packing := true; abstype := charptr end;
-    new(pstringptr,pointer); pshstc(pstringptr);               (*string pointer*)
+    getstc(pstringptr); pshstc(pstringptr);                    (*string pointer*)
     with pstringptr^ do
       begin form := pointer; size := ptrsize; packing := false; 
             eltype := stringptr end;
-    new(byteptr,subrange); pshstc(byteptr);
+    getstc(byteptr); pshstc(byteptr);
     with byteptr^ do
       begin form := subrange; size := 1; packing := false; rangetype := intptr;
             min.intval := true; min.ival := 0; max.intval := true; 
             max.ival := 255 end;
-    new(abyteptr,arrayc); pshstc(abyteptr);                    (*byte array*)
+    getstc(abyteptr); pshstc(abyteptr);                        (*byte array*)
     with abyteptr^ do
       begin form := arrayc; size := 0; packing := false; abstype := byteptr end;        
-    new(vectorptr,arrayc); pshstc(vectorptr);                  (*vector*)
+    getstc(vectorptr); pshstc(vectorptr);                      (*vector*)
     with vectorptr^ do
       begin form := arrayc; size := 0; packing := false; abstype := intptr end;
-    new(matrixptr,arrayc); pshstc(matrixptr);                  (*matrix*)
+    getstc(matrixptr); pshstc(matrixptr);                      (*matrix*)
     with matrixptr^ do
       begin form := arrayc; size := 0; packing := false; 
             abstype := vectorptr end;  
@@ -8669,9 +10165,7 @@ end;
 
   procedure entstdprocfunc(idc: idclass; sn: stdrng; kn: keyrng; idt: stp);
   begin
-    if idc = proc then new(cp,proc,standard)
-    else new(cp,func,standard);
-    ininam(cp);
+    getnam(cp); ininam(cp);
     with cp^ do
       begin klass := idc; strassvr(name, na[sn]); idtype := idt;
         pflist := nil; next := nil; key := kn;
@@ -8683,7 +10177,7 @@ end;
   
   procedure entstdtyp(sn: stdrng; idt: stp);
   begin
-    new(cp,types); ininam(cp);
+    getnam(cp); ininam(cp);
     with cp^ do
       begin klass := types; strassvr(name, na[sn]); idtype := idt end;
     enterid(cp)
@@ -8691,7 +10185,7 @@ end;
   
   procedure entstdintcst(sn: stdrng; idt: stp; i: integer);
   begin
-    new(cp,konst); ininam(cp);
+    getnam(cp); ininam(cp);
     with cp^ do
       begin klass := konst; strassvr(name, na[sn]); idtype := idt; next := nil; 
         values.intval := true; values.ival := i end;
@@ -8701,7 +10195,7 @@ end;
   procedure entstdrlcst(sn: stdrng; idt: stp; r: real);
   var lvp: csp;
   begin
-    new(cp,konst); ininam(cp); new(lvp,reel); pshcst(lvp); lvp^.cclass := reel;
+    getnam(cp); ininam(cp); getcst(lvp); pshcst(lvp); lvp^.cclass := reel;
     lvp^.rval := r;
     with cp^ do
       begin klass := konst; strassvr(name, na[sn]); idtype := idt; next := nil;
@@ -8711,7 +10205,7 @@ end;
   
   procedure entstdhdr(sn: stdrng);
   begin
-    new(cp,vars); ininam(cp); 
+    getnam(cp); ininam(cp); 
     with cp^ do
     begin klass := vars; strassvr(name, na[sn]); idtype := textptr; 
       vkind := actual; next := nil; vlev := 1;
@@ -8724,7 +10218,7 @@ end;
   
   procedure entstdexp(en: expstr);
   begin
-    new(cp,vars); ininam(cp); 
+    getnam(cp); ininam(cp); 
     with cp^ do
     begin klass := vars; strassve(name, en); idtype := exceptptr; 
       vkind := actual; next := nil; vlev := 1;
@@ -8760,7 +10254,7 @@ end;
 
     cp1 := nil;
     for i := 1 to 2 do
-      begin new(cp,konst); ininam(cp);                        (*false,true*)
+      begin getnam(cp); ininam(cp);                           (*false,true*)
         with cp^ do
           begin klass := konst; strassvr(name, na[i]); idtype := boolptr;
             next := cp1; values.intval := true; values.ival := i - 1; 
@@ -8780,7 +10274,7 @@ end;
     
     for i := 27 to 32 do
       begin
-        new(cp,vars); ininam(cp);                                (*parameter of predeclared functions*)
+        getnam(cp); ininam(cp);                                  (*parameter of predeclared functions*)
         with cp^ do
           begin klass := vars; strassvr(name, '         '); idtype := realptr; 
             vkind := actual; next := nil; vlev := 1; vaddr := 0;
@@ -8788,11 +10282,12 @@ end;
             vext := false; vmod := nil; inilab := -1; ininxt := nil;
             dblptr := false;
           end;
-        new(cp1,func,declared,actual); ininam(cp1);            (*sin,cos,exp*)
+        getnam(cp1); ininam(cp1);                              (*sin,cos,exp*)
         with cp1^ do                                           (*sqrt,ln,arctan*)
           begin klass := func; strassvr(name, na[i]); idtype := realptr; 
             pflist := cp; forwdecl := false; externl := true; pflev := 0;
             pfname := i - 12; pfdeckind := declared; pfkind := actual;
+            pfinl := nil; pfilc := 0; pflight := false;
             pfaddr := 0; pext := false; pmod := nil; pfattr := fpanone; 
             grpnxt := nil; grppar := nil; pfvid := nil            
           end;
@@ -8927,15 +10422,15 @@ end;
 
   procedure enterundecl;
   begin
-    new(utypptr,types); ininam(utypptr);
+    getnam(utypptr); ininam(utypptr);
     with utypptr^ do
       begin klass := types; strassvr(name, '         '); idtype := nil end;
-    new(ucstptr,konst); ininam(ucstptr);
+    getnam(ucstptr); ininam(ucstptr);
     with ucstptr^ do
       begin klass := konst; strassvr(name, '         '); idtype := nil; 
         next := nil; values.intval := true; values.ival := 0
       end;
-    new(uvarptr,vars); ininam(uvarptr);
+    getnam(uvarptr); ininam(uvarptr);
     with uvarptr^ do
       begin klass := vars; strassvr(name, '         '); idtype := nil; 
         vkind := actual; next := nil; vlev := 0; vaddr := 0; 
@@ -8943,28 +10438,28 @@ end;
         vext := false; vmod := nil; inilab := -1; ininxt := nil; 
         dblptr := false;
       end;
-    new(ufldptr,field); ininam(ufldptr);
+    getnam(ufldptr); ininam(ufldptr);
     with ufldptr^ do
       begin klass := field; strassvr(name, '         '); idtype := nil; 
         next := nil; fldaddr := 0; varnt := nil; varlb := nil; 
         tagfield := false; taglvl := 0; varsaddr := 0; 
         varssize := 0; vartl := -1
       end;
-    new(uprcptr,proc,declared,actual); ininam(uprcptr);
+    getnam(uprcptr); ininam(uprcptr);
     with uprcptr^ do
       begin klass := proc; strassvr(name, '         '); idtype := nil; 
         forwdecl := false; next := nil; externl := false; pflev := 0; 
         genlabel(pfname); pflist := nil; pfdeckind := declared; 
         pfkind := actual; pmod := nil; grpnxt := nil; grppar := nil; 
-        pfvid := nil
+        pfvid := nil; pfinl := nil; pfilc := 0; pflight := false
       end;
-    new(ufctptr,func,declared,actual); ininam(ufctptr);
+    getnam(ufctptr); ininam(ufctptr);
     with ufctptr^ do
       begin klass := func; strassvr(name, '         '); idtype := nil; 
         next := nil; forwdecl := false; externl := false; pflev := 0; 
         genlabel(pfname); pflist := nil; pfdeckind := declared; 
         pfkind := actual; pmod := nil; grpnxt := nil; grppar := nil; 
-        pfvid := nil
+        pfvid := nil; pfinl := nil; pfilc := 0; pflight := false
       end
   end (*enterundecl*) ;
 
@@ -8980,20 +10475,35 @@ end;
   end (*exitundecl*) ;
 
   procedure initscalars;
-  var i: integer; c: char;
+  var i: integer; c: char; ph: phase;
   begin fwptr := nil; for c := 'a' to 'z' do option[c] := false;
     prtables := false; option['t'] := false; list := true; option['l'] := true;
     prcode := true; option['c'] := true; debug := true; option['d'] := true;
     chkvar := true; option['v'] := true; chkref := true; option['r'] := true;
     chkudtc := false; option['u'] := false; option['s'] := false; iso7185 := false;
     dodmplex := false; doprtryc := false; doprtlab := false; dodmpdsp := false;
+    prtlvl := 1; phcur := photh; phmdl := 0; inscnt := 0; hpcnt := 0;
+    thrcnt := 0;
+    for ph := phlex to photh do phtim[ph] := 0;
     chkvbk := false; option['i'] := false;
+    dopeep := false; option['k'] := false; pkop := -1; pklcnt := 0;
+    doglob := false; doinl := false; option['j'] := false; pkcv := false;
+    dcllab := 0;
+    for i := 0 to nmhsh do nmh[i] := nil;
+    for i := 0 to idhsh do idh[i] := nil;
+    nmcnt := 0;
+    optlvl := 0; inlmax := inldef; inlcap := false; inlok := false;
+    inlpnd := false; prclvl := 1; dobin := false; binopn := false;
+    setctx := 0;
+    lfok := false; 
+    inlhd := nil; inltl := nil; lcinl := 0;
     dp := true; errinx := 0;
     intlabel := 0; kk := maxids; fextfilep := nil;
     lc := lcaftermarkstack; gc := 0;
     (* note in the above reservation of buffer store for 2 text files *)
     ic := 3; eol := true; linecount := 0; lineout := 0; 
     incstk := nil; inclst := nil; cbblst := nil;
+    strfre := nil; cspfre := nil; stpfre := nil; ctpfre := nil; lbpfre := nil;
     ch := ' '; chcnt := 0;
     mxint10 := maxint div 10;
     maxpow10 := 1; while maxpow10 < mxint10 do maxpow10 := maxpow10*10;
@@ -9008,10 +10518,12 @@ end;
     lbpcnt := 0; { label counts }
     filcnt := 0; { file tracking counts }
     cipcnt := 0; { case entry tracking counts }
+    ilrcnt := 0; { inline code entries }
     
     { clear id counts }
     ctpsnm := 0;
-    stpsnm := 0
+    stpsnm := 0;
+    entcnt := 0
   end (*initscalars*) ;
 
   procedure initsets;
@@ -9032,6 +10544,7 @@ end;
 
   procedure inittables;
     procedure reswords;
+    var i, l, h: integer;
     begin
       rw[ 1] := 'if       '; rw[ 2] := 'do       '; rw[ 3] := 'of       ';
       rw[ 4] := 'to       '; rw[ 5] := 'in       '; rw[ 6] := 'or       ';
@@ -9055,6 +10568,12 @@ end;
       rw[58] := 'extends  '; rw[59] := 'on       '; rw[60] := 'result   ';
       rw[61] := 'operator '; rw[62] := 'out      '; rw[63] := 'property ';
       rw[64] := 'channel  '; rw[65] := 'stream   '; rw[66] := 'xor      ';
+      { chain the words by hash, so that lookup does not search the table }
+      for i := 0 to reshsh do rwh[i] := 0;
+      for i := maxres downto 1 do begin
+        l := reslen; while rw[i][l] = ' ' do l := l-1;
+        h := reshash(rw[i][1], rw[i][l], l); rwn[i] := rwh[h]; rwh[h] := i
+      end
     end (*reswords*) ;
 
     procedure symbols;
@@ -9167,7 +10686,11 @@ end;
       mn[104] :=' cxc'; mn[105] :=' lft'; mn[106] :=' max'; mn[107] :=' vdp'; 
       mn[108] :=' spc'; mn[109] :=' ccs'; mn[110] :=' scp'; mn[111] :=' ldp'; 
       mn[112] :=' vin'; mn[113] :=' vdd'; mn[114] :=' lto'; mn[115] :=' ctb';
-      mn[116] :=' cpp'; mn[117] :=' cpr'; mn[118] :=' lsa';
+      mn[116] :=' cpp'; mn[117] :=' cpr'; mn[118] :=' lsa'; mn[119] :=' xjt';
+      mn[120] :=' xjs'; mn[121] :=' msl'; mn[122] :=' cut'; mn[123] :=' sgw';
+      mn[124] :=' rgw'; mn[125] :=' inw'; mn[126] :=' dfw'; mn[127] :=' lew';
+      mn[128] :=' gew'; mn[129] :=' swf'; mn[130] :=' sfw'; mn[131] :=' lgs';
+      mn[132] :=' bfd';
 
     end (*instrmnemonics*) ;
 
@@ -9299,7 +10822,14 @@ end;
       cdx[112] := 0;                    cdx[113] := +ptrsize;
       cdx[114] := -adrsize;             cdx[115] := 0;
       cdx[116] := 0;                    cdx[117] := 0;
-      cdx[118] := -adrsize;
+      cdx[118] := -adrsize;             cdx[119] := +intsize;
+      cdx[120] := +intsize;             cdx[121] :=  0;
+      cdx[122] :=  0;                   cdx[123] :=  0;
+      cdx[124] := +intsize;             cdx[125] := +intsize;
+      cdx[126] := +intsize;             cdx[127] := +intsize;
+      cdx[128] := +intsize;             cdx[129] := +intsize-setsize;
+      cdx[130] := +setsize-intsize;     cdx[131] :=  0; { lgs, by operation }
+      cdx[132] :=  0; { bfd, by operation }
 
       { secondary table order is i, r, b, c, a, s, m }
       cdxs[1][1] := +(adrsize+intsize);  { stoi }
@@ -9452,6 +10982,8 @@ begin
 #ifndef SELF_COMPILE
   reset(prd); rewrite(prr); { open output file }
 #endif
+  new(prdsrc); insrc := prdsrc; getinp; { read first source line }
+  bgnclk := clocktime; phclk := bgnclk; { start compile time }
  
   { write generator comment }
   writeln(prr, '!');
@@ -9459,10 +10991,14 @@ begin
           majorver:1, '.', minorver:1);
   writeln(prr, '!');
   
+  { write the layout, which pint checks against its own }
+  writeln(prr, 'a ', intsize:1, ' ', intal:1, ' ', realal:1, ' ', adral:1, ' ',
+          heapal:1, ' ', gbsal:1);
+
   { write initial option values }
   write(prr, 'o '); 
   for c := 'a' to 'z' do 
-    if not (c in ['g','h','n','o','p','q','s','w','r']) then
+    if not (c in ['g','h','n','o','p','q','s','w','r','j','k']) then
       begin write(prr, c); 
     if option[c] then write(prr, '+') else write(prr, '-')
   end;
@@ -9474,7 +11010,7 @@ begin
   insymbol;
   modulep(blockbegsys+statbegsys-[casesy]);
   { release file tracking entries }
-  putinp(incstk); putinp(inclst);
+  putinp(incstk); putinp(inclst); dispose(prdsrc);
   outline;
 
   { dispose of levels 0 and 1 }
@@ -9487,6 +11023,12 @@ begin
   { remove undeclared ids }
   exitundecl;
 
+  { release interned names }
+  putnms;
+
+  { release the free pools }
+  putfre;
+
   writeln;
   writeln('Errors in program: ', toterr:1);
   { output error report as required }
@@ -9514,10 +11056,12 @@ begin
     writeln('label counts:               ', lbpcnt:1);
     writeln('file tracking counts:       ', filcnt:1);
     writeln('case entry tracking counts: ', cipcnt:1);
+    writeln('inline code entries:        ', ilrcnt:1);
     writeln;
 
   end;
 
+  if doprtryc and (prtlvl > 1) then prtstat; { print compile statistics }
   if doprtlab then prtlabels; { dump labels}
   if dodmpdsp then prtdsp; { dump display }
   
@@ -9544,6 +11088,9 @@ begin
   if cipcnt <> 0 then
      writeln('*** Error: Compiler internal error: case recycle balance: ',
              cipcnt:1);
+  if ilrcnt <> 0 then
+     writeln('*** Error: Compiler internal error: inline recycle balance: ',
+             ilrcnt:1);
 
   99:
 
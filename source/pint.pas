@@ -179,7 +179,7 @@
 #define ISO7185_PASCAL
 #endif
 
-program pint(input,output,prd,prr
+program pint(input,output,prd,prr,prb
               { Pascaline start !
               ,command
               ! Pascaline end }
@@ -254,6 +254,8 @@ const
       maxast      = 100;     { maximum size of assert message }
       maxdbf      = 30;      { size of numeric conversion buffer }
       maxcmd      = 250;     { size of command line buffer }
+      binmag      = 5256770; { first word of binary instructions, 'P6B' }
+      binver      = 1;       { version of binary instructions }
 
       codemax     = maxstr;  { set size of code store to maximum possible }
 
@@ -510,11 +512,25 @@ type
       wthrec       = record sp: psymbol; p: integer end;
       { parser control record }
       parctl       = record b: strvsp; l, p: integer end;
-      { VAR reference block }
+      { VAR reference block. Each block is on the pushdown stack, and is also a
+        node in a treap ordered by start address, with the highest end address
+        in each subtree, so overlap checks take log time in the number of
+        blocks. }
       varptr       = ^varblk;
       varblk       = record 
                        next: varptr; { next entry }
-                       s, e: address { start and end address of block }
+                       s, e: address; { start and end address of block }
+                       l, r: varptr; { left and right subtrees }
+                       m: address; { maximum end address in subtree }
+                       sn: integer; { push sequence number, orders equal starts }
+                       p: integer { treap priority }
+                     end;
+      { deck source line table entry }
+      linptr       = ^linrec;
+      linrec       = record
+                       next: linptr; { next entry }
+                       ad:   address; { address of first instruction of line }
+                       ln:   integer { source line number }
                      end;
 
 var   pc          : address;   (*program address register*)
@@ -581,6 +597,7 @@ var   pc          : address;   (*program address register*)
 #ifndef SELF_COMPILE
       prd,prr     : text; (*prd for read only, prr for write only *)
 #endif
+      prb         : file of integer; { binary instructions, pcom option c2 }
 
       instr       : array[instyp] of alfa; (* mnemonic instruction codes *)
       sptable     : array[0..maxsp] of alfa; (*standard functions and procedures*)
@@ -640,6 +657,11 @@ var   pc          : address;   (*program address register*)
       curmod      : pblock; { currently active block }
       varlst      : varptr; { active var block pushdown stack }
       varfre      : varptr; { free var block entries }
+      vartre      : varptr; { treap root of active var blocks }
+      varseq      : integer; { var block push sequence }
+      varsed      : integer; { var block priority generator seed }
+      lintab      : linptr; { deck source line table }
+      lintal      : linptr; { last entry in that }
 
       i           : integer;
       c1          : char;
@@ -1028,6 +1050,81 @@ begin
   bxor := r
 end;
 
+{ Word set emulation. Sets of elements 0..wsethigh are held as the bits of a
+  positive integer. }
+
+function wbit(i: integer): integer;
+var r: integer;
+begin
+  r := 1;
+  while i > 0 do begin r := r*2; i := i-1 end;
+  wbit := r
+end;
+
+procedure wrdtoset(w: integer; var s: settype);
+var i: integer;
+begin
+  s := [];
+  for i := 0 to wsethigh do begin if odd(w) then s := s+[i]; w := w div 2 end
+end;
+
+{ Large set emulation. Large sets are bitmaps of a whole number of words in
+  store, element i being bit i mod 8 of byte i div 8. }
+
+function lsbit(a: address; i: integer): boolean;
+begin
+  lsbit := odd(store[a+i div 8] div wbit(i mod 8))
+end;
+
+procedure lsset(a: address; i: integer);
+begin
+  if not lsbit(a, i) then store[a+i div 8] := store[a+i div 8]+wbit(i mod 8)
+end;
+
+{ clear large set, and mark it defined }
+procedure lsclr(a: address; n: integer);
+var i: integer;
+begin
+  for i := 0 to n-1 do begin store[a+i] := 0; putdef(a+i, true) end
+end;
+
+{ move run of store with its defined bits, the runs may overlap }
+procedure lsmov(d, s: address; n: integer);
+var i: integer;
+begin
+  if d < s then
+    for i := 0 to n-1 do 
+      begin store[d+i] := store[s+i]; putdef(d+i, getdef(s+i)) end
+  else if d > s then
+    for i := n-1 downto 0 do 
+      begin store[d+i] := store[s+i]; putdef(d+i, getdef(s+i)) end
+end;
+
+procedure lschk(a: address; n: integer);
+var i: integer;
+begin
+  if dochkdef then for i := 0 to n-1 do chkdef(a+i)
+end;
+
+{ Bit fields of packed arrays. Element i of w bits is bits i*w mod 8 up of 
+  byte i*w div 8, w being 1, 2 or 4, so a field never crosses a byte.
+  Definedness is kept per byte, so the first store to any field of a byte
+  clears the byte and marks it defined. Reading another field of that byte
+  before it is stored then gives 0 with no undefined access error. }
+
+function bfdget(a: address; i, w: integer): integer;
+begin chkdef(a+i*w div 8);
+  bfdget := store[a+i*w div 8] div wbit(i*w mod 8) mod wbit(w)
+end;
+
+procedure bfdput(a: address; i, w, v: integer);
+var ad: address; s: integer;
+begin ad := a+i*w div 8; s := wbit(i*w mod 8);
+  if not getdef(ad) then store[ad] := 0;
+  store[ad] := store[ad]-store[ad] div s mod wbit(w)*s+v mod wbit(w)*s;
+  putdef(ad, true)
+end;
+
 { End of language extension routines }
 
 (*--------------------------------------------------------------------*)
@@ -1365,6 +1462,103 @@ begin
 
 end;
 
+{ Sparse set emulation. Sparse sets are a count of elements, then the 
+  elements in ascending order, each a word, in q bytes. Only the count and
+  the elements held are moved. A result is built below the stack, then 
+  moved into place. }
+
+{ find element i of sparse set }
+function spelt(a: address; i: integer): integer;
+begin
+  spelt := getint(a+i*intsize)
+end;
+
+{ find if element e is in sparse set, by halving }
+function spfnd(a: address; e: integer): boolean;
+var l, h, m: integer; f: boolean;
+begin
+  f := false; l := 1; h := getint(a);
+  while (l <= h) and not f do begin
+    m := (l+h) div 2;
+    if spelt(a, m) = e then f := true
+    else if spelt(a, m) < e then l := m+1
+    else h := m-1
+  end;
+  spfnd := f
+end;
+
+{ move sparse set with its count }
+procedure spmov(d, s: address);
+begin
+  lsmov(d, s, (getint(s)+1)*intsize)
+end;
+
+{ add element e after the n already in sparse set of q bytes }
+procedure spadd(d: address; q: integer; var n: integer; e: integer);
+begin
+  n := n+1; if n >= q div intsize then errore(SetElementOutOfRange);
+  putint(d+n*intsize, e)
+end;
+
+{ combine sparse sets a1 and a2 of q bytes into d, o = 0 union, 
+  1 intersection, 2 difference }
+procedure spop(d, a1, a2: address; q, o: integer);
+var i1, i2, n1, n2, n, e1, e2: integer;
+begin
+  n1 := getint(a1); n2 := getint(a2); i1 := 1; i2 := 1; n := 0;
+  e1 := 0; e2 := 0;
+  while (i1 <= n1) or (i2 <= n2) do begin
+    if i1 <= n1 then e1 := spelt(a1, i1);
+    if i2 <= n2 then e2 := spelt(a2, i2);
+    if i2 > n2 then begin
+      if o <> 1 then spadd(d, q, n, e1); i1 := i1+1
+    end else if i1 > n1 then begin
+      if o = 0 then spadd(d, q, n, e2); i2 := i2+1
+    end else if e1 < e2 then begin
+      if o <> 1 then spadd(d, q, n, e1); i1 := i1+1
+    end else if e2 < e1 then begin
+      if o = 0 then spadd(d, q, n, e2); i2 := i2+1
+    end else begin
+      if o <> 2 then spadd(d, q, n, e1); i1 := i1+1; i2 := i2+1
+    end
+  end;
+  putint(d, n)
+end;
+
+{ find if sparse set a1 is included in a2 }
+function spinc(a1, a2: address): boolean;
+var i1, i2, n1, n2: integer; b: boolean;
+begin
+  n1 := getint(a1); n2 := getint(a2); i1 := 1; i2 := 1; b := true;
+  while b and (i1 <= n1) do
+    if i2 > n2 then b := false
+    else if spelt(a2, i2) < spelt(a1, i1) then i2 := i2+1
+    else if spelt(a2, i2) = spelt(a1, i1) then
+      begin i1 := i1+1; i2 := i2+1 end
+    else b := false;
+  spinc := b
+end;
+
+{ make sparse set d of q bytes from large set a of n bytes }
+procedure spfrm(d, a: address; n, q: integer);
+var i, c: integer;
+begin
+  c := 0;
+  for i := 0 to n*8-1 do if lsbit(a, i) then spadd(d, q, c, i);
+  putint(d, c)
+end;
+
+{ make large set d of q bytes from sparse set a }
+procedure spto(d, a: address; q: integer);
+var i, e: integer;
+begin
+  lsclr(d, q);
+  for i := 1 to getint(a) do begin
+    e := spelt(a, i); if e >= q*8 then errore(SetElementOutOfRange);
+    lsset(d, e)
+  end
+end;
+
 function getrel(a: address): real;
 
 var r: record case boolean of
@@ -1719,10 +1913,14 @@ end;
 { load intermediate file }
 
 procedure load;
-   type  labelst  = (entered,defined); (*label situation*)
+   const alfhsh   = 511;               { top of mnemonic hash tables }
+         csthsh   = 1023;              { top of constant hash table }
+         rchhsh   = 1023;              { top of reached labels hash table }
+   type  labelst  = (entered,defined,aliased); (*label situation*)
          labelrg  = 0..maxlabel;       (*label range*)
          labelrec = record
-                          val: address;
+                          val: address; { or the label it stands for }
+                           uv: address; { jumps that can take a return }
                            st: labelst
                     end;
          flabelp = ^flabel;
@@ -1732,11 +1930,46 @@ procedure load;
                        ref: strvsp
                      end;
          cstfixrg  = 1..maxcstfx; { constant fixup range }
+         { constant placed in the constants area, kept to find copies }
+         cstep = ^cste;
+         cste = record
+                  next: cstep; { next in hash chain }
+                  ad: address; { address }
+                  len: integer { length }
+                end;
+         { routine or data table found by the reachability pass }
+         rchrfp = ^rchrf;
+         rchrf = record { label referenced }
+                   next: rchrfp; { next in list }
+                   modn: integer; { module number }
+                   lab: integer; { near label }
+                   fl: strvsp { far label, or nil }
+                 end;
+         rchitp = ^rchit;
+         rchit = record
+                   next: rchitp; { next in intermediate order }
+                   up: rchitp; { enclosing block }
+                   wrk: rchitp; { next in work list }
+                   name: strvsp; { module.name of routine in module, or nil }
+                   btyp: char; { block type, or ' ' for data table }
+                   live: boolean; { reached }
+                   refs: rchrfp { labels referenced }
+                 end;
+         rchlbp = ^rchlb;
+         rchlb = record { near label defined }
+                   next: rchlbp; { next in hash chain }
+                   modn: integer; { module number }
+                   lab: integer; { label }
+                   itm: rchitp { item defining it }
+                 end;
          gblfixrg  = 1..maxgblfx; { globals fixup range }
          
    var  word : array[alfainx] of char; ch  : char;
         labeltab: array[labelrg] of labelrec;
         labelvalue: address;
+        rtchn: address; { jumps to be replaced by the return at rtadr }
+        rtadr: address;
+        inctb: boolean; { in a case table }
         iline: integer; { line number of intermediate file }
         cstfixtab: array [cstfixrg] of address;
         cstfixi: 0..maxcstfx;
@@ -1751,16 +1984,114 @@ procedure load;
         sn: filnam;
         snl: 1..fillen;
         flablst: flabelp; { list of far labels }
+        { hash tables for instruction and standard procedure mnemonics, 
+          giving the code, or -1 for an empty entry }
+        insh: array [0..alfhsh] of integer;
+        sph: array [0..alfhsh] of integer;
+        { hash table for binary instructions by packed mnemonic, giving the
+          code, or -1 for an empty entry, and the packed mnemonic }
+        binh, binc: array [0..alfhsh] of integer;
+        binopn: boolean; { prb has been opened }
+        binins: boolean; { instruction being assembled is from prb }
+        bincnt: integer; { binary instructions since the module header }
+        binhd: integer; { header of the binary instruction being assembled }
+        binopr: integer; { operands read for it }
+        csth: array [0..csthsh] of cstep; { constants by hash of contents }
+        rchlst, rchtal: rchitp; { reachability items in intermediate order }
+        rchrt: rchitp; { code outside of any block }
+        rchnxt: rchitp; { next item to be generated }
+        rchblk: rchitp; { item of block being generated }
+        rchrts: integer; { routines left out }
+        rchins: integer; { instructions left out }
+        thrjmp: integer; { jumps replaced by returns }
+        rchbyt: integer; { bytes of data tables left out }
+        rchlbh: array [0..rchhsh] of rchlbp; { near labels by hash }
 
    procedure clrlab;
    var i: integer;
    begin
      for i:= 0 to maxlabel do
-       with labeltab[i] do begin val:=-1; st:= entered end
+       with labeltab[i] do begin val:=-1; uv := -1; st:= entered end
    end;
    
+   { A constant of length l was just placed at cp, which was ocp before it was 
+     aligned to al and the constant allocated. If the same constant was 
+     placed before, at that alignment, release the new one and give the 
+     address of the old one in q, otherwise enter it and give its address }
+   procedure cstdup(ocp: address; l, al: integer; var q: address);
+   var h, i: integer; ad: address; p: cstep; f: boolean;
+   begin h := 0; f := false;
+     for ad := cp to cp+l-1 do h := (h*31+store[ad]) mod (csthsh+1);
+     p := csth[h];
+     while not f and (p <> nil) do begin
+       if (p^.len = l) and (p^.ad mod al = 0) then begin
+         f := true; i := 0;
+         while f and (i < l) do 
+           begin f := store[p^.ad+i] = store[cp+i]; i := i+1 end
+       end;
+       if not f then p := p^.next
+     end;
+     if f then begin q := p^.ad; cp := ocp end
+     else begin
+       new(p); p^.ad := cp; p^.len := l; p^.next := csth[h]; csth[h] := p;
+       q := cp
+     end
+   end;
+
+   { hash mnemonic }
+   function alfh(var a: alfa): integer;
+   var i, h: integer;
+   begin h := 0;
+     for i := 1 to maxalfa do h := (h*31+ord(a[i])) mod (alfhsh+1);
+     alfh := h
+   end;
+
+   { find instruction mnemonic, giving its hash table entry }
+   function inssch(var a: alfa): integer;
+   var x: integer; f: boolean;
+   begin x := alfh(a); f := false;
+     while not f do
+       if insh[x] = -1 then f := true
+       else if instr[insh[x]] = a then f := true
+       else x := (x+1) mod (alfhsh+1);
+     inssch := x
+   end;
+
+   { find standard procedure mnemonic, giving its hash table entry }
+   function spsch(var a: alfa): integer;
+   var x: integer; f: boolean;
+   begin x := alfh(a); f := false;
+     while not f do
+       if sph[x] = -1 then f := true
+       else if sptable[sph[x]] = a then f := true
+       else x := (x+1) mod (alfhsh+1);
+     spsch := x
+   end;
+
+   { pack mnemonic five bits to a letter, as pcom does for binary 
+     instructions }
+   function inscod(var a: alfa): integer;
+   var i, c: integer;
+   begin c := 0;
+     for i := 1 to maxalfa do
+       if a[i] in ['a'..'z'] then c := c*32+ord(a[i])-ord('a')+1;
+     inscod := c
+   end;
+
+   { find binary instruction by packed mnemonic, giving its hash table 
+     entry }
+   function binsch(c: integer): integer;
+   var x: integer; f: boolean;
+   begin x := c mod (alfhsh+1); f := false;
+     while not f do
+       if binh[x] = -1 then f := true
+       else if binc[x] = c then f := true
+       else x := (x+1) mod (alfhsh+1);
+     binsch := x
+   end;
+
    procedure init;
-      var i: integer;
+      var i, x: integer;
    begin for i := 0 to maxins do instr[i] := '          ';
          {
 
@@ -2015,6 +2346,20 @@ procedure load;
          instr[239]:='cpp       '; insp[239] := false; insq[239] := intsize*2;
          instr[240]:='cpr       '; insp[240] := false; insq[240] := intsize*2;
          instr[241]:='lsa       '; insp[241] := false; insq[241] := intsize;
+         instr[242]:='xjt       '; insp[242] := false; insq[242] := intsize;
+         instr[243]:='xjs       '; insp[243] := false; insq[243] := intsize;
+         instr[244]:='msl       '; insp[244] := true;  insq[244] := intsize;
+         instr[245]:='cut       '; insp[245] := true;  insq[245] := intsize;
+         instr[246]:='sgw       '; insp[246] := false; insq[246] := 0;
+         instr[247]:='rgw       '; insp[247] := false; insq[247] := 0;
+         instr[248]:='inw       '; insp[248] := false; insq[248] := 0;
+         instr[249]:='dfw       '; insp[249] := false; insq[249] := 0;
+         instr[250]:='lew       '; insp[250] := false; insq[250] := 0;
+         instr[251]:='gew       '; insp[251] := false; insq[251] := 0;
+         instr[252]:='swf       '; insp[252] := false; insq[252] := intsize;
+         instr[253]:='sfw       '; insp[253] := false; insq[253] := 0;
+         instr[254]:='lgs       '; insp[254] := true;  insq[254] := intsize;
+         instr[255]:='bfd       '; insp[255] := true;  insq[255] := intsize;
 
          sptable[ 0]:='get       ';     sptable[ 1]:='put       ';
          sptable[ 2]:='thw       ';     sptable[ 3]:='rln       ';
@@ -2062,7 +2407,7 @@ procedure load;
            the code deck }
          cp := maxtop; { set constants pointer to top of storage }
          for i:= 1 to 10 do word[i]:= ' ';
-         clrlab;
+         clrlab; rtchn := -1; rtadr := 0; inctb := false;
          cstfixi := 0; { set no constant fixups }
          gblfixi := 0; { set no global fixups }
          npadr := -1;
@@ -2070,6 +2415,26 @@ procedure load;
          gbset := false; { global size not set }
          gbloff := 0; { set global offset }
          flablst := nil; { clear far label list }
+         rchlst := nil; rchtal := nil; rchrt := nil; { clear reachability }
+         rchnxt := nil; rchblk := nil;
+         rchrts := 0; rchins := 0; rchbyt := 0; thrjmp := 0;
+         { hash the mnemonics. Where a name appears twice, the first is kept,
+           as a search of the table would find }
+         for i := 0 to csthsh do csth[i] := nil; { clear constants }
+         for i := 0 to alfhsh do begin insh[i] := -1; sph[i] := -1 end;
+         for i := 0 to maxins do if instr[i][1] <> ' ' then begin
+           x := inssch(instr[i]); if insh[x] = -1 then insh[x] := i
+         end;
+         for i := 0 to maxsp do begin
+           x := spsch(sptable[i]); if sph[x] = -1 then sph[x] := i
+         end;
+         for i := 0 to alfhsh do binh[i] := -1;
+         for i := 0 to maxins do if instr[i][1] <> ' ' then begin
+           x := binsch(inscod(instr[i]));
+           if binh[x] = -1 then 
+             begin binh[x] := i; binc[x] := inscod(instr[i]) end
+         end;
+         binopn := false; binins := false; bincnt := 0
    end;(*init*)
 
    procedure errorl(string: beta); (*error in loading*)
@@ -2087,43 +2452,106 @@ procedure load;
       writeln;
       writeln('Label table');
       writeln;
-      for i := 1 to maxlabel do if labeltab[i].val <> -1 then begin
+      for i := 1 to maxlabel do 
+        if (labeltab[i].val <> -1) or (labeltab[i].uv <> -1) then begin
 
          write('Label: ', i:5, ' value: ', labeltab[i].val, ' ');
          if labeltab[i].st = entered then writeln('Entered')
+         else if labeltab[i].st = aliased then writeln('Alias')
          else writeln('Defined')
 
       end;
+      writeln;
+      writeln('Jumps replaced by returns: ', thrjmp:1);
       writeln
 
    end;
 
+   { place a target address in a list of future references }
+   procedure patch(curr, v: address);
+      var succ: address; { successor element }
+   begin
+      while curr <> -1 do begin
+         succ := getadr(curr); { get next reference from that }
+         putadr(curr, v); { place new target address }
+         curr := succ
+      end
+   end;
+
    procedure update(x: labelrg); (*when a label definition lx is found*)
-      var curr,succ,ad: address; (*resp. current element and successor element
-                               of a list of future references*)
-          endlist: boolean;
-          op: instyp; q : address;  (*instruction register*)
    begin
-      if labeltab[x].st=defined then errorl('duplicated label         ')
+      if labeltab[x].st<>entered then errorl('duplicated label         ')
       else begin
-             if labeltab[x].val<>-1 then (*forward reference(s)*)
-             begin curr:= labeltab[x].val; endlist:= false;
-                while not endlist do begin
-                      ad := curr;
-                      op := store[ad]; { get instruction }
-                      q := getadr(ad);
-                      succ:= q; { get target address from that }
-                      q:= labelvalue; { place new target address }
-                      ad := curr;
-                      putadr(ad, q);
-                      if succ=-1 then endlist:= true
-                                 else curr:= succ
-                 end
-             end;
+             patch(labeltab[x].val, labelvalue); 
+             patch(labeltab[x].uv, labelvalue);
              labeltab[x].st := defined;
              labeltab[x].val:= labelvalue;
+             labeltab[x].uv := -1
       end
    end;(*update*)
+
+   { find the label an alias stands for }
+   function labtrg(x: labelrg): labelrg;
+   begin
+      while labeltab[x].st = aliased do x := labeltab[x].val;
+      labtrg := x
+   end;
+
+   { place list of future references a in front of list b }
+   function join(a, b: address): address;
+      var curr, succ: address;
+   begin
+      if a = -1 then join := b
+      else begin
+         curr := a; succ := getadr(curr);
+         while succ <> -1 do begin curr := succ; succ := getadr(curr) end;
+         putadr(curr, b); join := a
+      end
+   end;
+
+   { label x is at an unconditional jump to label y, so it stands for y }
+   procedure alias(x, y: labelrg);
+   begin
+      y := labtrg(y);
+      if labeltab[x].st<>entered then errorl('duplicated label         ')
+      else if y = x then update(x) { jump to itself }
+      else if labeltab[y].st = defined then
+        begin labelvalue := labeltab[y].val; update(x) end
+      else begin
+        labeltab[y].val := join(labeltab[x].val, labeltab[y].val);
+        labeltab[y].uv := join(labeltab[x].uv, labeltab[y].uv);
+        labeltab[x].st := aliased; labeltab[x].val := y; labeltab[x].uv := -1
+      end
+   end;
+
+   { label x is at a return. The jumps to it that can take a return are set
+     aside to get a copy of it once it is assembled }
+   procedure retlab(x: labelrg);
+   begin
+      if labeltab[x].st<>entered then errorl('duplicated label         ')
+      else begin
+        rtchn := join(labeltab[x].uv, rtchn); labeltab[x].uv := -1; 
+        rtadr := pc; labelvalue := pc; update(x)
+      end
+   end;
+
+   { replace the jumps set aside with the return now at rtadr, or failing 
+     that point them at it }
+   procedure thread;
+      var curr: address; i: integer;
+   begin
+      if rtchn <> -1 then begin
+        if (pc > rtadr) and (pc-rtadr <= 1+adrsize) and
+           (store[rtadr] in [14,128,129,130,131,132,204,236,237]) then
+          while rtchn <> -1 do begin
+            curr := rtchn; rtchn := getadr(curr);
+            for i := 0 to pc-rtadr-1 do store[curr-1+i] := store[rtadr+i];
+            thrjmp := thrjmp+1
+          end
+        else patch(rtchn, rtadr);
+        rtchn := -1
+      end
+   end;
    
    procedure getnxt; { get next character }
    begin
@@ -2141,6 +2569,53 @@ procedure load;
      readln(prd);
      iline := iline+1 { next intermediate line }
    end;
+
+   procedure opnbin; { open binary instructions at first use }
+   begin
+     if not binopn then begin reset(prb); binopn := true end
+   end;
+
+   { read word of binary instructions, which must be there }
+   function getbin: integer;
+   var i: integer;
+   begin
+     if eof(prb) then errorl('Binary instructions short');
+     read(prb, i); getbin := i
+   end;
+
+   { check the header of a module's binary instructions, which the '#!' line
+     matches in the intermediate }
+   procedure binhdr;
+   begin
+     if getbin <> binmag then errorl('Binary file format bad   ');
+     if getbin <> binver then errorl('Binary file version bad  ');
+     bincnt := 0
+   end;
+
+   { check the count of instructions that ends a module's binary, which the
+     '#.' line matches in the intermediate }
+   procedure bintrl;
+   begin
+     if getbin <> bincnt then errorl('Binary out of step       ')
+   end;
+
+   { skip binary instruction, giving its header and last operand }
+   procedure binskp(var n, x: integer);
+   var i: integer;
+   begin
+     n := getbin; x := getbin; { header and mnemonic }
+     for i := 1 to n div 2 do x := getbin;
+     bincnt := bincnt+1
+   end;
+
+   { get integer operand, from the binary instruction or the line }
+   function getint: integer;
+   var i: integer;
+   begin
+     if binins then begin i := getbin; binopr := binopr+1 end 
+     else read(prd, i);
+     getint := i
+   end;
    
    procedure getlab;
    var i: 1..fillen;
@@ -2208,6 +2683,21 @@ procedure load;
      end
    end;
    
+   { Place source line start in deck line table. Lines that generate no code
+     share the address of the next line that does, so only the last is kept. }
+   procedure putlin(ad: address; ln: integer);
+   var lp: linptr;
+   begin
+     lp := nil;
+     if lintal <> nil then if lintal^.ad = ad then lp := lintal;
+     if lp = nil then begin
+       new(lp); lp^.next := nil; lp^.ad := ad;
+       if lintal = nil then lintab := lp else lintal^.next := lp;
+       lintal := lp
+     end;
+     lp^.ln := ln
+   end;
+
    procedure flabrlc;
    var ad: address; op: instyp; flp: flabelp; c: char;
    function symref(lsp: strvsp): address;
@@ -2262,6 +2752,171 @@ procedure load;
      else isprog := false
    end;
 
+   { Find the routines and data tables the program reaches. The intermediate
+     is read through once, without assembling it, for the blocks and tables,
+     the near labels each defines and the labels each references. The search
+     starts from the program and module blocks, whose code holds the main
+     block, the exception handlers and the setting of virtual vectors. When a
+     deck is made, generate leaves out the routines and tables not reached.
+     Fixed constants in a module are kept, since other modules reach them by 
+     name. }
+   procedure reach;
+   var ip, bp, wp: rchitp; rp: rchrfp; lp: rchlbp; 
+       modn, x, i, j: integer; ch1, c: char; ls: strvsp; 
+       mods: filnam; modl: integer; dck, stop, f: boolean;
+
+   procedure newitm(var ip: rchitp; up: rchitp; bt: char);
+   begin
+     new(ip); ip^.next := nil; ip^.up := up; ip^.wrk := nil; ip^.name := nil;
+     ip^.btyp := bt; ip^.live := false; ip^.refs := nil;
+     if rchlst = nil then rchlst := ip else rchtal^.next := ip;
+     rchtal := ip
+   end;
+
+   procedure deflab(x: integer; ip: rchitp);
+   var lp: rchlbp; h: integer;
+   begin h := (modn*31+x) mod (rchhsh+1);
+     new(lp); lp^.modn := modn; lp^.lab := x; lp^.itm := ip;
+     lp^.next := rchlbh[h]; rchlbh[h] := lp
+   end;
+
+   function fndlab(mn, x: integer): rchitp;
+   var lp: rchlbp; ip: rchitp;
+   begin ip := nil; lp := rchlbh[(mn*31+x) mod (rchhsh+1)];
+     while lp <> nil do
+       if (lp^.modn = mn) and (lp^.lab = x) then 
+         begin ip := lp^.itm; lp := nil end
+       else lp := lp^.next;
+     fndlab := ip
+   end;
+
+   procedure mark(ip: rchitp);
+   begin
+     if not ip^.live then begin ip^.live := true; ip^.wrk := wp; wp := ip end
+   end;
+
+   begin
+     for i := 0 to rchhsh do rchlbh[i] := nil;
+     new(rchrt); rchrt^.next := nil; rchrt^.up := nil; rchrt^.wrk := nil; 
+     rchrt^.name := nil; rchrt^.btyp := 'p'; rchrt^.live := true; 
+     rchrt^.refs := nil;
+     bp := rchrt; modn := 0; modl := 0; dck := false; stop := false;
+     while not eof(prd) and not stop do begin
+       getnxt; { first character of line }
+       if ch = 'b' then begin { block }
+         getnxt; skpspc; ch1 := ch; getnxt; skpspc; getlabe;
+         newitm(ip, bp, ch1);
+         if ch1 in ['p', 'm'] then begin
+           modn := modn+1; ip^.live := true; mods := sn; modl := snl
+         end else if bp^.btyp in ['p', 'm'] then begin
+           { routine in module, give it the name a far label would have }
+           strassvf(ip^.name, mods); strchrass(ip^.name, modl+1, '.'); 
+           i := modl+2;
+           for j := 1 to snl do begin strchrass(ip^.name, i, sn[j]); i := i+1 end
+         end;
+         bp := ip
+       end else if ch = 'e' then begin { end block }
+         if bp^.up = nil then errorl('No block to end          ');
+         bp := bp^.up
+       end else if ch = 'l' then begin { label }
+         getnxt; parlab(x, ls);
+         if ls <> nil then errorl('Invalid intermediate     ');
+         deflab(x, bp)
+       end else if ch in ['t', 'v', 'n'] then begin { data table }
+         ch1 := ch; getnxt; skpspc;
+         if ch <> 'l' then errorl('Label format error       ');
+         getnxt; parlab(x, ls);
+         if ls <> nil then errorl('Invalid intermediate     ');
+         newitm(ip, bp, ' ');
+         if ch1 = 'n' then ip^.live := bp^.btyp in ['p', 'm'];
+         deflab(x, ip)
+       end else if ch = ' ' then begin { instruction }
+         f := false; { not in string }
+         while not eoln(prd) do begin
+           c := ch; getnxt;
+           if ch = '''' then f := not f
+           else if not f and (c = ' ') and (ch = 'l') and (prd^ = ' ') then 
+             begin
+             getnxt; parlab(x, ls);
+             new(rp); rp^.modn := modn; rp^.lab := x; rp^.fl := ls;
+             rp^.next := bp^.refs; bp^.refs := rp
+           end
+         end
+       end else if ch = '#' then begin opnbin;
+         if prd^ = '!' then binhdr { start of module binary }
+         else if prd^ = '.' then bintrl { end of module binary }
+         else begin binskp(j, x); { binary instruction }
+           if odd(j) then begin { last operand is a near label }
+             new(rp); rp^.modn := modn; rp^.lab := x; rp^.fl := nil;
+             rp^.next := bp^.refs; bp^.refs := rp
+           end
+         end
+       end else if ch = 'o' then begin { options, find if deck is made }
+         while not eoln(prd) do begin
+           c := ch; getnxt;
+           if c = 'e' then if ch in ['+', '-'] then dck := ch = '+'
+         end
+       end else if ch = 'q' then stop := true;
+       getlin
+     end;
+     wp := nil;
+     if dck then begin
+       { search from the blocks always reached }
+       ip := rchlst;
+       while ip <> nil do begin
+         if ip^.live then begin ip^.wrk := wp; wp := ip end;
+         ip := ip^.next
+       end;
+       rchrt^.wrk := wp; wp := rchrt;
+       while wp <> nil do begin
+         bp := wp; wp := wp^.wrk; rp := bp^.refs;
+         while rp <> nil do begin
+           if rp^.fl = nil then begin
+             ip := fndlab(rp^.modn, rp^.lab);
+             if ip <> nil then mark(ip)
+           end else begin { far label, reach routines of that name }
+             ip := rchlst;
+             while ip <> nil do begin
+               if ip^.name <> nil then if strequvv(ip^.name, rp^.fl) then
+                 mark(ip);
+               ip := ip^.next
+             end
+           end;
+           rp := rp^.next
+         end
+       end
+     end else begin { no deck, keep all }
+       ip := rchlst;
+       while ip <> nil do begin ip^.live := true; ip := ip^.next end
+     end;
+     { release labels and references }
+     for i := 0 to rchhsh do 
+       while rchlbh[i] <> nil do begin
+         lp := rchlbh[i]; rchlbh[i] := lp^.next; dispose(lp)
+       end;
+     bp := rchrt;
+     while bp <> nil do begin
+       while bp^.refs <> nil do begin
+         rp := bp^.refs; bp^.refs := rp^.next; 
+         if rp^.fl <> nil then putstrs(rp^.fl);
+         dispose(rp)
+       end;
+       if bp = rchrt then bp := rchlst else bp := bp^.next
+     end;
+     { start again for assembly }
+     reset(prd); iline := 1;
+     if binopn then reset(prb);
+     rchnxt := rchlst
+   end;
+
+   { find if routine or data table is generated }
+   function reached(ip: rchitp): boolean;
+   begin reached := true; if ip <> nil then reached := ip^.live end;
+
+   { get next reachability item }
+   procedure nxtitm(var ip: rchitp);
+   begin ip := rchnxt; if rchnxt <> nil then rchnxt := rchnxt^.next end;
+
    procedure assemble; forward;
 
    procedure generate;(*generate segment of code*)
@@ -2269,6 +2924,7 @@ procedure load;
           again: boolean;
           c,ch1: char;
           i,l: integer;
+          ar,aa,ah,ag: integer; { layout }
           ext: packed array [1..4] of char;
           bp: pblock;
           sp: psymbol;
@@ -2276,7 +2932,9 @@ procedure load;
           sgn: boolean;
           ls: strvsp;
           csttab: boolean;
+          cstskp: boolean; { constant table left out }
           cstadr: address;
+          ip: rchitp;
           r: real;
           s: settype;
           
@@ -2295,33 +2953,60 @@ procedure load;
    end;
 
    begin (*generate*)
-     again := true; csttab := false;
+     again := true; csttab := false; cstskp := false;
      while again do begin 
        if eof(prd) then errorl('unexpected eof on input  ');
        getnxt;(* first character of line*)
-       if not (ch in ['!', 'l', 'q', ' ', ':', 'o', 'g', 'b',
-                      'e', 's', 'f','v','t','n','c','x']) then
+       if not (ch in ['!', 'l', 'q', ' ', ':', 'o', 'g', 'b', 'a',
+                      'e', 's', 'f','v','t','n','c','x','#']) then
          errorl('unexpected line start    ');
        case ch of
          '!': getlin; { comment }
          'l': begin getnxt; parlab(x,ls);
                     if ls <> nil then 
                       errorl('Invalid intermediate     ');
-                    getnxt;
-                    if ch='=' then read(prd,labelvalue)
-                              else labelvalue:= pc;
-                    update(x); getlin
+                    getnxt; inctb := false;
+                    if ch='=' then begin
+                      if prd^ = 'l' then begin { alias of another label }
+                        getnxt; getnxt; parlab(l,ls);
+                        if ls <> nil then 
+                          errorl('Invalid intermediate     ');
+                        alias(x, l)
+                      end else if prd^ = 'r' then retlab(x) { at a return }
+                      else begin read(prd,labelvalue); update(x) end
+                    end else begin labelvalue:= pc; update(x) end;
+                    getlin
               end;
          'q': begin again := false; getlin end;
+         'a': begin { layout the compiler was built for }
+                read(prd,i,l,ar,aa,ah,ag);
+                if (i <> intsize) or (l <> intal) or (ar <> realal) or 
+                   (aa <> adral) or (ah <> heapal) or (ag <> gbsal) then
+                  errorl('Layout does not match    ');
+                getlin
+              end;
          ' ': begin getnxt; 
                     while not eoln(prd) and (ch = ' ') do getnxt;
-                    if not eoln(prd) and (ch <> ' ') then assemble
-                    else getlin 
+                    if not eoln(prd) and (ch <> ' ') then begin
+                      if reached(rchblk) then begin assemble; thread end
+                      else begin rchins := rchins+1; getlin end
+                    end else getlin 
               end;
-         ':': begin { source line }
+         '#': begin opnbin;
+                if prd^ = '!' then begin binhdr; getlin end { module start }
+                else if prd^ = '.' then begin bintrl; getlin end { end }
+                else if reached(rchblk) then begin { binary instruction }
+                  binins := true; bincnt := bincnt+1; assemble; 
+                  binins := false; thread
+                end else begin { skip its operands }
+                  binskp(i, x); rchins := rchins+1; getlin
+                end
+              end;
+         ':': if not reached(rchblk) then getlin else begin { source line }
                  read(prd,x); { get source line number }
                  { place in line tracking }
                  if curmod <> nil then curmod^.lintrk^[x] := pc; 
+                 putlin(pc, x); { place in deck line table }
                  if dosrclin then begin
                     { pass source line register instruction }
                     store[pc] := 174; putdef(pc, true); pc := pc+1;
@@ -2385,6 +3070,8 @@ procedure load;
                   'f': bp^.btyp := btfunc
                 end;
                 bp^.bend := -1;
+                nxtitm(rchblk);
+                if not reached(rchblk) then rchrts := rchrts+1;
                 if blkstk <> nil then begin 
                   { process block inclusions }
                   bp^.incnxt := blkstk^.incnxt; { insert to list }
@@ -2433,6 +3120,7 @@ procedure load;
                 blkstk^.bend := pc;
                 bp := blkstk; { remove from block stack }
                 blkstk := blkstk^.next;
+                if rchblk <> nil then rchblk := rchblk^.up;
                 bp^.next := blklst; { put to discard list }
                 blklst := bp;
                 if blkstk <> nil then blkstk^.bstart := pc;
@@ -2480,13 +3168,16 @@ procedure load;
                 if ls <> nil then 
                   errorl('Invalid intermediate     ');
                 getnxt;
-                read(prd,l); cp := cp-(l*intsize+intsize); 
-                ad := cp; putint(ad, l); ad := ad+intsize;
-                while not eoln(prd) do begin
-                  read(prd,i); putint(ad, i); ad := ad+intsize;
-                end;
-                labelvalue:=cp;
-                update(x);
+                read(prd,l); nxtitm(ip);
+                if reached(ip) then begin
+                  cp := cp-(l*intsize+intsize); 
+                  ad := cp; putint(ad, l); ad := ad+intsize;
+                  while not eoln(prd) do begin
+                    read(prd,i); putint(ad, i); ad := ad+intsize;
+                  end;
+                  labelvalue:=cp;
+                  update(x)
+                end else rchbyt := rchbyt+l*intsize+intsize;
                 getlin
               end;
          't': begin { fixed template }
@@ -2497,12 +3188,15 @@ procedure load;
                 if ls <> nil then 
                   errorl('Invalid intermediate     ');
                 getnxt;
-                read(prd,l); cp := cp-(l*intsize); ad := cp;
-                while not eoln(prd) do begin
-                  read(prd,i); putint(ad, i); ad := ad+intsize;
-                end;
-                labelvalue:=cp;
-                update(x);
+                read(prd,l); nxtitm(ip);
+                if reached(ip) then begin
+                  cp := cp-(l*intsize); ad := cp;
+                  while not eoln(prd) do begin
+                    read(prd,i); putint(ad, i); ad := ad+intsize;
+                  end;
+                  labelvalue:=cp;
+                  update(x)
+                end else rchbyt := rchbyt+l*intsize;
                 getlin
               end;
          'n': begin { start constant table }
@@ -2519,8 +3213,11 @@ procedure load;
                 { Note the constant table must start on maximium 
                   natural alignment to match it's structure type.
                   We use stackal for that. }
-                read(prd,l); cp := cp-l; alignd(stackal, cp);
-                cstadr := cp; labelvalue:=cstadr; update(x);
+                read(prd,l); nxtitm(ip);
+                if reached(ip) then begin
+                  cp := cp-l; alignd(stackal, cp);
+                  cstadr := cp; labelvalue:=cstadr; update(x)
+                end else begin cstskp := true; rchbyt := rchbyt+l end;
                 getlin
                 { note mixed constants with other operands is 
                   neither encouraged nor forbidden }
@@ -2528,10 +3225,10 @@ procedure load;
          'x': begin
                 if not csttab then
                   errorl('No constant table active ');
-                csttab := false;
+                csttab := false; cstskp := false;
                 getlin
               end;
-         'c': begin
+         'c': if cstskp then getlin else begin
                 getnxt; skpspc;
                 if not (ch in ['i','r','p','s','c','b','x'])
                   then errorl('Invalid const table type ');
@@ -2610,12 +3307,16 @@ procedure load;
       
    procedure assemble; (*translate symbolic code into machine code and store*)
       var name :alfa; r :real; s :settype;
-          i,x,s1,lb,ub,l:integer; c: char;
+          i,x,s1,lb,ub,l:integer; c: char; ocp: address;
           str: packed array [1..stringlgth] of char; { buffer for string constants }
 
       procedure lookup(x: labelrg); (* search in label table*)
-      begin case labeltab[x].st of
-                entered: begin q := labeltab[x].val;
+      begin x := labtrg(x);
+            case labeltab[x].st of
+                entered: if (op = 23(*ujp*)) and not inctb then begin
+                           { may get a copy of a return instead }
+                           q := labeltab[x].uv; labeltab[x].uv := pc
+                         end else begin q := labeltab[x].val;
                            labeltab[x].val := pc
                          end;
                 defined: q:= labeltab[x].val
@@ -2624,12 +3325,16 @@ procedure load;
 
       procedure labelsearch;
          var x: integer; sp: strvsp; flp: flabelp;
-      begin skpspc; if ch <> 'l' then errorl('Label format error       ');
+      begin 
+        if binins then lookup(getint) { binary is near labels only }
+        else begin
+            skpspc; if ch <> 'l' then errorl('Label format error       ');
             getnxt; parlab(x,sp); 
             if sp <> nil then begin { far label }
               new(flp); flp^.next := flablst; flablst := flp; 
               flp^.val := pc; flp^.ref := sp; q := 0
             end else lookup(x) { near label }
+        end
       end;(*labelsearch*)
       
       procedure putcstfix;
@@ -2661,19 +3366,28 @@ procedure load;
       end; (*getname*)
 
    begin  p := 0;  q := 0;  op := 0; (*assemble*)
-      getname;
-      { note this search removes the top instruction from use }
-      while (instr[op]<>name) and (op < maxins) do op := op+1;
-      if op = maxins then errorl('illegal instruction      ');
+      if binins then begin
+        { header, the operands follow the instruction format }
+        binhd := getbin; binopr := 0;
+        x := binsch(getbin);
+        if binh[x] = -1 then errorl('illegal instruction      ');
+        op := binh[x]
+      end else begin
+        getname;
+        x := inssch(name);
+        if insh[x] = -1 then errorl('illegal instruction      ');
+        op := insh[x]
+      end;
       case op of  (* get parameters p,q *)
 
-          (*lod,str,lda,lip*)
+          (*lod,str,lda,lip,lgs,bfd*)
           0, 193, 105, 106, 107, 108, 109, 195,
-          2, 70, 71, 72, 73, 74,4,120: begin read(prd,p,q); storeop; storep;
+          2, 70, 71, 72, 73, 74,4,120,254,255: begin p := getint; q := getint;
+                                             storeop; storep;
                                              storeq
                                        end;
 
-          12,11(*cup,mst*): begin read(prd,p); storeop; storep; labelsearch; storeq end;
+          12,11,244,245(*cup,mst,msl,cut*): begin p := getint; storeop; storep; labelsearch; storeq end;
                      
           91(*suv*): begin storeop; labelsearch; storeq;
                      while not eoln(prd) and (prd^ = ' ') do read(prd,ch);
@@ -2682,7 +3396,7 @@ procedure load;
                      if q > exceptiontop then q := q+gbloff;
                      putgblfix; storeq end;
 
-          113(*cip*): begin read(prd,p); storeop; storep end;
+          113(*cip*): begin p := getint; storeop; storep end;
 
           { equm,neqm,geqm,grtm,leqm,lesm take a parameter }
           142, 148, 154, 160, 166, 172,
@@ -2690,17 +3404,20 @@ procedure load;
           (*ixa,mov,dmp,swp*)
           16,55,117,118,
 
-          (*ind,inc,dec,ckv,vbs,cpc,aps,cxs,max,retm,lsa*)
+          (*ind,inc,dec,ckv,vbs,cpc,aps,cxs,max,retm,lsa,xjs,swf*)
           198, 9, 85, 86, 87, 88, 89,10, 90, 93, 94,57,103,104,175,177,178,
-          179, 180, 201, 202,203,211,214,237,241,
-          92: begin read(prd,q); storeop; storeq end;
+          179, 180, 201, 202,203,211,214,237,241,243,252,
+          92: begin q := getint; storeop; storeq end;
           
           (*ldo,sro,lao,cuv*)
           1, 194, 65, 66, 67, 68, 69,
           3,196,75,76,77,78,79,27, 
-          5: begin while not eoln(prd) and (prd^ = ' ') do read(prd,ch); 
+          5: begin 
+                   if not binins then
+                     while not eoln(prd) and (prd^ = ' ') do read(prd,ch); 
                    storeop;
-                   if prd^ = 'l' then begin getnxt; labelsearch end 
+                   if binins then q := getint
+                   else if prd^ = 'l' then begin getnxt; labelsearch end 
                    else read(prd,q);
                    if q > exceptiontop then q := q+gbloff;
                    putgblfix; storeq end;
@@ -2724,12 +3441,12 @@ procedure load;
                end;
 
           (*pck,upk,vis,vip,apc,cxc,ccs,vin,stom,ctb,cpp,cpr*)
-          63, 64,122,133,210,212,223,226,235,238,239,240: begin read(prd,q); read(prd,q1); storeop; 
+          63, 64,122,133,210,212,223,226,235,238,239,240: begin q := getint; q1 := getint; storeop; 
                                         storeq; storeq1 end;
                                   
           (*cta,ivt,cvb*)
           191, 192, 100,101,102,111,115,116,121: begin 
-            read(prd,q); read(prd,q1); storeop; storeq; storeq1; labelsearch; 
+            q := getint; q1 := getint; storeop; storeq; storeq1; labelsearch; 
             putcstfix; storeq 
           end;
           
@@ -2743,37 +3460,38 @@ procedure load;
           13, 173: begin storeop; labelsearch; storeq end;
 
           (*ipj,lpa*)
-          112,114: begin read(prd,p); storeop; storep; labelsearch; storeq end;
+          112,114: begin p := getint; storeop; storep; labelsearch; storeq end;
 
           15 (*csp*): begin skpspc; getname;
-                           while name<>sptable[q] do
-                           begin q := q+1; if q > maxsp then
-                                 errorl('std proc/func not found  ')
-                           end; storeop;
+                           x := spsch(name);
+                           if sph[x] = -1 then 
+                             errorl('std proc/func not found  ');
+                           q := sph[x]; storeop;
                            if pc+1 > cp then
                              errorl('Program code overflow    ');
                            store[pc] := q; putdef(pc, true); pc := pc+1
                       end;
 
           7, 123, 124, 125, 126, 127 (*ldc*): begin case op of  (*get q*)
-                           123: begin read(prd,i); storeop;
+                           123: begin i := getint; storeop;
                                       if pc+intsize > cp then
                                          errorl('Program code overflow    ');
                                       putint(pc, i); pc := pc+intsize
                                 end;
 
-                           124: begin read(prd,r);
+                           124: begin read(prd,r); ocp := cp;
                                       aligndc(realal, cp);
                                       cp := cp-realsize;
                                       if cp <= 0 then
                                          errorl('constant table overflow  ');
-                                      putrel(cp, r); q := cp;
+                                      putrel(cp, r); 
+                                      cstdup(ocp, realsize, realal, q);
                                       storeop; putcstfix; storeq
                                 end;
 
                            125: storeop; (*p,q = 0*)
 
-                           126: begin read(prd,q); storeop;
+                           126: begin q := getint; storeop;
                                       if pc+1 > cp then
                                         errorl('Program code overflow    ');
                                       putbol(pc, q <> 0); pc := pc+1 end;
@@ -2804,31 +3522,31 @@ procedure load;
                                    while ch<>')' do
                                    begin read(prd,s1); getnxt; s := s + [s1]
                                    end;
-                                   aligndc(setal, cp);
+                                   ocp := cp; aligndc(setal, cp);
                                    cp := cp-setsize;
                                    if cp <= 0 then
                                       errorl('constant table overflow  ');
                                    putset(cp, s);
-                                   q := cp;
+                                   cstdup(ocp, setsize, setal, q);
                                    storeop; putcstfix; storeq
                                 end
                            end (*case*)
                      end;
 
-           26, 95, 97, 98, 99, 190, 199,8 (*chk,cjp*): begin
-                         read(prd,lb,ub); storeop;
+           26, 95, 97, 98, 99, 190, 199,8,242 (*chk,cjp,xjt*): begin
+                         lb := getint; ub := getint; storeop;
                          { cjp is compare with jump }
                          if op = 8 then begin labelsearch; q1 := q end;
                          if (op = 95) or (op = 190) then begin
                            q := lb; storeq
                          end else begin
-                           aligndc(setal, cp);
+                           ocp := cp; aligndc(setal, cp);
                            cp := cp-intsize;
                            if cp <= 0 then errorl('constant table overflow  ');
                            putint(cp, ub);
                            cp := cp-intsize;
                            if cp <= 0 then errorl('constant table overflow  ');
-                           putint(cp, lb); q := cp;
+                           putint(cp, lb); cstdup(ocp, intsize*2, setal, q);
                            putcstfix; storeq
                          end;
                          if op = 8 then storeq1
@@ -2851,10 +3569,11 @@ procedure load;
                            end
                          until c = '''';
                          { place in storage }
-                         cp := cp-l;
+                         ocp := cp; cp := cp-l;
                          if cp <= 0 then errorl('constant table overflow  ');
-                         q := cp;
-                         for x := 1 to l do putchr(q+x-1, str[x]);
+                         for x := 1 to l do putchr(cp+x-1, str[x]);
+                         { share a copy already placed }
+                         cstdup(ocp, l, 1, q);
                          { this should have worked, the for loop is faulty
                            because the calculation for end is done after the i
                            set
@@ -2885,20 +3604,33 @@ procedure load;
           48,49,50,51,52,53,54,60,62,110,
           205,206,208,209,135,176,215,216,217,218,219,220,221,222,224,225,227,
 
+          { sgw, rgw, inw, dfw, lew, gew, sfw }
+          246, 247, 248, 249, 250, 251, 253,
+
           { dupi, dupa, dupr, dups, dupb, dupc, cks, cke, inv, cal, vbe }
           181, 182, 183, 184, 185, 186,187,188,189,22,96: storeop;
 
-                      (*ujc must have same length as ujp, so we output a dummy
-                        q argument*)
-          61 (*ujc*): begin storeop; q := 0; storeq end;
+                      (*ujc must have same length as ujp, so we output a q
+                        argument. It points to the ujc itself, so that a jump
+                        table dispatch through it lands on the ujc*)
+          61 (*ujc*): begin storeop; q := pc-1; storeq end;
 
       end; (*case*)
+      { case table entries are kept as jumps }
+      inctb := (op in [242(*xjt*),243(*xjs*)]) or 
+               inctb and (op in [8(*cjp*),23(*ujp*),61(*ujc*)]);
+      if binins then if binopr <> binhd div 2 then 
+        errorl('Binary operand count bad ');
 
       getlin { next intermediate line }
    end; (*assemble*)
    
 begin (*load*)
   init;
+  { !!! remove this next statement for self compile }
+#ifndef SELF_COMPILE
+  reach; { find what the program reaches }
+#endif
   pc := 0;
   { insert start sequence:
   
@@ -2913,6 +3645,7 @@ begin (*load*)
   op := 58; storeop; { stp }
   generate;
   if not gbset then errorl('global space not set     ');
+  if binopn then if not eof(prb) then errorl('Binary instructions left ');
   pctop := pc; { save top of code store }
   lsttop := pctop; { save as top of listing }
   alignuc(gbsal, pctop); { align end of code block }
@@ -2924,6 +3657,8 @@ begin (*load*)
   alignuc(gbsal, pctop); { align end of constants block }
   gbtop := pctop+gbsiz;
   alignu(gbsal, gbtop);
+  { place the heap so that the space after each block header is aligned }
+  gbtop := gbtop+adrsize; alignu(heapal, gbtop); gbtop := gbtop-adrsize;
   { relocate constants deck }
   if cstfixi >= 1 then for ci := 1 to cstfixi do 
     begin ad := cstfixtab[ci]; putadr(ad, getadr(ad)+crf) end;
@@ -2936,6 +3671,16 @@ begin (*load*)
   if npadr < 0 then errorl('Heap bottom not set      ');
   putadr(npadr, gbtop);
   flabrlc; { link far labels }
+  if rchrts+rchbyt > 0 then
+    writeln('Unreached: ', rchrts:1, ' routines, ', rchins:1, 
+            ' instructions, ', rchbyt:1, ' bytes of data tables left out');
+  { release reachability items }
+  while rchlst <> nil do begin
+    rchblk := rchlst; rchlst := rchlst^.next;
+    if rchblk^.name <> nil then putstrs(rchblk^.name);
+    dispose(rchblk)
+  end;
+  if rchrt <> nil then dispose(rchrt);
   if dodmplab then dmplabs { Debug: dump label definitions }
 end; (*load*)
 
@@ -2943,28 +3688,95 @@ end; (*load*)
 
 { runtime handlers }
 
+{ find if block a sorts before block b }
+function varbfr(a, b: varptr): boolean;
+begin
+  varbfr := (a^.s < b^.s) or ((a^.s = b^.s) and (a^.sn < b^.sn))
+end;
+
+{ recalculate maximum end address of treap node }
+procedure varfix(t: varptr);
+begin
+  t^.m := t^.e;
+  if t^.l <> nil then if t^.l^.m > t^.m then t^.m := t^.l^.m;
+  if t^.r <> nil then if t^.r^.m > t^.m then t^.m := t^.r^.m
+end;
+
+{ insert node into treap }
+function varins(t, n: varptr): varptr;
+var c: varptr;
+begin
+  if t <> nil then begin
+    if varbfr(n, t) then begin
+      t^.l := varins(t^.l, n);
+      if t^.l^.p > t^.p then begin { rotate right }
+        c := t^.l; t^.l := c^.r; varfix(t); c^.r := t; t := c
+      end
+    end else begin
+      t^.r := varins(t^.r, n);
+      if t^.r^.p > t^.p then begin { rotate left }
+        c := t^.r; t^.r := c^.l; varfix(t); c^.l := t; t := c
+      end
+    end;
+    varfix(t); varins := t
+  end else varins := n
+end;
+
+{ join treaps, all of which a sorts before b }
+function varjoin(a, b: varptr): varptr;
+begin
+  if a = nil then varjoin := b
+  else if b = nil then varjoin := a
+  else if a^.p > b^.p then begin
+    a^.r := varjoin(a^.r, b); varfix(a); varjoin := a
+  end else begin
+    b^.l := varjoin(a, b^.l); varfix(b); varjoin := b
+  end
+end;
+
+{ remove node from treap }
+function vardel(t, n: varptr): varptr;
+begin
+  if t = n then vardel := varjoin(t^.l, t^.r)
+  else begin
+    if varbfr(n, t) then t^.l := vardel(t^.l, n)
+    else t^.r := vardel(t^.r, n);
+    varfix(t); vardel := t
+  end
+end;
+
 procedure varenter(s, e: address);
 var vp: varptr;
 begin
   if varfre <> nil then begin vp := varfre; varfre := vp^.next end
   else new(vp);
-  vp^.s := s; vp^.e := e; vp^.next := varlst; varlst := vp
+  vp^.s := s; vp^.e := e; vp^.next := varlst; varlst := vp;
+  vp^.l := nil; vp^.r := nil; vp^.m := e; vp^.sn := varseq;
+  varseq := varseq+1;
+  varsed := (varsed*25173+13849) mod 65536; vp^.p := varsed;
+  vartre := varins(vartre, vp)
 end;
 
 procedure varexit;
 var vp: varptr;
 begin
   if varlst = nil then errorv(VarListEmpty);
-  vp := varlst; varlst := vp^.next; vp^.next := varfre; varfre := vp
+  vp := varlst; varlst := vp^.next; vp^.next := varfre; varfre := vp;
+  vartre := vardel(vartre, vp)
 end;
 
 function varlap(s, e: address): boolean;
-var vp: varptr; f: boolean;
+var vp: varptr; f, lft: boolean;
 begin
-  vp := varlst; f := false;
+  { if the left subtree reaches s, any overlap to the right would start past
+    e, so it is enough to look left }
+  vp := vartre; f := false;
   while (vp <> nil) and not f do begin
     f := (vp^.e >= s) and (vp^.s <= e);
-    vp := vp^.next 
+    lft := false; if vp^.l <> nil then lft := vp^.l^.m >= s;
+    if lft then vp := vp^.l
+    else if vp^.s <= e then vp := vp^.r
+    else vp := nil
   end;
   
   varlap := f
@@ -3163,7 +3975,8 @@ begin
      ad := np; { save base of new block }
      np := np+(len+adrsize); { find new heap top }
      ad1 := np; { save address }
-     alignu(heapal, np); { align to arena }
+     { align to arena, which is the space after the next block header }
+     np := np+adrsize; alignu(heapal, np); np := np-adrsize;
      len := len+(np-ad1); { adjust length upwards for alignment }
      if np > sp then errore(SpaceAllocateFail);
      putadr(ad, -(len+adrsize)); { allocate block }
@@ -4485,6 +5298,20 @@ begin
                  (* idem *)
                 end;
 
+    244 (*msl*): begin (*mark stack for a routine that never uses its static
+                        link, p and q as mst*)
+                 getp; getq;
+                 { allocate function result as zeros }
+                 for j := 1 to q div intsize do pshint(0);
+                 ad := sp; { save mark base }
+                 { allocate mark, the routine entry and cup fill the rest }
+                 sp := sp-marksize;
+                 { sl is kept for the debugger's frame walks }
+                 putadr(ad+marksl, base(p)); { sl }
+                 putadr(ad+markdl, mp); { dl }
+                 putadr(ad+markep, ep) { ep }
+                end;
+
     12 (*cup*): begin (*p=no of locations for parameters, q=entry point*)
                  getp; getq;
                  mp := sp+(p+marksize); { mp to base of mark }
@@ -4492,6 +5319,32 @@ begin
                  pc := q
                 end;
                 
+    245 (*cut*): begin (*p=no of locations for parameters, q=entry point of
+                        the calling routine itself*)
+                 getp; getq;
+                 { if the return follows, directly or by a jump, reuse the
+                   frame: the parameters replace ours and we restart. The
+                   line marks for the lines in between are passed over }
+                 ad := pc;
+                 while store[ad] = mrkins do ad := ad+1+intsize;
+                 if store[ad] = 23 (*ujp*) then begin
+                   ad := getadr(ad+1);
+                   while store[ad] = mrkins do ad := ad+1+intsize
+                 end;
+                 b := store[ad] = 14 (*retp*);
+                 if b then begin evict(ep, mp);
+                   ad := mp-marksize-p; { our parameters }
+                   for i := 0 to p-1 do begin
+                     store[ad+i] := store[sp+i]; putdef(ad+i, getdef(sp+i))
+                   end;
+                   sp := ad
+                 end else begin
+                   mp := sp+(p+marksize); { mp to base of mark }
+                   putadr(mp+markra, pc) { place ra }
+                 end;
+                 pc := q
+                end;
+
     27 (*cuv*): begin (*q=entry point*)
                  getq;
                  mp := sp+(p+marksize); { mp to base of mark }
@@ -4635,6 +5488,25 @@ begin
     23 (*ujp*): begin getq; pc := q end;
     24 (*fjp*): begin getq; popint(i); if i = 0 then pc := q end;
     25 (*xjp*): begin getq; popint(i1); pc := i1*ujplen+q end;
+    242 (*xjt*): begin getq; popint(i1);
+                   if (i1 < getint(q)) or (i1 > getint(q+intsize)) then begin
+                     { out of range goes to the first entry, the else case }
+                     if store[pc] = 61 (*ujc*) then errore(ValueOutOfRange);
+                     pc := getadr(pc+1)
+                   end else pc := getadr(pc+(i1-getint(q)+1)*ujplen+1)
+                 end;
+    243 (*xjs*): begin getq; popint(i1);
+                   { binary search the cjp entries for the range holding the
+                     value, a miss executes the entry after the table }
+                   i2 := 0; i3 := q-1; ad := pc+q*cjplen; b := false;
+                   while (i2 <= i3) and not b do begin
+                     i := (i2+i3) div 2; ad1 := pc+i*cjplen; a1 := getadr(ad1+1);
+                     if i1 < getint(a1) then i3 := i-1
+                     else if i1 > getint(a1+intsize) then i2 := i+1
+                     else begin b := true; ad := getadr(ad1+1+adrsize) end
+                   end;
+                   pc := ad
+                 end;
 
     95 (*chka*),
     190 (*ckla*): begin getq; popadr(a1); pshadr(a1);
@@ -4755,6 +5627,42 @@ begin
     46 (*int*): begin popset(s2); popset(s1); pshset(s1*s2) end;
     47 (*uni*): begin popset(s2); popset(s1); pshset(s1+s2) end;
     48 (*inn*): begin popset(s1); popint(i1); pshint(ord(i1 in s1)) end;
+    246 (*sgw*): begin popint(i1);
+                   if (i1 < 0) or (i1 > wsethigh) then 
+                     errore(SetElementOutOfRange);
+                   pshint(wbit(i1)) end;
+    247 (*rgw*): begin popint(i2); popint(i1);
+                   if i1 > i2 then pshint(0)
+                   else begin
+                     if (i1 < 0) or (i2 > wsethigh) then 
+                       errore(SetElementOutOfRange);
+                     { bits i1..i2, without overflow at the top bit }
+                     pshint(wbit(i2)-wbit(i1)+wbit(i2))
+                   end
+                 end;
+    248 (*inw*): begin popint(i2); popint(i1); b := false;
+                   if (i1 >= 0) and (i1 <= wsethigh) then 
+                     b := odd(i2 div wbit(i1));
+                   pshint(ord(b)) end;
+    249 (*dfw*): begin popint(i2); popint(i1); pshint(band(i1, bnot(i2))) end;
+    250 (*lew*): begin popint(i2); popint(i1); 
+                   pshint(ord(band(i1, bnot(i2)) = 0)) end;
+    251 (*gew*): begin popint(i2); popint(i1); 
+                   pshint(ord(band(i2, bnot(i1)) = 0)) end;
+    252 (*swf*): begin getq; { q = offset of the word set from the top }
+                   wrdtoset(getint(sp+q), s1); ad := sp; 
+                   sp := sp-(setsize-intsize);
+                   for i := 0 to q-1 do begin
+                     store[sp+i] := store[ad+i]; putdef(sp+i, getdef(ad+i))
+                   end;
+                   putset(sp+q, s1)
+                 end;
+    253 (*sfw*): begin popset(s1); i1 := 0;
+                   for j := setlow to sethigh do if j in s1 then begin
+                     if j > wsethigh then errore(SetElementOutOfRange);
+                     i1 := i1+wbit(j)
+                   end;
+                   pshint(i1) end;
     49 (*mod*): begin popint(i2); popint(i1);
                   if dochkovf then if i2 <= 0 then 
                     errore(InvalidDivisorToMod);
@@ -5053,10 +5961,168 @@ begin
                  
     241 (*lsa*): begin getq; pshadr(sp+q) end;
 
+    254 (*lgs*): begin getp; getq; { p = operation, q = size of sets }
+                   case p of
+                     0 (*lod*): begin popadr(ad); sp := sp-q; lsmov(sp, ad, q) end;
+                     1 (*sto*): begin ad := getadr(sp+q); lsmov(ad, sp, q); 
+                                  sp := sp+q+adrsize end;
+                     2, 3, 4 (*uni,int,dif*): begin lschk(sp, q); lschk(sp+q, q);
+                       for i := 0 to q-1 do
+                         if p = 2 then 
+                           store[sp+q+i] := bor(store[sp+q+i], store[sp+i])
+                         else if p = 3 then 
+                           store[sp+q+i] := band(store[sp+q+i], store[sp+i])
+                         else 
+                           store[sp+q+i] := band(store[sp+q+i], 255-store[sp+i]);
+                       sp := sp+q
+                     end;
+                     5, 6 (*equ,neq*): begin lschk(sp, q); lschk(sp+q, q); 
+                       b := true;
+                       for i := 0 to q-1 do 
+                         if store[sp+q+i] <> store[sp+i] then b := false;
+                       sp := sp+q*2; if p = 6 then b := not b; pshint(ord(b))
+                     end;
+                     7, 8 (*leq,geq*): begin lschk(sp, q); lschk(sp+q, q); 
+                       b := true;
+                       for i := 0 to q-1 do
+                         if p = 7 then begin
+                           if band(store[sp+q+i], 255-store[sp+i]) <> 0 then 
+                             b := false
+                         end else
+                           if band(store[sp+i], 255-store[sp+q+i]) <> 0 then
+                             b := false;
+                       sp := sp+q*2; pshint(ord(b))
+                     end;
+                     9 (*sgs*): begin popint(i1);
+                       if (i1 < 0) or (i1 >= q*8) then 
+                         errore(SetElementOutOfRange);
+                       sp := sp-q; lsclr(sp, q); lsset(sp, i1)
+                     end;
+                     10 (*rgs*): begin popint(i2); popint(i1);
+                       if i1 <= i2 then if (i1 < 0) or (i2 >= q*8) then
+                         errore(SetElementOutOfRange);
+                       sp := sp-q; lsclr(sp, q);
+                       for i := i1 to i2 do lsset(sp, i)
+                     end;
+                     11 (*inn*): begin lschk(sp, q); i1 := getint(sp+q); 
+                       b := false;
+                       if (i1 >= 0) and (i1 < q*8) then b := lsbit(sp, i1);
+                       sp := sp+q+intsize; pshint(ord(b))
+                     end;
+                     12 (*sfl*): begin { full set under i1 bytes to large }
+                       popint(i1); getset(sp+i1, s1); ad := sp;
+                       sp := sp-(q-setsize); lsmov(sp, ad, i1); lsclr(sp+i1, q);
+                       for i := setlow to sethigh do 
+                         if i in s1 then lsset(sp+i1, i)
+                     end;
+                     13 (*slf*): begin { large set to full }
+                       lschk(sp, q);
+                       for i := setsize to q-1 do 
+                         if store[sp+i] <> 0 then errore(SetElementOutOfRange);
+                       s1 := [];
+                       for i := setlow to sethigh do 
+                         if lsbit(sp, i) then s1 := s1+[i];
+                       sp := sp+q-setsize; putset(sp, s1)
+                     end;
+                     14 (*rsz*): begin { set of i2 bytes under i1 bytes to q }
+                       popint(i1); popint(i2);
+                       if q < i2 then begin
+                         lschk(sp+i1, i2);
+                         for i := q to i2-1 do 
+                           if store[sp+i1+i] <> 0 then 
+                             errore(SetElementOutOfRange);
+                         lsmov(sp+i1+(i2-q), sp+i1, q); 
+                         lsmov(sp+(i2-q), sp, i1); sp := sp+(i2-q)
+                       end else begin
+                         ad := sp; sp := sp-(q-i2); lsmov(sp, ad, i1);
+                         lsmov(sp+i1, ad+i1, i2); lsclr(sp+i1+i2, q-i2)
+                       end
+                     end;
+                     15 (*ina*): begin popadr(ad); popint(i1); b := false;
+                       if (i1 >= 0) and (i1 < q*8) then 
+                         begin chkdef(ad+i1 div 8); b := lsbit(ad, i1) end;
+                       pshint(ord(b))
+                     end;
+                     { sparse sets, the large set operations 16 on }
+                     16 (*lod*): begin popadr(ad); sp := sp-q; spmov(sp, ad) end;
+                     17 (*sto*): begin ad := getadr(sp+q); spmov(ad, sp); 
+                                   sp := sp+q+adrsize end;
+                     18, 19, 20 (*uni,int,dif*): begin 
+                       spop(sp-q, sp+q, sp, q, p-18); spmov(sp+q, sp-q);
+                       sp := sp+q
+                     end;
+                     21, 22 (*equ,neq*): begin 
+                       b := getint(sp) = getint(sp+q);
+                       if b then b := spinc(sp+q, sp);
+                       sp := sp+q*2; if p = 22 then b := not b; pshint(ord(b))
+                     end;
+                     23, 24 (*leq,geq*): begin
+                       if p = 23 then b := spinc(sp+q, sp) 
+                       else b := spinc(sp, sp+q);
+                       sp := sp+q*2; pshint(ord(b))
+                     end;
+                     25 (*sgs*): begin popint(i1);
+                       if i1 < 0 then errore(SetElementOutOfRange);
+                       sp := sp-q; putint(sp, 1); putint(sp+intsize, i1)
+                     end;
+                     26 (*rgs*): begin popint(i2); popint(i1);
+                       sp := sp-q; i3 := 0;
+                       if i1 <= i2 then begin
+                         if i1 < 0 then errore(SetElementOutOfRange);
+                         for i := i1 to i2 do spadd(sp, q, i3, i)
+                       end;
+                       putint(sp, i3)
+                     end;
+                     27 (*inn*): begin b := spfnd(sp, getint(sp+q)); 
+                       sp := sp+q+intsize; pshint(ord(b))
+                     end;
+                     28 (*dsp*): begin { large set of i2 bytes under i1 bytes
+                                         to sparse }
+                       popint(i1); popint(i2); lschk(sp+i1, i2); 
+                       ad := sp; sp := sp-(q-i2); spfrm(sp-q, ad+i1, i2, q); 
+                       lsmov(sp, ad, i1); spmov(sp+i1, sp-q)
+                     end;
+                     29 (*spd*): begin { sparse set of i2 bytes under i1 bytes
+                                         to large }
+                       popint(i1); popint(i2); spto(sp-q, sp+i1, q); 
+                       ad := sp; sp := sp+(i2-q); lsmov(sp, ad, i1); 
+                       lsmov(sp+i1, ad-q, q)
+                     end;
+                     31 (*ina*): begin popadr(ad); popint(i1); 
+                       pshint(ord(spfnd(ad, i1)))
+                     end
+                   end
+                 end;
+
+    255 (*bfd*): begin getp; getq; { p = operation, q = bits in field }
+                   case p of
+                     0 (*lod*): begin popint(i1); popadr(ad); 
+                                  pshint(bfdget(ad, i1, q)) end;
+                     1 (*sto*): begin popint(i2); popint(i1); popadr(ad);
+                                  bfdput(ad, i1, q, i2) end;
+                     2 (*pck*): begin { i1 elements from unpacked of i2 bytes }
+                       popint(i2); popint(i1); popadr(a3); popadr(a2); 
+                       popadr(a1);
+                       if a2+i1 > i2 then errore(PackElementsOutOfBounds);
+                       for i4 := 0 to i1-1 do begin chkdef(a1+a2+i4);
+                         bfdput(a3, i4, q, store[a1+a2+i4])
+                       end
+                     end;
+                     3 (*upk*): begin { i1 elements to unpacked of i2 bytes }
+                       popint(i2); popint(i1); popadr(a3); popadr(a2); 
+                       popadr(a1);
+                       if a3+i1 > i2 then errore(UnpackElementsOutOfBounds);
+                       for i4 := 0 to i1-1 do begin
+                         store[a2+a3+i4] := bfdget(a1, i4, q);
+                         putdef(a2+a3+i4, true)
+                       end
+                     end
+                   end
+                 end;
+
     { illegal instructions }
-    228, 229, 230, 231, 232, 233, 234, 242, 243, 244, 245, 246, 
-    247, 248, 249, 250, 251, 252, 253, 254,
-    255: errorv(InvalidInstruction)
+    228, 229, 230, 231, 232, 233,
+    234: errorv(InvalidInstruction)
 
   end
 end;
@@ -5533,18 +6599,22 @@ end;
 
 { skip over, don't print, type }
 procedure skptyp{(var pc: parctl)};
-var s,e: integer; enum: boolean;
+var s,e: integer; enum: boolean; c: char;
 begin
   case chkchr(pc) of
     'i','b','c','n', 'p', 'e': nxtchr(pc);
     'x': begin getrng(pc, enum, s, e); 
            if not enum then skptyp(pc) 
          end;
-    's': begin nxtchr(pc); getrng(pc, enum, s, e); 
+    's', 'w', 'l', 'z': begin c := chkchr(pc); nxtchr(pc); 
+           if c in ['l', 'z'] then getnum(pc, s); { size }
+           getrng(pc, enum, s, e); 
            if not enum then nxtchr(pc);
            skptyp(pc)
          end;
-    'a': begin nxtchr(pc); getrng(pc, enum, s, e); 
+    'a', 'k': begin c := chkchr(pc); nxtchr(pc); 
+           if c = 'k' then getnum(pc, s); { field width }
+           getrng(pc, enum, s, e); 
            if not enum then nxtchr(pc); 
            skptyp(pc)
          end;
@@ -5555,8 +6625,15 @@ end;
 procedure setpar(var pc: parctl; td: strvsp; p: integer);
 begin pc.b := td; pc.l := lenpv(td); pc.p := p end;
 
-procedure wrtset(var st: settype; var tdc: parctl);
-var s, e, ss, se: integer; enum: boolean; first: boolean;
+{ write set, from st, or if n is not zero from the large set of n bytes at a,
+  or if n is negative from the sparse set at a }
+procedure wrtset(var st: settype; a: address; n: integer; var tdc: parctl);
+var s, e, ss, se, top, k: integer; enum: boolean; first, more: boolean;
+
+function isin(i: integer): boolean;
+begin
+  if n = 0 then isin := i in st else isin := lsbit(a, i)
+end;
 
 procedure wrtval(i: integer);
 begin
@@ -5579,22 +6656,42 @@ end;
 begin 
   getrng(tdc, enum, s, e);
   write('['); first := true;
-  { we print the whole set even if the range does not cover it. This means we
-    tell the user if bits are set, even if outside their range. }
-  ss := setlow;
-  repeat
-    if ss in st then begin
-      se := ss;
-      while (se in st) and (se <= sethigh) do se := se+1; se := se-1;
-      if not first then write(','); 
+  if n < 0 then begin { runs of the elements held }
+    k := 1;
+    while k <= getint(a) do begin
+      ss := spelt(a, k); se := ss; more := true;
+      while more do
+        if k < getint(a) then
+          if spelt(a, k+1) = se+1 then begin se := se+1; k := k+1 end
+          else more := false
+        else more := false;
+      if not first then write(',');
       wrtval(ss);
-      if se > ss then begin
-        write('..'); wrtval(se); ss := se
+      if se > ss then begin write('..'); wrtval(se) end;
+      first := false;
+      k := k+1
+    end
+  end else begin
+    { we print the whole set even if the range does not cover it. This means
+      we tell the user if bits are set, even if outside their range. }
+    ss := setlow; if n = 0 then top := sethigh else top := n*8-1;
+    repeat
+      if isin(ss) then begin
+        se := ss; more := true;
+        while more do 
+          if se < top then 
+            if isin(se+1) then se := se+1 else more := false
+          else more := false;
+        if not first then write(','); 
+        wrtval(ss);
+        if se > ss then begin
+          write('..'); wrtval(se); ss := se
+        end;
+        first := false
       end;
-      first := false
-    end;
-    ss := ss+1
-  until ss > sethigh;
+      ss := ss+1
+    until ss > top
+  end;
   write(']')
 end;
 
@@ -5605,7 +6702,7 @@ begin
   case chkchr(tdc) of { type }
     'i','p','b','c','x': if v.t <> rtint then error(etypmis);
     'n': if v.t <> rtreal then error(etypmis); 
-    's': if v.t <> rtset then error(etypmis); 
+    's', 'w': if v.t <> rtset then error(etypmis); 
     'a': begin nxtchr(tdc); getrng(tdc, enum, s, e); { get range of index }
            if not enum then nxtchr(tdc); { discard index type, we don't need it }
            if (chkchr(tdc) = 'c') and (s = 1) then begin nxtchr(tdc);
@@ -5640,7 +6737,7 @@ begin
              until (c = ')') or (c = ',') 
            end else write(i:1);  
          end;
-    's': begin nxtchr(tdc); wrtset(v.s, tdc) end;
+    's', 'w': begin nxtchr(tdc); wrtset(v.s, 0, 0, tdc) end;
     'a': begin nxtchr(tdc); getrng(tdc, enum, s, e); { get range of index }
            if not enum then nxtchr(tdc); { discard index type, we don't need it }
            if (chkchr(tdc) = 'c') and (s = 1) then begin nxtchr(tdc);
@@ -5657,7 +6754,7 @@ procedure prttyp(var ad: address; td: strvsp; var p: integer; byt: boolean;
                  r: integer; fl: integer; deffld: boolean; lz: boolean; 
                  indent: integer);
 const ispc = 2;
-var i: integer; s, e: integer;
+var i, w: integer; s, e: integer;
     enum: boolean;
     ad2, ad3: address; tdc, stdc: parctl; ps: integer; v: expres;
     subc: boolean;
@@ -5705,7 +6802,7 @@ begin
   texpect(pc, '(');
   while chkchr(pc) <> ')' do begin
     getsym(pc); texpect(pc, ':'); getnum(pc, i); texpect(pc, ':');
-    if chkchr(pc) in ['s','a','r'] then cplx := true; 
+    if chkchr(pc) in ['s','w','l','z','a','k','r'] then cplx := true; 
     skptyp(pc);
     if chkchr(pc) = '(' then begin nxtchr(pc);
       { tagfield, parse sublists }
@@ -5718,18 +6815,22 @@ begin
 end;
 
 procedure skptyp{(var pc: parctl)};
-var s,e: integer; enum: boolean;
+var s,e: integer; enum: boolean; c: char;
 begin
   case chkchr(pc) of
     'i','b','c','n', 'p', 'e': nxtchr(pc);
     'x': begin getrng(pc, enum, s, e); 
            if not enum then skptyp(pc) 
          end;
-    's': begin nxtchr(pc); getrng(pc, enum, s, e); 
+    's', 'w', 'l', 'z': begin c := chkchr(pc); nxtchr(pc); 
+           if c in ['l', 'z'] then getnum(pc, s); { size }
+           getrng(pc, enum, s, e); 
            if not enum then nxtchr(pc);
            skptyp(pc)
          end;
-    'a': begin nxtchr(pc); getrng(pc, enum, s, e);
+    'a', 'k': begin c := chkchr(pc); nxtchr(pc); 
+           if c = 'k' then getnum(pc, s); { field width }
+           getrng(pc, enum, s, e);
            if not enum then nxtchr(pc);
            skptyp(pc) 
          end;
@@ -5805,6 +6906,23 @@ begin { prttyp }
            else begin nxtchr(tdc); write('Undefined') end;
            ad := ad+setsize
          end;
+    'w': begin { word set, the bits of an integer }
+           if getdef(ad) then 
+             begin v.t := rtset; wrdtoset(getint(ad), v.s); 
+                   prtsim(v, tdc, r, fl, deffld, lz) end
+           else begin nxtchr(tdc); write('Undefined') end;
+           ad := ad+intsize
+         end;
+    'l': begin nxtchr(tdc); getnum(tdc, i); { large set of i bytes }
+           if getdef(ad) then wrtset(v.s, ad, i, tdc)
+           else write('Undefined');
+           ad := ad+i
+         end;
+    'z': begin nxtchr(tdc); getnum(tdc, i); { sparse set of i bytes }
+           if getdef(ad) then wrtset(v.s, ad, -1, tdc)
+           else write('Undefined');
+           ad := ad+i
+         end;
     'a': begin nxtchr(tdc); getrng(tdc, enum, s, e);
            if not enum then nxtchr(tdc); { discard index type, we don't need it }
            if (chkchr(tdc) = 'c') and (s = 1) then begin
@@ -5814,7 +6932,7 @@ begin { prttyp }
                if getdef(ad+i-s) then write(getchr(ad+i-s)) else write('*');
              write('''');
              nxtchr(tdc)
-           end else begin subc := chkchr(tdc) in ['s','a','r'];
+           end else begin subc := chkchr(tdc) in ['s','w','l','z','a','k','r'];
              write('array '); indent := indent+ispc;
              if subc then newline;
              { print whole array }
@@ -5829,6 +6947,24 @@ begin { prttyp }
              write('end')
            end
          end;
+    'k': begin nxtchr(tdc); getnum(tdc, w); { array of w bit fields }
+           getrng(tdc, enum, s, e);
+           if not enum then nxtchr(tdc); { discard index type }
+           write('array ');
+           ps := tdc.p;
+           for i := 0 to e-s do begin tdc.p := ps;
+             { element i is bits i*w mod 8 up of byte i*w div 8 }
+             ad2 := ad+i*w div 8;
+             if getdef(ad2) then begin v.t := rtint;
+               v.i := store[ad2] div wbit(i*w mod 8) mod wbit(w);
+               prtsim(v, tdc, r, fl, deffld, lz)
+             end else write('Undefined');
+             if i < e-s then write(', ')
+           end;
+           tdc.p := ps; skptyp(tdc);
+           write(' end');
+           ad := ad+((e-s+1)*w+7) div 8
+         end;
     'r': begin nxtchr(tdc); subc := complex(tdc); 
            write('record '); indent := indent+ispc; 
            if subc then newline;
@@ -5845,7 +6981,7 @@ end;
 
 function siztyp(var tdc: parctl): integer;
 
-var sz: integer; enum: boolean; s, e: integer;
+var sz: integer; enum: boolean; s, e, w: integer;
 
 function sizlst: integer;
 var i: integer; c: char; sz, sz2, mxsz: integer;
@@ -5883,9 +7019,16 @@ begin
            else s := siztyp(tdc)
          end;
     's': begin nxtchr(tdc); sz := setsize; s := siztyp(tdc) end;
+    'w': begin nxtchr(tdc); sz := intsize; s := siztyp(tdc) end;
+    'l', 'z': begin nxtchr(tdc); getnum(tdc, sz); s := siztyp(tdc) end;
     'a': begin nxtchr(tdc); getrng(tdc, enum, s, e); { get range of index }
            if not enum then nxtchr(tdc); sz := siztyp(tdc)*(e-s+1)
          end;
+    'k': begin nxtchr(tdc); getnum(tdc, w); { field width }
+           getrng(tdc, enum, s, e); { get range of index }
+           if not enum then nxtchr(tdc); sz := siztyp(tdc);
+           sz := ((e-s+1)*w+7) div 8
+         end;
     'r': begin nxtchr(tdc); sz := sizlst end; 
     'e': begin nxtchr(tdc); sz := exceptsize end;
     'f': begin nxtchr(tdc); sz := filesize; s := siztyp(tdc) end;
@@ -6106,7 +7249,7 @@ begin sp := nil; undef := false; skpspc(dbc); c := chkchr(dbc);
   end else if chkchr(dbc) in ['a'..'z', 'A'..'Z', '_'] then begin
     p := 1; vartyp(sp, ad, p);
     setpar(tdc, sp^.digest, p); { set up type digest for parse }
-    if chkchr(tdc) in ['i', 'b','c','p','x','n','s'] then begin
+    if chkchr(tdc) in ['i', 'b','c','p','x','n','s','w'] then begin
       { scalar }
       simple := true;
       { note for simple loads we leave the digest pointing to type }
@@ -6121,6 +7264,7 @@ begin sp := nil; undef := false; skpspc(dbc); c := chkchr(dbc);
              end;
         'n': begin r.t := rtreal; r.r := getrel(ad) end;
         's': begin r.t := rtset; getset(ad, r.s) end;
+        'w': begin r.t := rtset; wrdtoset(getint(ad), r.s) end;
         'a': begin ps := tdc.p; nxtchr(tdc); getrng(tdc, enum, s, e);
                if not enum then nxtchr(tdc); 
                if (chkchr(tdc) = 'c') and (s = 1) then begin { string }
@@ -6632,7 +7776,7 @@ begin
     exptyp(syp, s, p, eres, sim, undef); setpar(stdc, syp^.digest, p);
     if undef then error(esrcudf);
     if sim then begin { simple }
-      if chkchr(tdc) in ['i', 'b','c','p','x','n','s','a'] then begin
+      if chkchr(tdc) in ['i', 'b','c','p','x','n','s','w','a'] then begin
         case chkchr(tdc) of
           'i','p': begin if eres.t <> rtint then error(etypmis);
                      putint(ad, eres.i)
@@ -6654,6 +7798,18 @@ begin
                  if not mattyp(tdc, stdc) then error(etypmat);
                  putset(ad, eres.s)
                end;
+          'w': begin if eres.t <> rtset then error(etypmis);
+                 { the value can be a word set or a full set }
+                 nxtchr(tdc); nxtchr(stdc); skpsub(tdc); skpsub(stdc);
+                 if not mattyp(tdc, stdc) then error(etypmat);
+                 { only elements the word holds }
+                 x := 0;
+                 for i := setlow to sethigh do if i in eres.s then begin
+                   if i > wsethigh then error(esetval);
+                   x := x+wbit(i)
+                 end;
+                 putint(ad, x)
+               end;
           'a': begin if eres.t <> rtstrg then error(etypmis);
                  if not mattyp(tdc, stdc) then error(etypmat); 
                  nxtchr(stdc); getrng(stdc, enum, si, ei);
@@ -6669,8 +7825,8 @@ begin
     end else begin { set complex }
       if not mattyp(tdc, stdc) then error(etypmat);
       case chkchr(stdc) of
-        'i','b','c','n','x','p','s','e','f': error(esystem);
-        'a','r': begin x := siztyp(stdc); 
+        'i','b','c','n','x','p','s','w','e','f': error(esystem);
+        'a','k','l','z','r': begin x := siztyp(stdc); 
                    for i := 1 to x do 
                      begin store[ad] := store[s]; putdef(ad, getdef(s)); 
                            ad := ad+1; s := s+1 end;
@@ -6995,7 +8151,7 @@ begin
 end; 
 
 procedure wrtdck;
-var ad,ad2: address; l, cs: integer;
+var ad,ad2: address; l, cs: integer; lp: linptr;
 begin
   ad := 0;
   while ad < pctop do begin { output deck }
@@ -7011,7 +8167,19 @@ begin
     writeln(prr);
     ad := ad+l
   end;
-  writeln(prr, ':00000000000000000000')
+  writeln(prr, ':00000000000000000000');
+  { output layout, which the loaders check against their own }
+  write(prr, ';a'); wrthex(prr, intsize, 2, true); wrthex(prr, intal, 2, true);
+  wrthex(prr, realal, 2, true); wrthex(prr, adral, 2, true); 
+  wrthex(prr, heapal, 2, true); wrthex(prr, gbsal, 2, true); writeln(prr);
+  { output source line table, which follows the terminator so that loaders
+    that don't know about it will stop before it }
+  lp := lintab;
+  while lp <> nil do begin
+    write(prr, ';l'); wrthex(prr, lp^.ad, 16, true); 
+    wrthex(prr, lp^.ln, 8, true); writeln(prr);
+    lp := lp^.next
+  end
 end;
 
 procedure fndpow(var m: integer; p: integer; var d: integer);
@@ -7075,7 +8243,10 @@ begin (* main *)
   gbsiz := 0;
   curmod := nil; { set no module active }
   varlst := nil; { set no VAR block entries }
+  lintab := nil; lintal := nil; { set no deck line table entries }
   varfre := nil;
+  vartre := nil;
+  varseq := 0; varsed := 1;
   { endian flip status is set if the host processor and the target disagree on
     endian mode }
   flipend := litend <> lendian;
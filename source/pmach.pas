@@ -246,6 +246,7 @@ const
       maxlabel = 5000;       { total possible labels in intermediate }
       maxcstfx = 10000;      { maximum constant fixup in intermediate }
       maxgblfx = 10000;      { maximum global access fixup in intermediate }
+      maxlin   = 100000;     { maximum entries in source line table }
       resspc   = 0;          { reserve space in heap (if you want) }
 
       { locations of header files after program block mark, each header
@@ -416,11 +417,23 @@ type
       cmdinx      = 1..maxcmd; { index for command line buffer }
       cmdnum      = 0..maxcmd; { length of command line buffer }
       cmdbuf      = packed array [cmdinx] of char; { buffer for command line }
-      { VAR reference block }
+      { VAR reference block. Each block is on the pushdown stack, and is also a
+        node in a treap ordered by start address, with the highest end address
+        in each subtree, so overlap checks take log time in the number of
+        blocks. }
       varptr       = ^varblk;
       varblk       = record 
                        next: varptr; { next entry }
-                       s, e: address { start and end address of block }
+                       s, e: address; { start and end address of block }
+                       l, r: varptr; { left and right subtrees }
+                       m: address; { maximum end address in subtree }
+                       sn: integer; { push sequence number, orders equal starts }
+                       p: integer { treap priority }
+                     end;
+      { source line table entry }
+      linent       = record
+                       ad: address; { address of first instruction of line }
+                       ln: integer { source line number }
                      end;
 
 var   pc          : address;   (*program address register*)
@@ -485,6 +498,12 @@ var   pc          : address;   (*program address register*)
       filanamtab  : array [1..maxfil] of boolean;
       varlst      : varptr; { active var block pushdown stack }
       varfre      : varptr; { free var block entries }
+      vartre      : varptr; { treap root of active var blocks }
+      varseq      : integer; { var block push sequence }
+      varsed      : integer; { var block priority generator seed }
+      { source line table, in ascending address order }
+      lintab      : array [1..maxlin] of linent;
+      lincnt      : 0..maxlin; { number of entries in that }
       maxpow10    : integer; { maximum power of 10 }
       decdig      : integer; { digits in unsigned decimal }
       maxpow16    : integer; { maximum power of 16 }
@@ -573,9 +592,29 @@ end;
 
 { Low level error check and handling }
 
+{ find the source line executing. If the deck carried a line table, the line
+  is looked up from the pc, otherwise it is the last line marked by mrkl. The
+  pc is past the instruction executing, so the byte before it is used. }
+function curlin: integer;
+var l, h, m: integer;
+begin
+  if lincnt = 0 then curlin := srclin
+  else if pc-1 < lintab[1].ad then curlin := 0
+  else begin
+    l := 1; h := lincnt;
+    while l < h do begin { find last entry at or below pc }
+      m := (l+h+1) div 2;
+      if lintab[m].ad <= pc-1 then l := m else h := m-1
+    end;
+    curlin := lintab[l].ln
+  end
+end;
+
 procedure errors(a: address; l: address);
+var ln: integer;
 begin writeln; write('*** Runtime error'); 
-      if srclin > 0 then write(' [', srclin:1, ']');
+      ln := curlin;
+      if ln > 0 then write(' [', ln:1, ']');
       write(': ');
       if l > maxast then l := maxast;
       while l > 0 do begin write(chr(store[a])); a := a+1; l := l-1 end;
@@ -594,8 +633,10 @@ procedure errore(ei: integer); forward;
 
 { handle exception vector }
 procedure errorv(ea: address);
+var ln: integer;
 begin writeln; write('*** Runtime error');
-  if srclin > 0 then write(' [', srclin:1, ']');
+  ln := curlin;
+  if ln > 0 then write(' [', ln:1, ']');
   write(': ');
   case ea of
   
@@ -842,6 +883,81 @@ begin
   bxor := r
 end;
 
+{ Word set emulation. Sets of elements 0..wsethigh are held as the bits of a
+  positive integer. }
+
+function wbit(i: integer): integer;
+var r: integer;
+begin
+  r := 1;
+  while i > 0 do begin r := r*2; i := i-1 end;
+  wbit := r
+end;
+
+procedure wrdtoset(w: integer; var s: settype);
+var i: integer;
+begin
+  s := [];
+  for i := 0 to wsethigh do begin if odd(w) then s := s+[i]; w := w div 2 end
+end;
+
+{ Large set emulation. Large sets are bitmaps of a whole number of words in
+  store, element i being bit i mod 8 of byte i div 8. }
+
+function lsbit(a: address; i: integer): boolean;
+begin
+  lsbit := odd(store[a+i div 8] div wbit(i mod 8))
+end;
+
+procedure lsset(a: address; i: integer);
+begin
+  if not lsbit(a, i) then store[a+i div 8] := store[a+i div 8]+wbit(i mod 8)
+end;
+
+{ clear large set, and mark it defined }
+procedure lsclr(a: address; n: integer);
+var i: integer;
+begin
+  for i := 0 to n-1 do begin store[a+i] := 0; putdef(a+i, true) end
+end;
+
+{ move run of store with its defined bits, the runs may overlap }
+procedure lsmov(d, s: address; n: integer);
+var i: integer;
+begin
+  if d < s then
+    for i := 0 to n-1 do 
+      begin store[d+i] := store[s+i]; putdef(d+i, getdef(s+i)) end
+  else if d > s then
+    for i := n-1 downto 0 do 
+      begin store[d+i] := store[s+i]; putdef(d+i, getdef(s+i)) end
+end;
+
+procedure lschk(a: address; n: integer);
+var i: integer;
+begin
+  if dochkdef then for i := 0 to n-1 do chkdef(a+i)
+end;
+
+{ Bit fields of packed arrays. Element i of w bits is bits i*w mod 8 up of 
+  byte i*w div 8, w being 1, 2 or 4, so a field never crosses a byte.
+  Definedness is kept per byte, so the first store to any field of a byte
+  clears the byte and marks it defined. Reading another field of that byte
+  before it is stored then gives 0 with no undefined access error. }
+
+function bfdget(a: address; i, w: integer): integer;
+begin chkdef(a+i*w div 8);
+  bfdget := store[a+i*w div 8] div wbit(i*w mod 8) mod wbit(w)
+end;
+
+procedure bfdput(a: address; i, w, v: integer);
+var ad: address; s: integer;
+begin ad := a+i*w div 8; s := wbit(i*w mod 8);
+  if not getdef(ad) then store[ad] := 0;
+  store[ad] := store[ad]-store[ad] div s mod wbit(w)*s+v mod wbit(w)*s;
+  putdef(ad, true)
+end;
+
 { End of language extension routines }
 
 (*--------------------------------------------------------------------*)
@@ -976,6 +1092,103 @@ begin
 
 end;
 
+{ Sparse set emulation. Sparse sets are a count of elements, then the 
+  elements in ascending order, each a word, in q bytes. Only the count and
+  the elements held are moved. A result is built below the stack, then 
+  moved into place. }
+
+{ find element i of sparse set }
+function spelt(a: address; i: integer): integer;
+begin
+  spelt := getint(a+i*intsize)
+end;
+
+{ find if element e is in sparse set, by halving }
+function spfnd(a: address; e: integer): boolean;
+var l, h, m: integer; f: boolean;
+begin
+  f := false; l := 1; h := getint(a);
+  while (l <= h) and not f do begin
+    m := (l+h) div 2;
+    if spelt(a, m) = e then f := true
+    else if spelt(a, m) < e then l := m+1
+    else h := m-1
+  end;
+  spfnd := f
+end;
+
+{ move sparse set with its count }
+procedure spmov(d, s: address);
+begin
+  lsmov(d, s, (getint(s)+1)*intsize)
+end;
+
+{ add element e after the n already in sparse set of q bytes }
+procedure spadd(d: address; q: integer; var n: integer; e: integer);
+begin
+  n := n+1; if n >= q div intsize then errore(SetElementOutOfRange);
+  putint(d+n*intsize, e)
+end;
+
+{ combine sparse sets a1 and a2 of q bytes into d, o = 0 union, 
+  1 intersection, 2 difference }
+procedure spop(d, a1, a2: address; q, o: integer);
+var i1, i2, n1, n2, n, e1, e2: integer;
+begin
+  n1 := getint(a1); n2 := getint(a2); i1 := 1; i2 := 1; n := 0;
+  e1 := 0; e2 := 0;
+  while (i1 <= n1) or (i2 <= n2) do begin
+    if i1 <= n1 then e1 := spelt(a1, i1);
+    if i2 <= n2 then e2 := spelt(a2, i2);
+    if i2 > n2 then begin
+      if o <> 1 then spadd(d, q, n, e1); i1 := i1+1
+    end else if i1 > n1 then begin
+      if o = 0 then spadd(d, q, n, e2); i2 := i2+1
+    end else if e1 < e2 then begin
+      if o <> 1 then spadd(d, q, n, e1); i1 := i1+1
+    end else if e2 < e1 then begin
+      if o = 0 then spadd(d, q, n, e2); i2 := i2+1
+    end else begin
+      if o <> 2 then spadd(d, q, n, e1); i1 := i1+1; i2 := i2+1
+    end
+  end;
+  putint(d, n)
+end;
+
+{ find if sparse set a1 is included in a2 }
+function spinc(a1, a2: address): boolean;
+var i1, i2, n1, n2: integer; b: boolean;
+begin
+  n1 := getint(a1); n2 := getint(a2); i1 := 1; i2 := 1; b := true;
+  while b and (i1 <= n1) do
+    if i2 > n2 then b := false
+    else if spelt(a2, i2) < spelt(a1, i1) then i2 := i2+1
+    else if spelt(a2, i2) = spelt(a1, i1) then
+      begin i1 := i1+1; i2 := i2+1 end
+    else b := false;
+  spinc := b
+end;
+
+{ make sparse set d of q bytes from large set a of n bytes }
+procedure spfrm(d, a: address; n, q: integer);
+var i, c: integer;
+begin
+  c := 0;
+  for i := 0 to n*8-1 do if lsbit(a, i) then spadd(d, q, c, i);
+  putint(d, c)
+end;
+
+{ make large set d of q bytes from sparse set a }
+procedure spto(d, a: address; q: integer);
+var i, e: integer;
+begin
+  lsclr(d, q);
+  for i := 1 to getint(a) do begin
+    e := spelt(a, i); if e >= q*8 then errore(SetElementOutOfRange);
+    lsset(d, e)
+  end
+end;
+
 function getrel(a: address): real;
 
 var r: record case boolean of
@@ -1223,6 +1436,7 @@ procedure load;
    var  ad, ad2: address;
         i, l, cs, csc, b: integer;
         c: char;
+        lay: boolean;
 
    procedure errorl; (*error in loading*)
    begin writeln;
@@ -1253,35 +1467,128 @@ begin (*load*)
     readhex(csc, 2); if cs <> csc then errorl;
     readln(prd)
   end;
-  pctop := ad
+  pctop := ad;
+  { a deck made before it carried its layout has the default layout }
+  lay := not natal;
+  { read the layout record and the optional source line table following the
+    terminator }
+  while not eof(prd) do begin
+    read(prd, c); if c <> ';' then errorl;
+    read(prd, c);
+    if c = 'a' then begin { layout the deck was made for, must match ours }
+      readhex(i, 2); lay := i = intsize;
+      readhex(i, 2); lay := lay and (i = intal);
+      readhex(i, 2); lay := lay and (i = realal);
+      readhex(i, 2); lay := lay and (i = adral);
+      readhex(i, 2); lay := lay and (i = heapal);
+      readhex(i, 2); lay := lay and (i = gbsal)
+    end else if c = 'l' then begin { source line }
+      if lincnt >= maxlin then errorl;
+      lincnt := lincnt+1;
+      readhex(i, 16); lintab[lincnt].ad := i; readhex(l, 8); 
+      lintab[lincnt].ln := l
+    end else errorl;
+    readln(prd)
+  end;
+  if not lay then begin writeln;
+    writeln('*** Code deck layout does not match');
+    goto 1
+  end
 end; (*load*)
 
 (*------------------------------------------------------------------------*)
 
 { runtime handlers }
 
+{ find if block a sorts before block b }
+function varbfr(a, b: varptr): boolean;
+begin
+  varbfr := (a^.s < b^.s) or ((a^.s = b^.s) and (a^.sn < b^.sn))
+end;
+
+{ recalculate maximum end address of treap node }
+procedure varfix(t: varptr);
+begin
+  t^.m := t^.e;
+  if t^.l <> nil then if t^.l^.m > t^.m then t^.m := t^.l^.m;
+  if t^.r <> nil then if t^.r^.m > t^.m then t^.m := t^.r^.m
+end;
+
+{ insert node into treap }
+function varins(t, n: varptr): varptr;
+var c: varptr;
+begin
+  if t <> nil then begin
+    if varbfr(n, t) then begin
+      t^.l := varins(t^.l, n);
+      if t^.l^.p > t^.p then begin { rotate right }
+        c := t^.l; t^.l := c^.r; varfix(t); c^.r := t; t := c
+      end
+    end else begin
+      t^.r := varins(t^.r, n);
+      if t^.r^.p > t^.p then begin { rotate left }
+        c := t^.r; t^.r := c^.l; varfix(t); c^.l := t; t := c
+      end
+    end;
+    varfix(t); varins := t
+  end else varins := n
+end;
+
+{ join treaps, all of which a sorts before b }
+function varjoin(a, b: varptr): varptr;
+begin
+  if a = nil then varjoin := b
+  else if b = nil then varjoin := a
+  else if a^.p > b^.p then begin
+    a^.r := varjoin(a^.r, b); varfix(a); varjoin := a
+  end else begin
+    b^.l := varjoin(a, b^.l); varfix(b); varjoin := b
+  end
+end;
+
+{ remove node from treap }
+function vardel(t, n: varptr): varptr;
+begin
+  if t = n then vardel := varjoin(t^.l, t^.r)
+  else begin
+    if varbfr(n, t) then t^.l := vardel(t^.l, n)
+    else t^.r := vardel(t^.r, n);
+    varfix(t); vardel := t
+  end
+end;
+
 procedure varenter(s, e: address);
 var vp: varptr;
 begin
   if varfre <> nil then begin vp := varfre; varfre := vp^.next end
   else new(vp);
-  vp^.s := s; vp^.e := e; vp^.next := varlst; varlst := vp
+  vp^.s := s; vp^.e := e; vp^.next := varlst; varlst := vp;
+  vp^.l := nil; vp^.r := nil; vp^.m := e; vp^.sn := varseq;
+  varseq := varseq+1;
+  varsed := (varsed*25173+13849) mod 65536; vp^.p := varsed;
+  vartre := varins(vartre, vp)
 end;
 
 procedure varexit;
 var vp: varptr;
 begin
   if varlst = nil then errorv(VarListEmpty);
-  vp := varlst; varlst := vp^.next; vp^.next := varfre; varfre := vp
+  vp := varlst; varlst := vp^.next; vp^.next := varfre; varfre := vp;
+  vartre := vardel(vartre, vp)
 end;
 
 function varlap(s, e: address): boolean;
-var vp: varptr; f: boolean;
+var vp: varptr; f, lft: boolean;
 begin
-  vp := varlst; f := false;
+  { if the left subtree reaches s, any overlap to the right would start past
+    e, so it is enough to look left }
+  vp := vartre; f := false;
   while (vp <> nil) and not f do begin
     f := (vp^.e >= s) and (vp^.s <= e);
-    vp := vp^.next 
+    lft := false; if vp^.l <> nil then lft := vp^.l^.m >= s;
+    if lft then vp := vp^.l
+    else if vp^.s <= e then vp := vp^.r
+    else vp := nil
   end;
   
   varlap := f
@@ -1463,7 +1770,8 @@ begin
      ad := np; { save base of new block }
      np := np+(len+adrsize); { find new heap top }
      ad1 := np; { save address }
-     alignu(heapal, np); { align to arena }
+     { align to arena, which is the space after the next block header }
+     np := np+adrsize; alignu(heapal, np); np := np-adrsize;
      len := len+(np-ad1); { adjust length upwards for alignment }
      if np > sp then errore(SpaceAllocateFail);
      putadr(ad, -(len+adrsize)); { allocate block }
@@ -2527,6 +2835,18 @@ begin
                  (* idem *)
                 end;
 
+    244 (*msl*): begin (*mark stack for a routine that never uses its static
+                        link, p and q as mst*)
+                 getp; getq;
+                 { allocate function result as zeros }
+                 for j := 1 to q div intsize do pshint(0);
+                 ad := sp; { save mark base }
+                 { allocate mark, the routine entry and cup fill the rest }
+                 sp := sp-marksize;
+                 putadr(ad+markdl, mp); { dl }
+                 putadr(ad+markep, ep) { ep }
+                end;
+
     12 (*cup*): begin (*p=no of locations for parameters, q=entry point*)
                  getp; getq;
                  mp := sp+(p+marksize); { mp to base of mark }
@@ -2534,6 +2854,32 @@ begin
                  pc := q
                 end;
                 
+    245 (*cut*): begin (*p=no of locations for parameters, q=entry point of
+                        the calling routine itself*)
+                 getp; getq;
+                 { if the return follows, directly or by a jump, reuse the
+                   frame: the parameters replace ours and we restart. The
+                   line marks for the lines in between are passed over }
+                 ad := pc;
+                 while store[ad] = 174 (*mrkl*) do ad := ad+1+intsize;
+                 if store[ad] = 23 (*ujp*) then begin
+                   ad := getadr(ad+1);
+                   while store[ad] = 174 (*mrkl*) do ad := ad+1+intsize
+                 end;
+                 b := store[ad] = 14 (*retp*);
+                 if b then begin
+                   ad := mp-marksize-p; { our parameters }
+                   for i := 0 to p-1 do begin
+                     store[ad+i] := store[sp+i]; putdef(ad+i, getdef(sp+i))
+                   end;
+                   sp := ad
+                 end else begin
+                   mp := sp+(p+marksize); { mp to base of mark }
+                   putadr(mp+markra, pc) { place ra }
+                 end;
+                 pc := q
+                end;
+
     27 (*cuv*): begin (*q=entry point*)
                  getq;
                  mp := sp+(p+marksize); { mp to base of mark }
@@ -2660,6 +3006,25 @@ begin
     23 (*ujp*): begin getq; pc := q end;
     24 (*fjp*): begin getq; popint(i); if i = 0 then pc := q end;
     25 (*xjp*): begin getq; popint(i1); pc := i1*ujplen+q end;
+    242 (*xjt*): begin getq; popint(i1);
+                   if (i1 < getint(q)) or (i1 > getint(q+intsize)) then begin
+                     { out of range goes to the first entry, the else case }
+                     if store[pc] = 61 (*ujc*) then errore(ValueOutOfRange);
+                     pc := getadr(pc+1)
+                   end else pc := getadr(pc+(i1-getint(q)+1)*ujplen+1)
+                 end;
+    243 (*xjs*): begin getq; popint(i1);
+                   { binary search the cjp entries for the range holding the
+                     value, a miss executes the entry after the table }
+                   i2 := 0; i3 := q-1; ad := pc+q*cjplen; b := false;
+                   while (i2 <= i3) and not b do begin
+                     i := (i2+i3) div 2; ad1 := pc+i*cjplen; a1 := getadr(ad1+1);
+                     if i1 < getint(a1) then i3 := i-1
+                     else if i1 > getint(a1+intsize) then i2 := i+1
+                     else begin b := true; ad := getadr(ad1+1+adrsize) end
+                   end;
+                   pc := ad
+                 end;
 
     95 (*chka*),
     190 (*ckla*): begin getq; popadr(a1); pshadr(a1);
@@ -2776,6 +3141,42 @@ begin
     46 (*int*): begin popset(s2); popset(s1); pshset(s1*s2) end;
     47 (*uni*): begin popset(s2); popset(s1); pshset(s1+s2) end;
     48 (*inn*): begin popset(s1); popint(i1); pshint(ord(i1 in s1)) end;
+    246 (*sgw*): begin popint(i1);
+                   if (i1 < 0) or (i1 > wsethigh) then 
+                     errore(SetElementOutOfRange);
+                   pshint(wbit(i1)) end;
+    247 (*rgw*): begin popint(i2); popint(i1);
+                   if i1 > i2 then pshint(0)
+                   else begin
+                     if (i1 < 0) or (i2 > wsethigh) then 
+                       errore(SetElementOutOfRange);
+                     { bits i1..i2, without overflow at the top bit }
+                     pshint(wbit(i2)-wbit(i1)+wbit(i2))
+                   end
+                 end;
+    248 (*inw*): begin popint(i2); popint(i1); b := false;
+                   if (i1 >= 0) and (i1 <= wsethigh) then 
+                     b := odd(i2 div wbit(i1));
+                   pshint(ord(b)) end;
+    249 (*dfw*): begin popint(i2); popint(i1); pshint(band(i1, bnot(i2))) end;
+    250 (*lew*): begin popint(i2); popint(i1); 
+                   pshint(ord(band(i1, bnot(i2)) = 0)) end;
+    251 (*gew*): begin popint(i2); popint(i1); 
+                   pshint(ord(band(i2, bnot(i1)) = 0)) end;
+    252 (*swf*): begin getq; { q = offset of the word set from the top }
+                   wrdtoset(getint(sp+q), s1); ad := sp; 
+                   sp := sp-(setsize-intsize);
+                   for i := 0 to q-1 do begin
+                     store[sp+i] := store[ad+i]; putdef(sp+i, getdef(ad+i))
+                   end;
+                   putset(sp+q, s1)
+                 end;
+    253 (*sfw*): begin popset(s1); i1 := 0;
+                   for j := setlow to sethigh do if j in s1 then begin
+                     if j > wsethigh then errore(SetElementOutOfRange);
+                     i1 := i1+wbit(j)
+                   end;
+                   pshint(i1) end;
     49 (*mod*): begin popint(i2); popint(i1);
                   if dochkovf then if i2 <= 0 then 
                     errore(InvalidDivisorToMod);
@@ -3061,10 +3462,168 @@ begin
                  
     241 (*lsa*): begin getq; pshadr(sp+q) end;
 
+    254 (*lgs*): begin getp; getq; { p = operation, q = size of sets }
+                   case p of
+                     0 (*lod*): begin popadr(ad); sp := sp-q; lsmov(sp, ad, q) end;
+                     1 (*sto*): begin ad := getadr(sp+q); lsmov(ad, sp, q); 
+                                  sp := sp+q+adrsize end;
+                     2, 3, 4 (*uni,int,dif*): begin lschk(sp, q); lschk(sp+q, q);
+                       for i := 0 to q-1 do
+                         if p = 2 then 
+                           store[sp+q+i] := bor(store[sp+q+i], store[sp+i])
+                         else if p = 3 then 
+                           store[sp+q+i] := band(store[sp+q+i], store[sp+i])
+                         else 
+                           store[sp+q+i] := band(store[sp+q+i], 255-store[sp+i]);
+                       sp := sp+q
+                     end;
+                     5, 6 (*equ,neq*): begin lschk(sp, q); lschk(sp+q, q); 
+                       b := true;
+                       for i := 0 to q-1 do 
+                         if store[sp+q+i] <> store[sp+i] then b := false;
+                       sp := sp+q*2; if p = 6 then b := not b; pshint(ord(b))
+                     end;
+                     7, 8 (*leq,geq*): begin lschk(sp, q); lschk(sp+q, q); 
+                       b := true;
+                       for i := 0 to q-1 do
+                         if p = 7 then begin
+                           if band(store[sp+q+i], 255-store[sp+i]) <> 0 then 
+                             b := false
+                         end else
+                           if band(store[sp+i], 255-store[sp+q+i]) <> 0 then
+                             b := false;
+                       sp := sp+q*2; pshint(ord(b))
+                     end;
+                     9 (*sgs*): begin popint(i1);
+                       if (i1 < 0) or (i1 >= q*8) then 
+                         errore(SetElementOutOfRange);
+                       sp := sp-q; lsclr(sp, q); lsset(sp, i1)
+                     end;
+                     10 (*rgs*): begin popint(i2); popint(i1);
+                       if i1 <= i2 then if (i1 < 0) or (i2 >= q*8) then
+                         errore(SetElementOutOfRange);
+                       sp := sp-q; lsclr(sp, q);
+                       for i := i1 to i2 do lsset(sp, i)
+                     end;
+                     11 (*inn*): begin lschk(sp, q); i1 := getint(sp+q); 
+                       b := false;
+                       if (i1 >= 0) and (i1 < q*8) then b := lsbit(sp, i1);
+                       sp := sp+q+intsize; pshint(ord(b))
+                     end;
+                     12 (*sfl*): begin { full set under i1 bytes to large }
+                       popint(i1); getset(sp+i1, s1); ad := sp;
+                       sp := sp-(q-setsize); lsmov(sp, ad, i1); lsclr(sp+i1, q);
+                       for i := setlow to sethigh do 
+                         if i in s1 then lsset(sp+i1, i)
+                     end;
+                     13 (*slf*): begin { large set to full }
+                       lschk(sp, q);
+                       for i := setsize to q-1 do 
+                         if store[sp+i] <> 0 then errore(SetElementOutOfRange);
+                       s1 := [];
+                       for i := setlow to sethigh do 
+                         if lsbit(sp, i) then s1 := s1+[i];
+                       sp := sp+q-setsize; putset(sp, s1)
+                     end;
+                     14 (*rsz*): begin { set of i2 bytes under i1 bytes to q }
+                       popint(i1); popint(i2);
+                       if q < i2 then begin
+                         lschk(sp+i1, i2);
+                         for i := q to i2-1 do 
+                           if store[sp+i1+i] <> 0 then 
+                             errore(SetElementOutOfRange);
+                         lsmov(sp+i1+(i2-q), sp+i1, q); 
+                         lsmov(sp+(i2-q), sp, i1); sp := sp+(i2-q)
+                       end else begin
+                         ad := sp; sp := sp-(q-i2); lsmov(sp, ad, i1);
+                         lsmov(sp+i1, ad+i1, i2); lsclr(sp+i1+i2, q-i2)
+                       end
+                     end;
+                     15 (*ina*): begin popadr(ad); popint(i1); b := false;
+                       if (i1 >= 0) and (i1 < q*8) then 
+                         begin chkdef(ad+i1 div 8); b := lsbit(ad, i1) end;
+                       pshint(ord(b))
+                     end;
+                     { sparse sets, the large set operations 16 on }
+                     16 (*lod*): begin popadr(ad); sp := sp-q; spmov(sp, ad) end;
+                     17 (*sto*): begin ad := getadr(sp+q); spmov(ad, sp); 
+                                   sp := sp+q+adrsize end;
+                     18, 19, 20 (*uni,int,dif*): begin 
+                       spop(sp-q, sp+q, sp, q, p-18); spmov(sp+q, sp-q);
+                       sp := sp+q
+                     end;
+                     21, 22 (*equ,neq*): begin 
+                       b := getint(sp) = getint(sp+q);
+                       if b then b := spinc(sp+q, sp);
+                       sp := sp+q*2; if p = 22 then b := not b; pshint(ord(b))
+                     end;
+                     23, 24 (*leq,geq*): begin
+                       if p = 23 then b := spinc(sp+q, sp) 
+                       else b := spinc(sp, sp+q);
+                       sp := sp+q*2; pshint(ord(b))
+                     end;
+                     25 (*sgs*): begin popint(i1);
+                       if i1 < 0 then errore(SetElementOutOfRange);
+                       sp := sp-q; putint(sp, 1); putint(sp+intsize, i1)
+                     end;
+                     26 (*rgs*): begin popint(i2); popint(i1);
+                       sp := sp-q; i3 := 0;
+                       if i1 <= i2 then begin
+                         if i1 < 0 then errore(SetElementOutOfRange);
+                         for i := i1 to i2 do spadd(sp, q, i3, i)
+                       end;
+                       putint(sp, i3)
+                     end;
+                     27 (*inn*): begin b := spfnd(sp, getint(sp+q)); 
+                       sp := sp+q+intsize; pshint(ord(b))
+                     end;
+                     28 (*dsp*): begin { large set of i2 bytes under i1 bytes
+                                         to sparse }
+                       popint(i1); popint(i2); lschk(sp+i1, i2); 
+                       ad := sp; sp := sp-(q-i2); spfrm(sp-q, ad+i1, i2, q); 
+                       lsmov(sp, ad, i1); spmov(sp+i1, sp-q)
+                     end;
+                     29 (*spd*): begin { sparse set of i2 bytes under i1 bytes
+                                         to large }
+                       popint(i1); popint(i2); spto(sp-q, sp+i1, q); 
+                       ad := sp; sp := sp+(i2-q); lsmov(sp, ad, i1); 
+                       lsmov(sp+i1, ad-q, q)
+                     end;
+                     31 (*ina*): begin popadr(ad); popint(i1); 
+                       pshint(ord(spfnd(ad, i1)))
+                     end
+                   end
+                 end;
+
+    255 (*bfd*): begin getp; getq; { p = operation, q = bits in field }
+                   case p of
+                     0 (*lod*): begin popint(i1); popadr(ad); 
+                                  pshint(bfdget(ad, i1, q)) end;
+                     1 (*sto*): begin popint(i2); popint(i1); popadr(ad);
+                                  bfdput(ad, i1, q, i2) end;
+                     2 (*pck*): begin { i1 elements from unpacked of i2 bytes }
+                       popint(i2); popint(i1); popadr(a3); popadr(a2); 
+                       popadr(a1);
+                       if a2+i1 > i2 then errore(PackElementsOutOfBounds);
+                       for i4 := 0 to i1-1 do begin chkdef(a1+a2+i4);
+                         bfdput(a3, i4, q, store[a1+a2+i4])
+                       end
+                     end;
+                     3 (*upk*): begin { i1 elements to unpacked of i2 bytes }
+                       popint(i2); popint(i1); popadr(a3); popadr(a2); 
+                       popadr(a1);
+                       if a3+i1 > i2 then errore(UnpackElementsOutOfBounds);
+                       for i4 := 0 to i1-1 do begin
+                         store[a2+a3+i4] := bfdget(a1, i4, q);
+                         putdef(a2+a3+i4, true)
+                       end
+                     end
+                   end
+                 end;
+
     { illegal instructions }
-    228, 229, 230, 231, 232, 233, 234, 242, 243, 244, 245, 246,
-    247, 248, 249, 250, 251, 252, 253, 254,
-    255: errorv(InvalidInstruction)
+    228, 229, 230, 231, 232, 233,
+    234: errorv(InvalidInstruction)
 
   end
 end;
@@ -3105,6 +3664,9 @@ begin (* main *)
   iso7185 := false;  { iso7185 standard mode }
   varlst := nil; { set no VAR block entries }
   varfre := nil;
+  vartre := nil;
+  varseq := 0; varsed := 1;
+  lincnt := 0; { set no source line table }
   fndpow(maxpow10, 10, decdig);
   fndpow(maxpow16, 16, hexdig);
   fndpow(maxpow8, 8, octdig);